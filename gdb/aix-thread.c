@@ -1826,8 +1826,10 @@ init_aix_thread_ops (void)
   aix_thread_ops.to_fetch_registers = aix_thread_fetch_registers;
   aix_thread_ops.to_store_registers = aix_thread_store_registers;
   aix_thread_ops.to_xfer_partial = aix_thread_xfer_partial;
+  aix_thread_ops.to_read_memory_vector = default_read_memory_vector;
   aix_thread_ops.to_mourn_inferior = aix_thread_mourn_inferior;
   aix_thread_ops.to_thread_alive = aix_thread_thread_alive;
+  aix_thread_ops.to_threads_alive = default_threads_alive;
   aix_thread_ops.to_pid_to_str = aix_thread_pid_to_str;
   aix_thread_ops.to_extra_thread_info = aix_thread_extra_thread_info;
   aix_thread_ops.to_get_ada_task_ptid = aix_thread_get_ada_task_ptid;
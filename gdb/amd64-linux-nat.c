@@ -20,6 +20,7 @@
 
 #include "defs.h"
 #include "inferior.h"
+#include "exceptions.h"
 #include "gdbcore.h"
 #include "regcache.h"
 #include "regset.h"
@@ -66,12 +67,45 @@
 #define PTRACE_SETREGSET	0x4205
 #endif
 
+/* The register sets we transfer with ptrace.  */
+
+#define AMD64_LINUX_GREGS	(1 << 0)
+#define AMD64_LINUX_FPREGS	(1 << 1)
+#define AMD64_LINUX_ALL_REGS	(AMD64_LINUX_GREGS | AMD64_LINUX_FPREGS)
+
+/* A copy of the register sets of a stopped thread.  Sets are read
+   from the thread the first time one of their registers is needed,
+   and stores are only recorded here; dirty sets are written back just
+   before the thread is resumed.  */
+
+struct amd64_linux_regsets
+{
+  /* Mask of the sets read from the thread.  */
+  unsigned int valid;
+
+  /* Mask of the sets modified since they were read.  */
+  unsigned int dirty;
+
+  /* The general-purpose registers.  */
+  elf_gregset_t gregs;
+
+  /* The floating-point and SSE registers: an XSAVE area if
+     PTRACE_GETREGSET is supported, an FXSAVE area otherwise.  */
+  char fpregs[I386_XSTATE_MAX_SIZE];
+
+  /* The size of the state in FPREGS.  */
+  size_t fpregs_len;
+};
+
 /* Per-thread arch-specific data we want to keep.  */
 
 struct arch_lwp_info
 {
   /* Non-zero if our copy differs from what's recorded in the thread.  */
   int debug_registers_changed;
+
+  /* The thread's register sets, while it is stopped.  */
+  struct amd64_linux_regsets regsets;
 };
 
 /* Does the current host support PTRACE_GETREGSET?  */
@@ -156,70 +190,130 @@ fill_fpregset (const struct regcache *regcache,
 
 /* Transferring arbitrary registers between GDB and inferior.  */
 
-/* Fetch register REGNUM from the child process.  If REGNUM is -1, do
-   this for all registers (including the floating point and SSE
-   registers).  */
+/* Return the register sets cache of the LWP of PTID.  If PTID isn't a
+   known LWP (e.g., it's a fork child we haven't followed), clear BUF
+   and return it instead; the caller must then write back anything it
+   changes immediately.  */
 
-static void
-amd64_linux_fetch_inferior_registers (struct target_ops *ops,
-				      struct regcache *regcache, int regnum)
+static struct amd64_linux_regsets *
+amd64_linux_thread_regsets (ptid_t ptid, struct amd64_linux_regsets *buf)
 {
-  struct gdbarch *gdbarch = get_regcache_arch (regcache);
-  int tid;
-
-  /* GNU/Linux LWP ID's are process ID's.  */
-  tid = ptid_get_lwp (inferior_ptid);
-  if (tid == 0)
-    tid = ptid_get_pid (inferior_ptid); /* Not a threaded program.  */
+  struct lwp_info *lp = find_lwp_pid (ptid);
 
-  if (regnum == -1 || amd64_native_gregset_supplies_p (gdbarch, regnum))
+  if (lp == NULL)
     {
-      elf_gregset_t regs;
+      memset (buf, 0, sizeof (*buf));
+      return buf;
+    }
 
-      if (ptrace (PTRACE_GETREGS, tid, 0, (long) &regs) < 0)
-	perror_with_name (_("Couldn't get registers"));
+  if (lp->arch_private == NULL)
+    lp->arch_private = XCNEW (struct arch_lwp_info);
 
-      amd64_supply_native_gregset (regcache, &regs, -1);
-      if (regnum != -1)
-	return;
-    }
+  return &lp->arch_private->regsets;
+}
 
-  if (regnum == -1 || !amd64_native_gregset_supplies_p (gdbarch, regnum))
+/* Read the register sets in mask WHICH that REGSETS doesn't already
+   hold from thread TID.  */
+
+static void
+amd64_linux_read_regsets (int tid, struct amd64_linux_regsets *regsets,
+			  unsigned int which)
+{
+  which &= ~regsets->valid;
+
+  if ((which & AMD64_LINUX_GREGS) != 0)
     {
-      elf_fpregset_t fpregs;
+      if (ptrace (PTRACE_GETREGS, tid, 0, (long) &regsets->gregs) < 0)
+	perror_with_name (_("Couldn't get registers"));
+    }
 
+  if ((which & AMD64_LINUX_FPREGS) != 0)
+    {
       if (have_ptrace_getregset)
 	{
-	  char xstateregs[I386_XSTATE_MAX_SIZE];
 	  struct iovec iov;
 
-	  iov.iov_base = xstateregs;
-	  iov.iov_len = sizeof (xstateregs);
+	  iov.iov_base = regsets->fpregs;
+	  iov.iov_len = sizeof (regsets->fpregs);
 	  if (ptrace (PTRACE_GETREGSET, tid,
 		      (unsigned int) NT_X86_XSTATE, (long) &iov) < 0)
 	    perror_with_name (_("Couldn't get extended state status"));
 
-	  amd64_supply_xsave (regcache, -1, xstateregs);
+	  regsets->fpregs_len = iov.iov_len;
 	}
       else
 	{
-	  if (ptrace (PTRACE_GETFPREGS, tid, 0, (long) &fpregs) < 0)
+	  if (ptrace (PTRACE_GETFPREGS, tid, 0, (long) regsets->fpregs) < 0)
 	    perror_with_name (_("Couldn't get floating point status"));
 
-	  amd64_supply_fxsave (regcache, -1, &fpregs);
+	  regsets->fpregs_len = sizeof (elf_fpregset_t);
 	}
     }
+
+  regsets->valid |= which;
 }
 
-/* Store register REGNUM back into the child process.  If REGNUM is
-   -1, do this for all registers (including the floating-point and SSE
+/* Write the dirty register sets of REGSETS back to thread TID.  */
+
+static void
+amd64_linux_write_regsets (int tid, struct amd64_linux_regsets *regsets)
+{
+  unsigned int which = regsets->dirty;
+
+  /* Don't retry a failed write the next time around.  */
+  regsets->dirty = 0;
+
+  if ((which & AMD64_LINUX_GREGS) != 0)
+    {
+      if (ptrace (PTRACE_SETREGS, tid, 0, (long) &regsets->gregs) < 0)
+	perror_with_name (_("Couldn't write registers"));
+    }
+
+  if ((which & AMD64_LINUX_FPREGS) != 0)
+    {
+      if (have_ptrace_getregset)
+	{
+	  struct iovec iov;
+
+	  iov.iov_base = regsets->fpregs;
+	  iov.iov_len = regsets->fpregs_len;
+	  if (ptrace (PTRACE_SETREGSET, tid,
+		      (unsigned int) NT_X86_XSTATE, (long) &iov) < 0)
+	    perror_with_name (_("Couldn't write extended state status"));
+	}
+      else
+	{
+	  if (ptrace (PTRACE_SETFPREGS, tid, 0, (long) regsets->fpregs) < 0)
+	    perror_with_name (_("Couldn't write floating point status"));
+	}
+    }
+}
+
+/* Return the mask of the register sets that hold register REGNUM, or
+   all of them if REGNUM is -1.  */
+
+static unsigned int
+amd64_linux_regnum_regsets (struct gdbarch *gdbarch, int regnum)
+{
+  if (regnum == -1)
+    return AMD64_LINUX_ALL_REGS;
+  else if (amd64_native_gregset_supplies_p (gdbarch, regnum))
+    return AMD64_LINUX_GREGS;
+  else
+    return AMD64_LINUX_FPREGS;
+}
+
+/* Fetch register REGNUM from the child process.  If REGNUM is -1, do
+   this for all registers (including the floating point and SSE
    registers).  */
 
 static void
-amd64_linux_store_inferior_registers (struct target_ops *ops,
+amd64_linux_fetch_inferior_registers (struct target_ops *ops,
 				      struct regcache *regcache, int regnum)
 {
   struct gdbarch *gdbarch = get_regcache_arch (regcache);
+  struct amd64_linux_regsets buf, *regsets;
+  unsigned int which;
   int tid;
 
   /* GNU/Linux LWP ID's are process ID's.  */
@@ -227,56 +321,62 @@ amd64_linux_store_inferior_registers (struct target_ops *ops,
   if (tid == 0)
     tid = ptid_get_pid (inferior_ptid); /* Not a threaded program.  */
 
-  if (regnum == -1 || amd64_native_gregset_supplies_p (gdbarch, regnum))
-    {
-      elf_gregset_t regs;
-
-      if (ptrace (PTRACE_GETREGS, tid, 0, (long) &regs) < 0)
-	perror_with_name (_("Couldn't get registers"));
-
-      amd64_collect_native_gregset (regcache, &regs, regnum);
+  regsets = amd64_linux_thread_regsets (inferior_ptid, &buf);
+  which = amd64_linux_regnum_regsets (gdbarch, regnum);
+  amd64_linux_read_regsets (tid, regsets, which);
 
-      if (ptrace (PTRACE_SETREGS, tid, 0, (long) &regs) < 0)
-	perror_with_name (_("Couldn't write registers"));
+  if ((which & AMD64_LINUX_GREGS) != 0)
+    amd64_supply_native_gregset (regcache, &regsets->gregs, -1);
 
-      if (regnum != -1)
-	return;
+  if ((which & AMD64_LINUX_FPREGS) != 0)
+    {
+      if (have_ptrace_getregset)
+	amd64_supply_xsave (regcache, -1, regsets->fpregs);
+      else
+	amd64_supply_fxsave (regcache, -1, regsets->fpregs);
     }
+}
 
-  if (regnum == -1 || !amd64_native_gregset_supplies_p (gdbarch, regnum))
-    {
-      elf_fpregset_t fpregs;
+/* Store register REGNUM back into the child process.  If REGNUM is
+   -1, do this for all registers (including the floating-point and SSE
+   registers).  The thread is only written to when it is next resumed
+   (see amd64_linux_prepare_to_resume).  */
 
-      if (have_ptrace_getregset)
-	{
-	  char xstateregs[I386_XSTATE_MAX_SIZE];
-	  struct iovec iov;
+static void
+amd64_linux_store_inferior_registers (struct target_ops *ops,
+				      struct regcache *regcache, int regnum)
+{
+  struct gdbarch *gdbarch = get_regcache_arch (regcache);
+  struct amd64_linux_regsets buf, *regsets;
+  unsigned int which;
+  int tid;
 
-	  iov.iov_base = xstateregs;
-	  iov.iov_len = sizeof (xstateregs);
-	  if (ptrace (PTRACE_GETREGSET, tid,
-		      (unsigned int) NT_X86_XSTATE, (long) &iov) < 0)
-	    perror_with_name (_("Couldn't get extended state status"));
+  /* GNU/Linux LWP ID's are process ID's.  */
+  tid = ptid_get_lwp (inferior_ptid);
+  if (tid == 0)
+    tid = ptid_get_pid (inferior_ptid); /* Not a threaded program.  */
 
-	  amd64_collect_xsave (regcache, regnum, xstateregs, 0);
+  regsets = amd64_linux_thread_regsets (inferior_ptid, &buf);
+  which = amd64_linux_regnum_regsets (gdbarch, regnum);
+  amd64_linux_read_regsets (tid, regsets, which);
 
-	  if (ptrace (PTRACE_SETREGSET, tid,
-		      (unsigned int) NT_X86_XSTATE, (long) &iov) < 0)
-	    perror_with_name (_("Couldn't write extended state status"));
-	}
+  if ((which & AMD64_LINUX_GREGS) != 0)
+    amd64_collect_native_gregset (regcache, &regsets->gregs, regnum);
+
+  if ((which & AMD64_LINUX_FPREGS) != 0)
+    {
+      if (have_ptrace_getregset)
+	amd64_collect_xsave (regcache, regnum, regsets->fpregs, 0);
       else
-	{
-	  if (ptrace (PTRACE_GETFPREGS, tid, 0, (long) &fpregs) < 0)
-	    perror_with_name (_("Couldn't get floating point status"));
+	amd64_collect_fxsave (regcache, regnum, regsets->fpregs);
+    }
 
-	  amd64_collect_fxsave (regcache, regnum, &fpregs);
+  regsets->dirty |= which;
 
-	  if (ptrace (PTRACE_SETFPREGS, tid, 0, (long) &fpregs) < 0)
-	    perror_with_name (_("Couldn't write floating point status"));
-	}
-    }
+  if (regsets == &buf)
+    amd64_linux_write_regsets (tid, regsets);
 }
-
+
 /* Support for debug registers.  */
 
 static unsigned long
@@ -389,7 +489,8 @@ amd64_linux_dr_set_addr (int regnum, CORE_ADDR addr)
 }
 
 /* Called when resuming a thread.
-   If the debug regs have changed, update the thread's copies.  */
+   If the registers or the debug regs have changed, update the
+   thread's copies.  */
 
 static void
 amd64_linux_prepare_to_resume (struct lwp_info *lwp)
@@ -402,6 +503,26 @@ amd64_linux_prepare_to_resume (struct lwp_info *lwp)
   if (lwp->arch_private == NULL)
     return;
 
+  /* Write back the registers GDB changed, and forget the rest, as
+     the thread is about to change them.  Our caller has already
+     committed to resuming LWP, so don't let a failure here escape.  */
+  lwp->arch_private->regsets.valid = 0;
+  if (lwp->arch_private->regsets.dirty != 0)
+    {
+      volatile struct gdb_exception ex;
+      int tid = ptid_get_lwp (lwp->ptid);
+
+      if (tid == 0)
+	tid = ptid_get_pid (lwp->ptid);
+
+      TRY_CATCH (ex, RETURN_MASK_ERROR)
+	{
+	  amd64_linux_write_regsets (tid, &lwp->arch_private->regsets);
+	}
+      if (ex.reason < 0)
+	warning (_("%s: %s"), target_pid_to_str (lwp->ptid), ex.message);
+    }
+
   if (lwp->arch_private->debug_registers_changed)
     {
       struct i386_debug_reg_state *state
@@ -260,6 +260,16 @@ static int is_masked_watchpoint (const struct breakpoint *b);
 
 static struct bp_location **get_first_locp_gte_addr (CORE_ADDR address);
 
+static int bkpt_breakpoint_hit (const struct bp_location *bl,
+				struct address_space *aspace,
+				CORE_ADDR bp_addr,
+				const struct target_waitstatus *ws);
+
+static int tracepoint_breakpoint_hit (const struct bp_location *bl,
+				      struct address_space *aspace,
+				      CORE_ADDR bp_addr,
+				      const struct target_waitstatus *ws);
+
 /* Return 1 if B refers to a static tracepoint set by marker ("-m"), zero
    otherwise.  */
 
@@ -561,6 +571,22 @@ int target_exact_watchpoints = 0;
 
 struct breakpoint *breakpoint_chain;
 
+/* The last breakpoint of BREAKPOINT_CHAIN.  */
+
+static struct breakpoint *breakpoint_chain_tail;
+
+/* The CHAIN_SEQ of the last breakpoint added to BREAKPOINT_CHAIN.  */
+
+static unsigned int breakpoint_chain_seq;
+
+/* The breakpoints on BREAKPOINT_CHAIN whose locations may explain a
+   stop at an address other than their own, such as watchpoints and
+   catchpoints, in chain order.  The locations of all other
+   breakpoints are only looked up by address in the BP_LOCATION
+   array.  */
+
+static VEC(breakpoint_p) *non_address_breakpoints;
+
 /* Array is sorted by bp_location_compare - primarily by the ADDRESS.  */
 
 static struct bp_location **bp_location;
@@ -585,6 +611,47 @@ static CORE_ADDR bp_location_placed_address_before_address_max;
 
 static CORE_ADDR bp_location_shadow_len_after_address_max;
 
+/* Maximum LENGTH of the software and hardware breakpoint locations of
+   BP_LOCATION that cover a range of addresses (see
+   breakpoint_location_address_match), or zero if there are none.  */
+
+static CORE_ADDR bp_location_range_len_max;
+
+/* Number of calls to update_global_location_list so far; see
+   bp_location.location_generation.  */
+
+static unsigned int bp_location_generation;
+
+/* Nonzero while breakpoint_re_set is re-setting every breakpoint.
+   update_breakpoint_locations then leaves the BP_LOCATION array
+   alone, and just sets BP_LOCATION_UPDATE_PENDING; the array is
+   rebuilt once at the end instead of once per breakpoint.  */
+
+static int bp_location_update_deferred;
+
+/* Nonzero if breakpoint locations were changed while
+   BP_LOCATION_UPDATE_DEFERRED was set.  */
+
+static int bp_location_update_pending;
+
+/* The objfiles added since breakpoints were last re-set.  Each
+   breakpoint's locations account for the symbols of all other
+   objfiles, unless NEW_OBJFILES_INCOMPLETE is set.  */
+
+static VEC (objfilep) *new_objfiles;
+
+/* Nonzero if the symbols changed in some other way than by adding
+   the objfiles of NEW_OBJFILES since breakpoints were last re-set,
+   e.g. because an objfile was freed.  */
+
+static int new_objfiles_incomplete;
+
+/* While breakpoint_re_set_new_objfiles runs, the objfiles whose
+   symbols are looked up to decide whether a breakpoint needs to be
+   re-set at all.  */
+
+static VEC (objfilep) *re_set_objfiles;
+
 /* The locations that no longer correspond to any breakpoint, unlinked
    from bp_location array, but for which a hit may still be reported
    by a target.  */
@@ -906,6 +973,47 @@ get_first_locp_gte_addr (CORE_ADDR address)
   return locp_found;
 }
 
+/* Return the index of the first element of BP_LOCATION whose address
+   is ADDRESS or more, or BP_LOCATION_COUNT if there is none.  */
+
+static unsigned
+bp_location_lower_bound (CORE_ADDR address)
+{
+  unsigned bc_l = 0, bc_r = bp_location_count;
+
+  while (bc_l < bc_r)
+    {
+      unsigned bc = bc_l + (bc_r - bc_l) / 2;
+
+      if (bp_location[bc]->address < address)
+	bc_l = bc + 1;
+      else
+	bc_r = bc;
+    }
+
+  return bc_l;
+}
+
+/* Set *BEGIN and *END to delimit the elements of BP_LOCATION that
+   breakpoint_location_address_match may match with ADDRESS: those at
+   ADDRESS, and those below it that may cover it with their range.  */
+
+static void
+bp_locations_near_addr (CORE_ADDR address, struct bp_location ***begin,
+			struct bp_location ***end)
+{
+  CORE_ADDR low = address;
+
+  if (bp_location_range_len_max > 0)
+    low -= min (address, bp_location_range_len_max - 1);
+
+  *begin = bp_location + bp_location_lower_bound (low);
+  if (address + 1 == 0)
+    *end = bp_location + bp_location_count;
+  else
+    *end = bp_location + bp_location_lower_bound (address + 1);
+}
+
 void
 set_breakpoint_condition (struct breakpoint *b, char *exp,
 			  int from_tty)
@@ -4063,11 +4171,14 @@ breakpoint_init_inferior (enum inf_context context)
 enum breakpoint_here
 breakpoint_here_p (struct address_space *aspace, CORE_ADDR pc)
 {
-  struct bp_location *bl, **blp_tmp;
+  struct bp_location *bl, **blp_tmp, **blp_end;
   int any_breakpoint_here = 0;
 
-  ALL_BP_LOCATIONS (bl, blp_tmp)
+  bp_locations_near_addr (pc, &blp_tmp, &blp_end);
+  for (; blp_tmp < blp_end; blp_tmp++)
     {
+      bl = *blp_tmp;
+
       if (bl->loc_type != bp_loc_software_breakpoint
 	  && bl->loc_type != bp_loc_hardware_breakpoint)
 	continue;
@@ -4115,10 +4226,13 @@ int
 regular_breakpoint_inserted_here_p (struct address_space *aspace, 
 				    CORE_ADDR pc)
 {
-  struct bp_location *bl, **blp_tmp;
+  struct bp_location *bl, **blp_tmp, **blp_end;
 
-  ALL_BP_LOCATIONS (bl, blp_tmp)
+  bp_locations_near_addr (pc, &blp_tmp, &blp_end);
+  for (; blp_tmp < blp_end; blp_tmp++)
     {
+      bl = *blp_tmp;
+
       if (bl->loc_type != bp_loc_software_breakpoint
 	  && bl->loc_type != bp_loc_hardware_breakpoint)
 	continue;
@@ -4159,10 +4273,13 @@ int
 software_breakpoint_inserted_here_p (struct address_space *aspace,
 				     CORE_ADDR pc)
 {
-  struct bp_location *bl, **blp_tmp;
+  struct bp_location *bl, **blp_tmp, **blp_end;
 
-  ALL_BP_LOCATIONS (bl, blp_tmp)
+  bp_locations_near_addr (pc, &blp_tmp, &blp_end);
+  for (; blp_tmp < blp_end; blp_tmp++)
     {
+      bl = *blp_tmp;
+
       if (bl->loc_type != bp_loc_software_breakpoint)
 	continue;
 
@@ -4225,13 +4342,16 @@ int
 breakpoint_thread_match (struct address_space *aspace, CORE_ADDR pc,
 			 ptid_t ptid)
 {
-  struct bp_location *bl, **blp_tmp;
+  struct bp_location *bl, **blp_tmp, **blp_end;
   /* The thread and task IDs associated to PTID, computed lazily.  */
   int thread = -1;
   int task = 0;
   
-  ALL_BP_LOCATIONS (bl, blp_tmp)
+  bp_locations_near_addr (pc, &blp_tmp, &blp_end);
+  for (; blp_tmp < blp_end; blp_tmp++)
     {
+      bl = *blp_tmp;
+
       if (bl->loc_type != bp_loc_software_breakpoint
 	  && bl->loc_type != bp_loc_hardware_breakpoint)
 	continue;
@@ -5069,6 +5189,29 @@ which its expression is valid.\n");
     }
 }
 
+/* Return non-zero if B only explains stops at the address of one of
+   its locations, so that bpstat_stop_status can find the locations to
+   check by address.  */
+
+static int
+breakpoint_hit_by_address_p (const struct breakpoint *b)
+{
+  return (b->ops->breakpoint_hit == bkpt_breakpoint_hit
+	  || b->ops->breakpoint_hit == tracepoint_breakpoint_hit);
+}
+
+/* A comparison function for qsort ordering breakpoints AP and BP as
+   they are on the breakpoint chain.  */
+
+static int
+breakpoint_chain_seq_compare (const void *ap, const void *bp)
+{
+  const struct breakpoint *a = *(const struct breakpoint **) ap;
+  const struct breakpoint *b = *(const struct breakpoint **) bp;
+
+  return (a->chain_seq > b->chain_seq) - (a->chain_seq < b->chain_seq);
+}
+
 /* Return true if it looks like target has stopped due to hitting
    breakpoint location BL.  This function does not check if we should
    stop, only if BL explains the stop.  */
@@ -5409,6 +5552,9 @@ bpstat_stop_status (struct address_space *aspace,
   struct breakpoint *b = NULL;
   struct bp_location *bl;
   struct bp_location *loc;
+  struct bp_location **blp, **blp_start;
+  VEC(breakpoint_p) *candidates = NULL;
+  struct cleanup *cleanups;
   /* First item of allocated bpstat's.  */
   bpstat bs_head = NULL, *bs_link = &bs_head;
   /* Pointer to the last thing in the chain currently.  */
@@ -5424,8 +5570,30 @@ bpstat_stop_status (struct address_space *aspace,
      breakpoint conditions or watchpoint expressions that include
      inferior function calls.  */
 
-  ALL_BREAKPOINTS (b)
-    {
+  /* Only breakpoints with a location at BP_ADDR, and those whose
+     hits aren't tied to their addresses, can explain the stop.  Find
+     the former through the BP_LOCATION array, and check them all in
+     breakpoint chain order.  */
+  blp_start = NULL;
+  ALL_BP_LOCATIONS_AT_ADDR (blp, blp_start, bp_addr)
+    if (breakpoint_hit_by_address_p ((*blp)->owner))
+      VEC_safe_push (breakpoint_p, candidates, (*blp)->owner);
+  cleanups = make_cleanup (VEC_cleanup (breakpoint_p), &candidates);
+  for (ix = 0;
+       VEC_iterate (breakpoint_p, non_address_breakpoints, ix, b);
+       ix++)
+    VEC_safe_push (breakpoint_p, candidates, b);
+  if (!VEC_empty (breakpoint_p, candidates))
+    qsort (VEC_address (breakpoint_p, candidates),
+	   VEC_length (breakpoint_p, candidates),
+	   sizeof (breakpoint_p), breakpoint_chain_seq_compare);
+
+  for (ix = 0; VEC_iterate (breakpoint_p, candidates, ix, b); ix++)
+    {
+      /* A breakpoint may have several locations at BP_ADDR.  */
+      if (ix > 0 && VEC_index (breakpoint_p, candidates, ix - 1) == b)
+	continue;
+
       if (!breakpoint_enabled (b) && b->enable_state != bp_permanent)
 	continue;
 
@@ -5469,6 +5637,7 @@ bpstat_stop_status (struct address_space *aspace,
 	    }
 	}
     }
+  do_cleanups (cleanups);
 
   for (ix = 0; VEC_iterate (bp_location_p, moribund_locations, ix, loc); ++ix)
     {
@@ -7141,20 +7310,18 @@ decref_bp_location (struct bp_location **blp)
 static void
 add_to_breakpoint_chain (struct breakpoint *b)
 {
-  struct breakpoint *b1;
-
   /* Add this breakpoint to the end of the chain so that a list of
      breakpoints will come out in order of increasing numbers.  */
 
-  b1 = breakpoint_chain;
-  if (b1 == 0)
+  if (breakpoint_chain_tail == NULL)
     breakpoint_chain = b;
   else
-    {
-      while (b1->next)
-	b1 = b1->next;
-      b1->next = b;
-    }
+    breakpoint_chain_tail->next = b;
+  breakpoint_chain_tail = b;
+  b->chain_seq = ++breakpoint_chain_seq;
+
+  if (!breakpoint_hit_by_address_p (b))
+    VEC_safe_push (breakpoint_p, non_address_breakpoints, b);
 }
 
 /* Initializes breakpoint B with type BPTYPE and no locations yet.  */
@@ -8980,6 +9147,7 @@ void
 disable_breakpoints_before_startup (void)
 {
   current_program_space->executing_startup = 1;
+  new_objfiles_incomplete = 1;
   update_global_location_list (0);
 }
 
@@ -12253,9 +12421,10 @@ bp_location_compare (const void *ap, const void *bp)
   return (a > b) - (a < b);
 }
 
-/* Set bp_location_placed_address_before_address_max and
-   bp_location_shadow_len_after_address_max according to the current
-   content of the bp_location array.  */
+/* Set bp_location_placed_address_before_address_max,
+   bp_location_shadow_len_after_address_max and
+   bp_location_range_len_max according to the current content of the
+   bp_location array.  */
 
 static void
 bp_location_target_extensions_update (void)
@@ -12264,11 +12433,17 @@ bp_location_target_extensions_update (void)
 
   bp_location_placed_address_before_address_max = 0;
   bp_location_shadow_len_after_address_max = 0;
+  bp_location_range_len_max = 0;
 
   ALL_BP_LOCATIONS (bl, blp_tmp)
     {
       CORE_ADDR start, end, addr;
 
+      if ((bl->loc_type == bp_loc_software_breakpoint
+	   || bl->loc_type == bp_loc_hardware_breakpoint)
+	  && bl->length > bp_location_range_len_max)
+	bp_location_range_len_max = bl->length;
+
       if (!bp_location_has_shadow (bl))
 	continue;
 
@@ -12458,6 +12633,11 @@ update_global_location_list (int should_insert)
   struct bp_location **old_location, **old_locp;
   unsigned old_location_count;
 
+  /* The locations that weren't in the former array, and the next one
+     to merge.  */
+  struct bp_location **added_location, **addedp;
+  unsigned added_count;
+
   old_location = bp_location;
   old_location_count = bp_location_count;
   bp_location = NULL;
@@ -12468,14 +12648,54 @@ update_global_location_list (int should_insert)
     for (loc = b->loc; loc; loc = loc->next)
       bp_location_count++;
 
+  /* Most of the time, only a few locations were added or removed
+     since the last call.  Sort just the new locations, and merge them
+     with the ones left from the former array, which is sorted
+     already.  */
   bp_location = xmalloc (sizeof (*bp_location) * bp_location_count);
-  locp = bp_location;
+  added_location = xmalloc (sizeof (*added_location) * bp_location_count);
+  make_cleanup (xfree, added_location);
+  added_count = 0;
+  bp_location_generation++;
   ALL_BREAKPOINTS (b)
     for (loc = b->loc; loc; loc = loc->next)
-      *locp++ = loc;
-  qsort (bp_location, bp_location_count, sizeof (*bp_location),
+      {
+	if (loc->location_generation != bp_location_generation - 1
+	    || bp_location_generation == 1)
+	  added_location[added_count++] = loc;
+	loc->location_generation = bp_location_generation;
+      }
+  qsort (added_location, added_count, sizeof (*added_location),
 	 bp_location_compare);
 
+  locp = bp_location;
+  addedp = added_location;
+  for (old_locp = old_location; old_locp < old_location + old_location_count;
+       old_locp++)
+    {
+      if ((*old_locp)->location_generation != bp_location_generation)
+	continue;
+
+      while (addedp < added_location + added_count
+	     && bp_location_compare (addedp, old_locp) < 0)
+	*locp++ = *addedp++;
+      *locp++ = *old_locp;
+    }
+  while (addedp < added_location + added_count)
+    *locp++ = *addedp++;
+  gdb_assert (locp == bp_location + bp_location_count);
+
+  /* The sort keys of the former locations may have changed since they
+     were sorted (e.g., a breakpoint became permanent).  */
+  for (locp = bp_location + 1; locp < bp_location + bp_location_count;
+       locp++)
+    if (bp_location_compare (locp - 1, locp) > 0)
+      {
+	qsort (bp_location, bp_location_count, sizeof (*bp_location),
+	       bp_location_compare);
+	break;
+      }
+
   bp_location_target_extensions_update ();
 
   /* Identify bp_location instances that are no longer present in the
@@ -13886,6 +14106,25 @@ delete_breakpoint (struct breakpoint *bpt)
       break;
     }
 
+  /* B is now BPT's predecessor, if any.  */
+  if (breakpoint_chain_tail == bpt)
+    breakpoint_chain_tail = b;
+
+  if (!breakpoint_hit_by_address_p (bpt))
+    {
+      struct breakpoint *nb;
+      int ix;
+
+      for (ix = 0;
+	   VEC_iterate (breakpoint_p, non_address_breakpoints, ix, nb);
+	   ix++)
+	if (nb == bpt)
+	  {
+	    VEC_ordered_remove (breakpoint_p, non_address_breakpoints, ix);
+	    break;
+	  }
+    }
+
   /* Be sure no bpstat's are pointing at the breakpoint after it's
      been freed.  */
   /* FIXME, how can we find all bpstat's?  We just check stop_bpstat
@@ -14233,7 +14472,10 @@ update_breakpoint_locations (struct breakpoint *b,
       /* Ranged breakpoints have only one start location and one end
 	 location.  */
       b->enable_state = bp_disabled;
-      update_global_location_list (1);
+      if (bp_location_update_deferred)
+	bp_location_update_pending = 1;
+      else
+	update_global_location_list (1);
       printf_unfiltered (_("Could not reset ranged breakpoint %d: "
 			   "multiple locations found\n"),
 			 b->number);
@@ -14336,7 +14578,10 @@ update_breakpoint_locations (struct breakpoint *b,
   if (!locations_are_equal (existing_locations, b->loc))
     observer_notify_breakpoint_modified (b);
 
-  update_global_location_list (1);
+  if (bp_location_update_deferred)
+    bp_location_update_pending = 1;
+  else
+    update_global_location_list (1);
 }
 
 /* Find the SaL locations corresponding to the given ADDR_STRING.
@@ -14420,6 +14665,36 @@ addr_string_to_sals (struct breakpoint *b, char *addr_string, int *found)
   return sals;
 }
 
+/* Return nonzero if the symbols of RE_SET_OBJFILES might give
+   breakpoint B other locations than it has now.  */
+
+static int
+re_set_objfiles_match_p (struct breakpoint *b)
+{
+  char *s = b->addr_string;
+  int match = 1;
+  volatile struct gdb_exception e;
+
+  /* Probes and static tracepoint markers are looked up differently,
+     and a ranged breakpoint also depends on its end.  */
+  if (s == NULL
+      || (b->ops->decode_linespec != bkpt_decode_linespec
+	  && b->ops->decode_linespec != tracepoint_decode_linespec)
+      || b->addr_string_range_end != NULL)
+    return 1;
+
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    {
+      match = linespec_matches_objfiles_p (&s, DECODE_LINE_FUNFIRSTLINE,
+					   VEC_address (objfilep,
+							re_set_objfiles),
+					   VEC_length (objfilep,
+						       re_set_objfiles));
+    }
+
+  return e.reason < 0 || match;
+}
+
 /* The default re_set method, for typical hardware or software
    breakpoints.  Reevaluate the breakpoint and recreate its
    locations.  */
@@ -14432,6 +14707,9 @@ breakpoint_re_set_default (struct breakpoint *b)
   struct symtabs_and_lines expanded = {0};
   struct symtabs_and_lines expanded_end = {0};
 
+  if (re_set_objfiles != NULL && !re_set_objfiles_match_p (b))
+    return;
+
   sals = addr_string_to_sals (b, b->addr_string, &found);
   if (found)
     {
@@ -14553,6 +14831,21 @@ breakpoint_re_set_one (void *bint)
   return 0;
 }
 
+/* Cleanup for breakpoint_re_set.  Stop deferring updates of the
+   BP_LOCATION array, and bring it up to date with the breakpoints'
+   new locations.  */
+
+static void
+end_deferred_location_update (void *arg)
+{
+  bp_location_update_deferred = 0;
+  if (bp_location_update_pending)
+    {
+      bp_location_update_pending = 0;
+      update_global_location_list (1);
+    }
+}
+
 /* Re-set all breakpoints after symbols have been re-loaded.  */
 void
 breakpoint_re_set (void)
@@ -14560,12 +14853,28 @@ breakpoint_re_set (void)
   struct breakpoint *b, *b_tmp;
   enum language save_language;
   int save_input_radix;
-  struct cleanup *old_chain;
+  struct cleanup *old_chain, *update_chain;
 
   save_language = current_language->la_language;
   save_input_radix = input_radix;
   old_chain = save_current_program_space ();
 
+  /* From now on, all breakpoints account for the objfiles loaded so
+     far.  */
+  VEC_truncate (objfilep, new_objfiles, 0);
+  new_objfiles_incomplete = 0;
+
+  /* Re-setting a breakpoint replaces all its locations.  Rebuild the
+     global location list once all breakpoints have been re-set,
+     rather than after each one.  */
+  if (!bp_location_update_deferred)
+    {
+      bp_location_update_deferred = 1;
+      update_chain = make_cleanup (end_deferred_location_update, NULL);
+    }
+  else
+    update_chain = make_cleanup (null_cleanup, NULL);
+
   ALL_BREAKPOINTS_SAFE (b, b_tmp)
   {
     /* Format possible error msg.  */
@@ -14575,6 +14884,7 @@ breakpoint_re_set (void)
     catch_errors (breakpoint_re_set_one, b, message, RETURN_MASK_ALL);
     do_cleanups (cleanups);
   }
+  do_cleanups (update_chain);
   set_language (save_language);
   input_radix = save_input_radix;
 
@@ -14588,6 +14898,42 @@ breakpoint_re_set (void)
   create_exception_master_breakpoint ();
 }
 
+/* See breakpoint.h.  */
+
+void
+breakpoint_re_set_new_objfiles (void)
+{
+  struct cleanup *old_chain;
+
+  if (new_objfiles_incomplete || VEC_empty (objfilep, new_objfiles)
+      || re_set_objfiles != NULL)
+    {
+      breakpoint_re_set ();
+      return;
+    }
+
+  /* Breakpoints that cannot have locations in the new objfiles keep
+     the ones they have.  */
+  re_set_objfiles = new_objfiles;
+  new_objfiles = NULL;
+  old_chain = make_cleanup (VEC_cleanup (objfilep), &re_set_objfiles);
+  breakpoint_re_set ();
+  do_cleanups (old_chain);
+}
+
+/* Remember OBJFILE for breakpoint_re_set_new_objfiles, upon
+   notification of new_objfile.  A NULL OBJFILE means the symbols
+   were discarded.  */
+
+static void
+breakpoint_new_objfile (struct objfile *objfile)
+{
+  if (objfile == NULL)
+    new_objfiles_incomplete = 1;
+  else
+    VEC_safe_push (objfilep, new_objfiles, objfile);
+}
+
 /* Reset the thread number of this breakpoint:
 
    - If the breakpoint is for all threads, leave it as-is.
@@ -16024,6 +16370,11 @@ breakpoint_free_objfile (struct objfile *objfile)
   ALL_BP_LOCATIONS (loc, locp)
     if (loc->symtab != NULL && loc->symtab->objfile == objfile)
       loc->symtab = NULL;
+
+  /* Some breakpoints might have locations in OBJFILE; the next
+     re-set must look at all objfiles to drop them.  */
+  new_objfiles_incomplete = 1;
+  VEC_truncate (objfilep, new_objfiles, 0);
 }
 
 void
@@ -16234,6 +16585,7 @@ _initialize_breakpoint (void)
 
   observer_attach_solib_unloaded (disable_breakpoints_in_unloaded_shlib);
   observer_attach_free_objfile (disable_breakpoints_in_freed_objfile);
+  observer_attach_new_objfile (breakpoint_new_objfile);
   observer_attach_inferior_exit (clear_syscall_counts);
   observer_attach_memory_changed (invalidate_bp_value_on_memory_change);
 
@@ -320,6 +320,10 @@ struct bp_location
   /* The reference count.  */
   int refc;
 
+  /* The call of update_global_location_list that last put this
+     location in the global location array.  */
+  unsigned int location_generation;
+
   /* Type of this breakpoint location.  */
   enum bp_loc_type loc_type;
 
@@ -646,6 +650,9 @@ struct breakpoint
     const struct breakpoint_ops *ops;
 
     struct breakpoint *next;
+    /* Position of this breakpoint in the breakpoint chain; this
+       increases along the chain.  */
+    unsigned int chain_seq;
     /* Type of breakpoint.  */
     enum bptype type;
     /* Zero means disabled; remember the info but don't break here.  */
@@ -1162,6 +1169,12 @@ extern void update_breakpoint_locations (struct breakpoint *b,
 
 extern void breakpoint_re_set (void);
 
+/* Like breakpoint_re_set, but only look for new locations of the
+   breakpoints in the objfiles added since breakpoints were last
+   re-set, if that suffices.  */
+
+extern void breakpoint_re_set_new_objfiles (void);
+
 extern void breakpoint_re_set_thread (struct breakpoint *);
 
 extern struct breakpoint *set_momentary_breakpoint
@@ -25,8 +25,14 @@
 
 #include <string.h>
 
+#include "gdb_assert.h"
 #include "rsp-low.h"
 
+#if defined HAVE_ZLIB_H && !defined IN_PROCESS_AGENT
+#define USE_RSP_ZSTREAM 1
+#include <zlib.h>
+#endif
+
 /* See rsp-low.h.  */
 
 int
@@ -222,3 +228,219 @@ remote_unescape_input (const gdb_byte *buffer, int len,
   return output_index;
 }
 
+
+#ifdef USE_RSP_ZSTREAM
+
+/* The bytes that end a deflate block flushed with Z_SYNC_FLUSH.  */
+
+static const gdb_byte rsp_zstream_trailer[] = { 0x00, 0x00, 0xff, 0xff };
+
+/* An empty stored block, which is what Z_SYNC_FLUSH outputs when the
+   stream is byte-aligned.  */
+
+static const gdb_byte rsp_zstream_empty_block[]
+  = { 0x00, 0x00, 0x00, 0xff, 0xff };
+
+struct rsp_zstream
+{
+  /* Nonzero if this stream compresses packets.  */
+  int deflate;
+
+  /* The zlib state.  */
+  z_stream z;
+
+  /* The compressed, unescaped, bytes of the last packet.  */
+  gdb_byte *zbuf;
+  int zbuf_size;
+
+  /* The result of the last call.  */
+  char *buf;
+  int buf_size;
+};
+
+/* Make sure *BUF, of *SIZE bytes, can hold at least NEEDED bytes.  */
+
+static void
+rsp_zstream_reserve (void *bufp, int *size, int needed)
+{
+  gdb_byte **buf = bufp;
+
+  if (*size >= needed)
+    return;
+
+  while (*size < needed)
+    *size = *size != 0 ? *size * 2 : 256;
+  *buf = xrealloc (*buf, *size);
+}
+
+/* See rsp-low.h.  */
+
+struct rsp_zstream *
+rsp_zstream_new (int deflate)
+{
+  struct rsp_zstream *zs = xcalloc (1, sizeof (*zs));
+  int ret;
+
+  zs->deflate = deflate;
+  if (deflate)
+    ret = deflateInit2 (&zs->z, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+			-MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+  else
+    ret = inflateInit2 (&zs->z, -MAX_WBITS);
+
+  if (ret != Z_OK)
+    {
+      xfree (zs);
+      return NULL;
+    }
+
+  return zs;
+}
+
+/* See rsp-low.h.  */
+
+void
+rsp_zstream_free (struct rsp_zstream *zs)
+{
+  if (zs->deflate)
+    deflateEnd (&zs->z);
+  else
+    inflateEnd (&zs->z);
+  xfree (zs->zbuf);
+  xfree (zs->buf);
+  xfree (zs);
+}
+
+/* See rsp-low.h.  */
+
+char *
+rsp_zstream_deflate (struct rsp_zstream *zs, const char *buf, int len,
+		     int *out_len)
+{
+  z_stream *z = &zs->z;
+  int zlen = 0;
+  int escaped_len;
+  int ret;
+
+  gdb_assert (zs->deflate);
+
+  z->next_in = (Bytef *) buf;
+  z->avail_in = len;
+  do
+    {
+      rsp_zstream_reserve (&zs->zbuf, &zs->zbuf_size, zlen + len / 2 + 64);
+      z->next_out = zs->zbuf + zlen;
+      z->avail_out = zs->zbuf_size - zlen;
+      ret = deflate (z, Z_SYNC_FLUSH);
+      gdb_assert (ret == Z_OK || ret == Z_BUF_ERROR);
+      zlen = zs->zbuf_size - z->avail_out;
+    }
+  while (z->avail_out == 0);
+
+  /* With no input since the last flush, e.g. for an empty packet,
+     deflate outputs nothing; the receiver still needs a block to
+     inflate.  */
+  if (zlen == 0)
+    {
+      rsp_zstream_reserve (&zs->zbuf, &zs->zbuf_size,
+			   sizeof (rsp_zstream_empty_block));
+      memcpy (zs->zbuf, rsp_zstream_empty_block,
+	      sizeof (rsp_zstream_empty_block));
+      zlen = sizeof (rsp_zstream_empty_block);
+    }
+
+  /* Z_SYNC_FLUSH always ends the output with the same four bytes;
+     the receiver puts them back.  */
+  gdb_assert (zlen >= sizeof (rsp_zstream_trailer)
+	      && memcmp (zs->zbuf + zlen - sizeof (rsp_zstream_trailer),
+			 rsp_zstream_trailer,
+			 sizeof (rsp_zstream_trailer)) == 0);
+  zlen -= sizeof (rsp_zstream_trailer);
+
+  rsp_zstream_reserve (&zs->buf, &zs->buf_size, zlen * 2 + 1);
+  escaped_len = remote_escape_output (zs->zbuf, zlen, (gdb_byte *) zs->buf,
+				      &len, zs->buf_size);
+  gdb_assert (len == zlen);
+
+  *out_len = escaped_len;
+  return zs->buf;
+}
+
+/* See rsp-low.h.  */
+
+char *
+rsp_zstream_inflate (struct rsp_zstream *zs, const char *buf, int len,
+		     int *out_len)
+{
+  z_stream *z = &zs->z;
+  int zlen;
+  int olen = 0;
+  int ret;
+
+  gdb_assert (!zs->deflate);
+
+  rsp_zstream_reserve (&zs->zbuf, &zs->zbuf_size,
+		       len + sizeof (rsp_zstream_trailer));
+  zlen = remote_unescape_input ((const gdb_byte *) buf, len,
+				zs->zbuf, len);
+  memcpy (zs->zbuf + zlen, rsp_zstream_trailer,
+	  sizeof (rsp_zstream_trailer));
+  zlen += sizeof (rsp_zstream_trailer);
+
+  z->next_in = zs->zbuf;
+  z->avail_in = zlen;
+  do
+    {
+      rsp_zstream_reserve (&zs->buf, &zs->buf_size, olen + zlen * 4 + 1);
+      z->next_out = (Bytef *) zs->buf + olen;
+      /* Leave room for the terminating NUL.  */
+      z->avail_out = zs->buf_size - olen - 1;
+      ret = inflate (z, Z_SYNC_FLUSH);
+      if (ret != Z_OK && ret != Z_BUF_ERROR)
+	return NULL;
+      olen = zs->buf_size - 1 - z->avail_out;
+    }
+  while (z->avail_in != 0 || z->avail_out == 0);
+
+  zs->buf[olen] = '\0';
+  *out_len = olen;
+  return zs->buf;
+}
+
+#else /* USE_RSP_ZSTREAM */
+
+/* See rsp-low.h.  */
+
+struct rsp_zstream *
+rsp_zstream_new (int deflate)
+{
+  return NULL;
+}
+
+/* See rsp-low.h.  */
+
+void
+rsp_zstream_free (struct rsp_zstream *zs)
+{
+  gdb_assert_not_reached ("packet compression is not supported");
+}
+
+/* See rsp-low.h.  */
+
+char *
+rsp_zstream_deflate (struct rsp_zstream *zs, const char *buf, int len,
+		     int *out_len)
+{
+  gdb_assert_not_reached ("packet compression is not supported");
+}
+
+/* See rsp-low.h.  */
+
+char *
+rsp_zstream_inflate (struct rsp_zstream *zs, const char *buf, int len,
+		     int *out_len)
+{
+  gdb_assert_not_reached ("packet compression is not supported");
+}
+
+#endif /* USE_RSP_ZSTREAM */
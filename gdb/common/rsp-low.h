@@ -80,4 +80,43 @@ extern int remote_escape_output (const gdb_byte *buffer, int len,
 extern int remote_unescape_input (const gdb_byte *buffer, int len,
 				  gdb_byte *out_buf, int out_maxlen);
 
+/* A stream of compressed remote protocol packets, in one direction.
+   Each packet's payload is compressed with zlib's raw deflate format
+   and flushed at the end of the packet, so that the receiver can
+   decompress each packet as soon as it arrives, while the sender and
+   receiver keep the compression history across packets.  The four
+   bytes that end every flushed packet (00 00 ff ff) are not sent.
+   The compressed bytes are escaped like binary data.  */
+
+struct rsp_zstream;
+
+/* Return a new stream that compresses outgoing packets if DEFLATE is
+   nonzero, or that decompresses incoming packets otherwise.  Return
+   NULL if packet compression is not supported by this build.  */
+
+extern struct rsp_zstream *rsp_zstream_new (int deflate);
+
+/* Free ZS.  */
+
+extern void rsp_zstream_free (struct rsp_zstream *zs);
+
+/* Compress the LEN bytes of packet payload in BUF with ZS, and
+   escape the result.  Return a buffer owned by ZS holding the bytes
+   to put between the packet's start character and its checksum, and
+   set *OUT_LEN to its length.  The buffer is valid until the next
+   call with ZS.  */
+
+extern char *rsp_zstream_deflate (struct rsp_zstream *zs,
+				  const char *buf, int len, int *out_len);
+
+/* Reverse rsp_zstream_deflate: decompress the LEN bytes of packet
+   payload in BUF, as received between the packet's start character
+   and its checksum, with ZS.  Return a NUL-terminated buffer owned by
+   ZS, and set *OUT_LEN to its length not counting the NUL.  The
+   buffer is valid until the next call with ZS.  Return NULL if the
+   data is corrupt; the stream can not be used any further then.  */
+
+extern char *rsp_zstream_inflate (struct rsp_zstream *zs,
+				  const char *buf, int len, int *out_len);
+
 #endif /* COMMON_RSP_LOW_H */
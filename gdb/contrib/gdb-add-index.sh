@@ -1,6 +1,7 @@
 #! /bin/sh
 
-# Add a .gdb_index section to a file.
+# Add a .gdb_index section, or with -dwarf-5 a .debug_names section,
+# to a file.
 
 # Copyright (C) 2010-2014 Free Software Foundation, Inc.
 # This program is free software; you can redistribute it and/or modify
@@ -23,8 +24,14 @@ OBJCOPY=${OBJCOPY:=objcopy}
 
 myname="${0##*/}"
 
+dwarf5=""
+if test "$1" = "-dwarf-5"; then
+    dwarf5="$1"
+    shift
+fi
+
 if test $# != 1; then
-    echo "usage: $myname FILE" 1>&2
+    echo "usage: $myname [-dwarf-5] FILE" 1>&2
     exit 1
 fi
 
@@ -38,13 +45,16 @@ fi
 dir="${file%/*}"
 test "$dir" = "$file" && dir="."
 index="${file}.gdb-index"
+debug_names="${file}.debug_names"
+debug_str="${file}.debug_str"
+debug_str_merged="${file}.debug_str.merged"
 
-rm -f $index
-# Ensure intermediate index file is removed when we exit.
-trap "rm -f $index" 0
+rm -f $index $debug_names $debug_str $debug_str_merged
+# Ensure intermediate index files are removed when we exit.
+trap "rm -f $index $debug_names $debug_str $debug_str_merged" 0
 
 $GDB --batch -nx -iex 'set auto-load no' \
-    -ex "file $file" -ex "save gdb-index $dir" || {
+    -ex "file $file" -ex "save gdb-index $dwarf5 $dir" || {
     # Just in case.
     status=$?
     echo "$myname: gdb error generating index for $file" 1>&2
@@ -61,6 +71,14 @@ if test -f "$index"; then
     $OBJCOPY --add-section .gdb_index="$index" \
 	--set-section-flags .gdb_index=readonly "$file" "$file"
     status=$?
+elif test -f "$debug_names" && test -f "$debug_str"; then
+    # The names in the index have to be appended to .debug_str.
+    $OBJCOPY --dump-section .debug_str="$debug_str_merged" "$file" &&
+    cat "$debug_str" >> "$debug_str_merged" &&
+    $OBJCOPY --add-section .debug_names="$debug_names" \
+	--set-section-flags .debug_names=readonly \
+	--update-section .debug_str="$debug_str_merged" "$file" "$file"
+    status=$?
 else
     echo "$myname: No index was created for $file" 1>&2
     echo "$myname: [Was there no debuginfo? Was there already an index?]" 1>&2
@@ -24,7 +24,6 @@
 #include "gdbcore.h"
 #include "target-dcache.h"
 #include "inferior.h"
-#include "splay-tree.h"
 
 /* Commands with a prefix of `{set,show} dcache'.  */
 static struct cmd_list_element *dcache_set_list = NULL;
@@ -43,14 +42,23 @@ static struct cmd_list_element *dcache_show_list = NULL;
    significantly.  This is most useful when accessing a large amount
    of data, such as when performing a backtrace.
 
-   The cache is a splay tree along with a linked list for replacement.
-   Each block caches a LINE_SIZE area of memory.  Within each line we
-   remember the address of the line (which must be a multiple of
-   LINE_SIZE) and the actual data block.
+   The cache is set-associative: a line can only be stored in one set
+   of DCACHE_WAYS lines, chosen by its address, so looking a line up
+   only compares a few addresses.  When a set is full, its least
+   recently used line is replaced.  Each block caches a LINE_SIZE
+   area of memory.  Within each line we remember the address of the
+   line (which must be a multiple of LINE_SIZE) and the actual data
+   block.
 
    Lines are only allocated as needed, so DCACHE_SIZE really specifies the
    *maximum* number of lines in the cache.
 
+   When lines are missed in sequence, as when walking up the stack or
+   printing a large object, the cache reads the following lines ahead
+   in the same request, doubling the number of lines read ahead on each
+   sequential miss, up to DCACHE_READ_AHEAD.  This saves most of the
+   round trips to a remote target.
+
    At present, the cache is write-through rather than writeback: as soon
    as data is written to the cache, it is also immediately written to
    the target.  Therefore, cache lines are never "dirty".  Whether a given
@@ -83,6 +91,14 @@ static unsigned dcache_size = DCACHE_DEFAULT_SIZE;
 #define DCACHE_DEFAULT_LINE_SIZE 64
 static unsigned dcache_line_size = DCACHE_DEFAULT_LINE_SIZE;
 
+/* The maximum number of lines read ahead on a sequential miss.  Zero
+   disables reading ahead.  */
+#define DCACHE_DEFAULT_READ_AHEAD 16
+static unsigned dcache_read_ahead = DCACHE_DEFAULT_READ_AHEAD;
+
+/* The number of lines in each set.  */
+#define DCACHE_WAYS 4
+
 /* Each cache block holds LINE_SIZE bytes of data
    starting at a multiple-of-LINE_SIZE address.  */
 
@@ -92,22 +108,30 @@ static unsigned dcache_line_size = DCACHE_DEFAULT_LINE_SIZE;
 
 struct dcache_block
 {
-  /* For least-recently-allocated and free lists.  */
+  /* For the free list.  */
   struct dcache_block *prev;
   struct dcache_block *next;
 
   CORE_ADDR addr;		/* address of data */
   int refs;			/* # hits */
+
+  /* Non-zero if dcache_read_lines read this line for an access that
+     has not looked it up yet.  That lookup is the miss.  */
+  int pending_miss;
+
   gdb_byte data[1];		/* line_size bytes at given address */
 };
 
 struct dcache_struct
 {
-  splay_tree tree;
-  struct dcache_block *oldest; /* least-recently-allocated list.  */
-
-  /* The free list is maintained identically to OLDEST to simplify
-     the code: we only need one set of accessors.  */
+  /* The lines in the cache, as NUM_SETS sets of DCACHE_WAYS entries.
+     The lines of each set are ordered from the most to the least
+     recently used, and its unused entries, which are NULL, come
+     last.  */
+  struct dcache_block **sets;
+  int num_sets;
+
+  /* The free list.  */
   struct dcache_block *freelist;
 
   /* The number of in-use lines in the cache.  */
@@ -116,6 +140,19 @@ struct dcache_struct
 
   /* The ptid of last inferior to use cache or null_ptid.  */
   ptid_t ptid;
+
+  /* The address of the last line read from the target because of a
+     miss, including the lines read ahead, and the number of lines
+     read ahead then.  Zero if the last miss was not sequential.  */
+  CORE_ADDR last_miss;
+  int read_ahead;
+
+  /* Statistics, kept across invalidations: the number of line lookups
+     the cache satisfied, the number of lines it had to read from the
+     target, and the number of lines it read ahead.  */
+  ULONGEST hits;
+  ULONGEST misses;
+  ULONGEST lines_read_ahead;
 };
 
 typedef void (block_func) (struct dcache_block *block, void *param);
@@ -141,8 +178,6 @@ show_dcache_enabled_p (struct ui_file *file, int from_tty,
 
 /* Add BLOCK to circular block list BLIST, behind the block at *BLIST.
    *BLIST is not updated (unless it was previously NULL of course).
-   This is for the least-recently-allocated list's sake:
-   BLIST points to the oldest block.
    ??? This makes for poor cache usage of the free list,
    but is it measurable?  */
 
@@ -155,8 +190,6 @@ append_block (struct dcache_block **blist, struct dcache_block *block)
       block->prev = (*blist)->prev;
       block->prev->next = block;
       (*blist)->prev = block;
-      /* We don't update *BLIST here to maintain the invariant that for the
-	 least-recently-allocated list *BLIST points to the oldest block.  */
     }
   else
     {
@@ -179,9 +212,8 @@ remove_block (struct dcache_block **blist, struct dcache_block *block)
     {
       block->next->prev = block->prev;
       block->prev->next = block->next;
-      /* If we removed the block *BLIST points to, shift it to the next block
-	 to maintain the invariant that for the least-recently-allocated list
-	 *BLIST points to the oldest block.  */
+      /* If we removed the block *BLIST points to, shift it to the next
+	 block.  */
       if (*blist == block)
 	*blist = block->next;
     }
@@ -218,29 +250,36 @@ free_block (struct dcache_block *block, void *param)
   xfree (block);
 }
 
-/* Free a data cache.  */
+/* Return the number of sets a cache of DCACHE_SIZE lines has.  */
 
-void
-dcache_free (DCACHE *dcache)
+static int
+dcache_num_sets (void)
 {
-  splay_tree_delete (dcache->tree);
-  for_each_block (&dcache->oldest, free_block, NULL);
-  for_each_block (&dcache->freelist, free_block, NULL);
-  xfree (dcache);
+  return (dcache_size + DCACHE_WAYS - 1) / DCACHE_WAYS;
 }
 
+/* Return the set of DCACHE that may hold ADDR.  */
 
-/* BLOCK_FUNC function for dcache_invalidate.
-   This doesn't remove the block from the oldest list on purpose.
-   dcache_invalidate will do it later.  */
+static struct dcache_block **
+dcache_set (DCACHE *dcache, CORE_ADDR addr)
+{
+  ULONGEST set = (addr / dcache->line_size) % dcache->num_sets;
 
-static void
-invalidate_block (struct dcache_block *block, void *param)
+  return &dcache->sets[set * DCACHE_WAYS];
+}
+
+/* Free a data cache.  */
+
+void
+dcache_free (DCACHE *dcache)
 {
-  DCACHE *dcache = (DCACHE *) param;
+  int i;
 
-  splay_tree_remove (dcache->tree, (splay_tree_key) block->addr);
-  append_block (&dcache->freelist, block);
+  for (i = 0; i < dcache->num_sets * DCACHE_WAYS; i++)
+    xfree (dcache->sets[i]);
+  xfree (dcache->sets);
+  for_each_block (&dcache->freelist, free_block, NULL);
+  xfree (dcache);
 }
 
 /* Free all the data cache blocks, thus discarding all cached data.  */
@@ -248,11 +287,18 @@ invalidate_block (struct dcache_block *block, void *param)
 void
 dcache_invalidate (DCACHE *dcache)
 {
-  for_each_block (&dcache->oldest, invalidate_block, dcache);
+  int i;
+
+  for (i = 0; i < dcache->num_sets * DCACHE_WAYS; i++)
+    if (dcache->sets[i] != NULL)
+      {
+	append_block (&dcache->freelist, dcache->sets[i]);
+	dcache->sets[i] = NULL;
+      }
 
-  dcache->oldest = NULL;
   dcache->size = 0;
   dcache->ptid = null_ptid;
+  dcache->read_ahead = 0;
 
   if (dcache->line_size != dcache_line_size)
     {
@@ -263,6 +309,32 @@ dcache_invalidate (DCACHE *dcache)
       dcache->freelist = NULL;
       dcache->line_size = dcache_line_size;
     }
+
+  if (dcache->num_sets != dcache_num_sets ())
+    {
+      /* We've been asked to use a different number of lines.  */
+      xfree (dcache->sets);
+      dcache->num_sets = dcache_num_sets ();
+      dcache->sets = XCNEWVEC (struct dcache_block *,
+			       dcache->num_sets * DCACHE_WAYS);
+    }
+}
+
+/* Return the entry of DCACHE holding the line of ADDR, or NULL if it
+   isn't cached.  */
+
+static struct dcache_block **
+dcache_lookup (DCACHE *dcache, CORE_ADDR addr)
+{
+  struct dcache_block **set = dcache_set (dcache, addr);
+  CORE_ADDR line = MASK (dcache, addr);
+  int i;
+
+  for (i = 0; i < DCACHE_WAYS && set[i] != NULL; i++)
+    if (set[i]->addr == line)
+      return &set[i];
+
+  return NULL;
 }
 
 /* Invalidate the line associated with ADDR.  */
@@ -270,13 +342,16 @@ dcache_invalidate (DCACHE *dcache)
 static void
 dcache_invalidate_line (DCACHE *dcache, CORE_ADDR addr)
 {
-  struct dcache_block *db = dcache_hit (dcache, addr);
+  struct dcache_block **entry = dcache_lookup (dcache, addr);
 
-  if (db)
+  if (entry != NULL)
     {
-      splay_tree_remove (dcache->tree, (splay_tree_key) db->addr);
-      remove_block (&dcache->oldest, db);
-      append_block (&dcache->freelist, db);
+      struct dcache_block **set = dcache_set (dcache, addr);
+
+      append_block (&dcache->freelist, *entry);
+      memmove (entry, entry + 1,
+	       (set + DCACHE_WAYS - 1 - entry) * sizeof (*entry));
+      set[DCACHE_WAYS - 1] = NULL;
       --dcache->size;
     }
 }
@@ -287,15 +362,19 @@ dcache_invalidate_line (DCACHE *dcache, CORE_ADDR addr)
 static struct dcache_block *
 dcache_hit (DCACHE *dcache, CORE_ADDR addr)
 {
+  struct dcache_block **entry = dcache_lookup (dcache, addr);
+  struct dcache_block **set;
   struct dcache_block *db;
 
-  splay_tree_node node = splay_tree_lookup (dcache->tree,
-					    (splay_tree_key) MASK (dcache, addr));
-
-  if (!node)
+  if (entry == NULL)
     return NULL;
 
-  db = (struct dcache_block *) node->value;
+  /* Make the line the most recently used of its set.  */
+  set = dcache_set (dcache, addr);
+  db = *entry;
+  memmove (set + 1, set, (entry - set) * sizeof (*entry));
+  set[0] = db;
+
   db->refs++;
   return db;
 }
@@ -349,21 +428,19 @@ dcache_read_line (DCACHE *dcache, struct dcache_block *db)
   return 1;
 }
 
-/* Get a free cache block, put or keep it on the valid list,
-   and return its address.  */
+/* Get a free cache block, put it first in its set, and return its
+   address.  */
 
 static struct dcache_block *
 dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
 {
+  struct dcache_block **set = dcache_set (dcache, addr);
   struct dcache_block *db;
 
-  if (dcache->size >= dcache_size)
+  if (set[DCACHE_WAYS - 1] != NULL)
     {
-      /* Evict the least recently allocated line.  */
-      db = dcache->oldest;
-      remove_block (&dcache->oldest, db);
-
-      splay_tree_remove (dcache->tree, (splay_tree_key) db->addr);
+      /* Evict the least recently used line of the set.  */
+      db = set[DCACHE_WAYS - 1];
     }
   else
     {
@@ -379,65 +456,201 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
 
   db->addr = MASK (dcache, addr);
   db->refs = 0;
+  db->pending_miss = 0;
 
-  /* Put DB at the end of the list, it's the newest.  */
-  append_block (&dcache->oldest, db);
-
-  splay_tree_insert (dcache->tree, (splay_tree_key) db->addr,
-		     (splay_tree_value) db);
+  memmove (set + 1, set, (DCACHE_WAYS - 1) * sizeof (*set));
+  set[0] = db;
 
   return db;
 }
 
-/* Using the data cache DCACHE, store in *PTR the contents of the byte at
-   address ADDR in the remote machine.  
-
-   Returns 1 for success, 0 for error.  */
+/* Fill DB, and the COUNT lines following it, with a single read from
+   target memory.  The result is 1 for success, 0 if the lines
+   couldn't all be read, in which case none of them is changed.  */
 
 static int
-dcache_peek_byte (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr)
+dcache_read_lines_ahead (DCACHE *dcache, struct dcache_block *db, int count)
 {
-  struct dcache_block *db = dcache_hit (dcache, addr);
-
-  if (!db)
+  ULONGEST line_size = dcache->line_size;
+  struct mem_region *region = lookup_mem_region (db->addr);
+  gdb_byte *buf;
+  int i, res;
+
+  /* Only read ahead within the region of DB, and stop at the first
+     line that is already cached.  */
+  for (i = 1; i <= count; i++)
     {
-      db = dcache_alloc (dcache, addr);
+      CORE_ADDR addr = db->addr + i * line_size;
 
-      if (!dcache_read_line (dcache, db))
-         return 0;
+      if (addr < db->addr
+	  || (region->hi != 0 && addr + line_size > region->hi)
+	  || dcache_lookup (dcache, addr) != NULL)
+	break;
     }
+  count = i - 1;
 
-  *ptr = db->data[XFORM (dcache, addr)];
-  return 1;
-}
+  if (count == 0
+      || region->attrib.mode == MEM_WO
+      || (region->hi != 0 && db->addr + line_size > region->hi))
+    return 0;
+
+  buf = xmalloc ((count + 1) * line_size);
+  res = target_read_raw_memory (db->addr, buf, (count + 1) * line_size);
+  if (res == 0)
+    {
+      memcpy (db->data, buf, line_size);
+      for (i = 1; i <= count; i++)
+	{
+	  struct dcache_block *next
+	    = dcache_alloc (dcache, db->addr + i * line_size);
 
-/* Write the byte at PTR into ADDR in the data cache.
+	  memcpy (next->data, buf + i * line_size, line_size);
+	}
+      dcache->lines_read_ahead += count;
+    }
+  xfree (buf);
 
-   The caller should have written the data through to target memory
-   already.
+  return res == 0;
+}
 
-   If ADDR is not in cache, this function does nothing; writing to an
-   area of memory which wasn't present in the cache doesn't cause it
-   to be loaded in.  */
+/* Return the line of DCACHE holding ADDR, reading it from target memory
+   if it isn't cached yet, or NULL if it can't be read.  */
 
-static void
-dcache_poke_byte (DCACHE *dcache, CORE_ADDR addr, const gdb_byte *ptr)
+static struct dcache_block *
+dcache_get_line (DCACHE *dcache, CORE_ADDR addr)
 {
   struct dcache_block *db = dcache_hit (dcache, addr);
+  CORE_ADDR line;
+  int ahead = 0;
 
-  if (db)
-    db->data[XFORM (dcache, addr)] = *ptr;
+  if (db != NULL)
+    {
+      if (db->pending_miss)
+	{
+	  db->pending_miss = 0;
+	  db->refs = 0;
+	  dcache->misses++;
+	}
+      else
+	dcache->hits++;
+      return db;
+    }
+
+  dcache->misses++;
+
+  /* If this miss follows the previous one, read ahead twice as many
+     lines as the last time.  Don't read more lines than there are
+     sets, or they would evict each other.  */
+  line = MASK (dcache, addr);
+  if (dcache->last_miss + dcache->line_size == line
+      && !ptid_equal (dcache->ptid, null_ptid))
+    {
+      ahead = dcache->read_ahead > 0 ? 2 * dcache->read_ahead : 1;
+      if (ahead > dcache_read_ahead)
+	ahead = dcache_read_ahead;
+      if (ahead > dcache->num_sets - 1)
+	ahead = dcache->num_sets - 1;
+    }
+
+  db = dcache_alloc (dcache, addr);
+
+  if (ahead > 0 && dcache_read_lines_ahead (dcache, db, ahead))
+    {
+      dcache->read_ahead = ahead;
+      dcache->last_miss = line + ahead * dcache->line_size;
+      return db;
+    }
+
+  dcache->read_ahead = 0;
+  dcache->last_miss = line;
+
+  if (!dcache_read_line (dcache, db))
+    {
+      /* That failed.  Discard its cache line so we don't have a
+	 partially read line.  */
+      dcache_invalidate_line (dcache, addr);
+      return NULL;
+    }
+
+  return db;
 }
 
-static int
-dcache_splay_tree_compare (splay_tree_key a, splay_tree_key b)
+/* Read the lines of DCACHE covering LEN bytes at MEMADDR that are not
+   cached yet, with a single vectored read.  Lines that cross a memory
+   region boundary are left for dcache_read_line, and so are lines the
+   target fails to read, so that their error is reported as usual.
+   The lines read are counted as misses when dcache_get_line looks
+   them up.  */
+
+static void
+dcache_read_lines (DCACHE *dcache, CORE_ADDR memaddr, ULONGEST len)
 {
-  if (a > b)
-    return 1;
-  else if (a == b)
-    return 0;
-  else
-    return -1;
+  struct memory_read_request *requests;
+  struct cleanup *old_chain;
+  gdb_byte *buf;
+  CORE_ADDR addr, end;
+  ULONGEST max;
+  int count, i;
+
+  if (len == 0)
+    return;
+
+  end = memaddr + len;
+  max = ((MASK (dcache, end - 1) - MASK (dcache, memaddr))
+	 / dcache->line_size + 1);
+  /* Don't let the lines of this read evict each other.  */
+  if (max > dcache->num_sets)
+    max = dcache->num_sets;
+  /* dcache_get_line reads a single line just as well.  */
+  if (max < 2)
+    return;
+
+  requests = XNEWVEC (struct memory_read_request, max);
+  old_chain = make_cleanup (xfree, requests);
+
+  count = 0;
+  for (addr = MASK (dcache, memaddr);
+       addr < end && count < max;
+       addr += dcache->line_size)
+    {
+      struct mem_region *region;
+
+      if (dcache_lookup (dcache, addr) != NULL)
+	continue;
+
+      region = lookup_mem_region (addr);
+      if (region->attrib.mode == MEM_WO
+	  || (region->hi != 0 && addr + dcache->line_size > region->hi))
+	continue;
+
+      requests[count].memaddr = addr;
+      requests[count].len = dcache->line_size;
+      count++;
+    }
+
+  if (count >= 2)
+    {
+      /* Read into a separate buffer, and only then into the cache, so
+	 that an error leaves no half-filled lines behind.  */
+      buf = xmalloc (count * dcache->line_size);
+      make_cleanup (xfree, buf);
+      for (i = 0; i < count; i++)
+	requests[i].buf = buf + i * dcache->line_size;
+
+      target_read_raw_memory_vector (requests, count);
+
+      for (i = 0; i < count; i++)
+	if (requests[i].status == TARGET_XFER_OK)
+	  {
+	    struct dcache_block *db
+	      = dcache_alloc (dcache, requests[i].memaddr);
+
+	    memcpy (db->data, requests[i].buf, dcache->line_size);
+	    db->pending_miss = 1;
+	  }
+    }
+
+  do_cleanups (old_chain);
 }
 
 /* Allocate and initialize a data cache.  */
@@ -447,13 +660,11 @@ dcache_init (void)
 {
   DCACHE *dcache;
 
-  dcache = (DCACHE *) xmalloc (sizeof (*dcache));
+  dcache = XCNEW (DCACHE);
 
-  dcache->tree = splay_tree_new (dcache_splay_tree_compare,
-				 NULL,
-				 NULL);
-
-  dcache->oldest = NULL;
+  dcache->num_sets = dcache_num_sets ();
+  dcache->sets = XCNEWVEC (struct dcache_block *,
+			   dcache->num_sets * DCACHE_WAYS);
   dcache->freelist = NULL;
   dcache->size = 0;
   dcache->line_size = dcache_line_size;
@@ -484,15 +695,21 @@ dcache_read_memory_partial (struct target_ops *ops, DCACHE *dcache,
       dcache->ptid = inferior_ptid;
     }
 
-  for (i = 0; i < len; i++)
+  dcache_read_lines (dcache, memaddr, len);
+
+  i = 0;
+  while (i < len)
     {
-      if (!dcache_peek_byte (dcache, memaddr + i, myaddr + i))
-	{
-	  /* That failed.  Discard its cache line so we don't have a
-	     partially read line.  */
-	  dcache_invalidate_line (dcache, memaddr + i);
-	  break;
-	}
+      CORE_ADDR addr = memaddr + i;
+      ULONGEST offset = XFORM (dcache, addr);
+      ULONGEST n = min (dcache->line_size - offset, len - i);
+      struct dcache_block *db = dcache_get_line (dcache, addr);
+
+      if (db == NULL)
+	break;
+
+      memcpy (myaddr + i, db->data + offset, n);
+      i += n;
     }
 
   if (i == 0)
@@ -518,24 +735,111 @@ dcache_read_memory_partial (struct target_ops *ops, DCACHE *dcache,
 
 /* Just update any cache lines which are already present.  This is
    called by the target_xfer_partial machinery when writing raw
-   memory.  */
+   memory.  Writing to an area of memory which wasn't present in the
+   cache doesn't cause it to be loaded in.  */
 
 void
 dcache_update (DCACHE *dcache, enum target_xfer_status status,
 	       CORE_ADDR memaddr, const gdb_byte *myaddr,
 	       ULONGEST len)
 {
-  ULONGEST i;
+  ULONGEST i = 0;
 
-  for (i = 0; i < len; i++)
-    if (status == TARGET_XFER_OK)
-      dcache_poke_byte (dcache, memaddr + i, myaddr + i);
-    else
-      {
-	/* Discard the whole cache line so we don't have a partially
-	   valid line.  */
-	dcache_invalidate_line (dcache, memaddr + i);
-      }
+  while (i < len)
+    {
+      CORE_ADDR addr = memaddr + i;
+      ULONGEST offset = XFORM (dcache, addr);
+      ULONGEST n = min (dcache->line_size - offset, len - i);
+
+      if (status == TARGET_XFER_OK)
+	{
+	  struct dcache_block **entry = dcache_lookup (dcache, addr);
+
+	  if (entry != NULL)
+	    memcpy ((*entry)->data + offset, myaddr + i, n);
+	}
+      else
+	{
+	  /* Discard the whole cache line so we don't have a partially
+	     valid line.  */
+	  dcache_invalidate_line (dcache, addr);
+	}
+
+      i += n;
+    }
+}
+
+/* Store the LEN bytes at MYADDR, which were read from the memory of
+   thread PTID at MEMADDR, in the lines of DCACHE that they cover
+   whole.  This lets a target seed the cache with memory that came
+   along with some other reply.  */
+
+void
+dcache_fill (DCACHE *dcache, ptid_t ptid, CORE_ADDR memaddr,
+	     const gdb_byte *myaddr, ULONGEST len)
+{
+  ULONGEST offset;
+
+  if (! ptid_equal (ptid, dcache->ptid))
+    {
+      dcache_invalidate (dcache);
+      dcache->ptid = ptid;
+    }
+
+  for (offset = MASK (dcache, memaddr + dcache->line_size - 1) - memaddr;
+       offset + dcache->line_size <= len;
+       offset += dcache->line_size)
+    {
+      CORE_ADDR addr = memaddr + offset;
+      struct mem_region *region = lookup_mem_region (addr);
+      struct dcache_block **entry;
+      struct dcache_block *db;
+
+      /* Like dcache_read_lines, leave alone the lines that cross a
+	 memory region boundary.  */
+      if (region->attrib.mode == MEM_WO
+	  || (region->hi != 0 && addr + dcache->line_size > region->hi))
+	continue;
+
+      entry = dcache_lookup (dcache, addr);
+      db = entry != NULL ? *entry : dcache_alloc (dcache, addr);
+      memcpy (db->data, myaddr + offset, dcache->line_size);
+    }
+}
+
+/* qsort comparison function for cache lines, ordering them by
+   address.  */
+
+static int
+compare_blocks (const void *a, const void *b)
+{
+  const struct dcache_block *da = *(const struct dcache_block **) a;
+  const struct dcache_block *db = *(const struct dcache_block **) b;
+
+  if (da->addr < db->addr)
+    return -1;
+  else if (da->addr > db->addr)
+    return 1;
+  return 0;
+}
+
+/* Return the lines of DCACHE ordered by address, in an xmalloc'd
+   array of DCACHE->size elements.  */
+
+static struct dcache_block **
+dcache_sorted_lines (DCACHE *dcache)
+{
+  struct dcache_block **lines = XNEWVEC (struct dcache_block *,
+					 dcache->size);
+  int i, n = 0;
+
+  for (i = 0; i < dcache->num_sets * DCACHE_WAYS; i++)
+    if (dcache->sets[i] != NULL)
+      lines[n++] = dcache->sets[i];
+  gdb_assert (n == dcache->size);
+
+  qsort (lines, n, sizeof (*lines), compare_blocks);
+  return lines;
 }
 
 /* Print DCACHE line INDEX.  */
@@ -543,9 +847,9 @@ dcache_update (DCACHE *dcache, enum target_xfer_status status,
 static void
 dcache_print_line (DCACHE *dcache, int index)
 {
-  splay_tree_node n;
+  struct dcache_block **lines;
   struct dcache_block *db;
-  int i, j;
+  int j;
 
   if (dcache == NULL)
     {
@@ -553,22 +857,15 @@ dcache_print_line (DCACHE *dcache, int index)
       return;
     }
 
-  n = splay_tree_min (dcache->tree);
-
-  for (i = index; i > 0; --i)
-    {
-      if (!n)
-	break;
-      n = splay_tree_successor (dcache->tree, n->key);
-    }
-
-  if (!n)
+  if (index >= dcache->size)
     {
       printf_filtered (_("No such cache line exists.\n"));
       return;
     }
-    
-  db = (struct dcache_block *) n->value;
+
+  lines = dcache_sorted_lines (dcache);
+  db = lines[index];
+  xfree (lines);
 
   printf_filtered (_("Line %d: address %s [%d hits]\n"),
 		   index, paddress (target_gdbarch (), db->addr), db->refs);
@@ -589,7 +886,8 @@ dcache_print_line (DCACHE *dcache, int index)
 static void
 dcache_info_1 (DCACHE *dcache, char *exp)
 {
-  splay_tree_node n;
+  struct dcache_block **lines;
+  struct cleanup *old_chain;
   int i, refcount;
 
   if (exp)
@@ -607,10 +905,18 @@ dcache_info_1 (DCACHE *dcache, char *exp)
       return;
     }
 
-  printf_filtered (_("Dcache %u lines of %u bytes each.\n"),
+  printf_filtered (_("Dcache %u lines of %u bytes each, "
+		     "in sets of %d lines.\n"),
 		   dcache_size,
 		   dcache ? (unsigned) dcache->line_size
-		   : dcache_line_size);
+		   : dcache_line_size,
+		   DCACHE_WAYS);
+
+  if (dcache != NULL)
+    printf_filtered (_("Statistics: %s hits, %s misses, "
+		       "%s lines read ahead.\n"),
+		     pulongest (dcache->hits), pulongest (dcache->misses),
+		     pulongest (dcache->lines_read_ahead));
 
   if (dcache == NULL || ptid_equal (dcache->ptid, null_ptid))
     {
@@ -623,21 +929,20 @@ dcache_info_1 (DCACHE *dcache, char *exp)
 
   refcount = 0;
 
-  n = splay_tree_min (dcache->tree);
-  i = 0;
+  lines = dcache_sorted_lines (dcache);
+  old_chain = make_cleanup (xfree, lines);
 
-  while (n)
+  for (i = 0; i < dcache->size; i++)
     {
-      struct dcache_block *db = (struct dcache_block *) n->value;
+      struct dcache_block *db = lines[i];
 
       printf_filtered (_("Line %d: address %s [%d hits]\n"),
 		       i, paddress (target_gdbarch (), db->addr), db->refs);
-      i++;
       refcount += db->refs;
-
-      n = splay_tree_successor (dcache->tree, n->key);
     }
 
+  do_cleanups (old_chain);
+
   printf_filtered (_("Cache state: %d active lines, %d hits\n"), i, refcount);
 }
 
@@ -732,4 +1037,14 @@ Show number of dcache lines."),
 			     set_dcache_size,
 			     NULL,
 			     &dcache_set_list, &dcache_show_list);
+  add_setshow_zuinteger_cmd ("read-ahead", class_obscure,
+			     &dcache_read_ahead, _("\
+Set the maximum number of dcache lines read ahead."), _("\
+Show the maximum number of dcache lines read ahead."), _("\
+When memory is read in sequence, the dcache reads more and more of the\n\
+following lines along with the line it misses, up to this many.\n\
+Zero disables reading ahead."),
+			     NULL,
+			     NULL,
+			     &dcache_set_list, &dcache_show_list);
 }
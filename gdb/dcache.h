@@ -41,4 +41,7 @@ void dcache_update (DCACHE *dcache, enum target_xfer_status status,
 		    CORE_ADDR memaddr, const gdb_byte *myaddr,
 		    ULONGEST len);
 
+void dcache_fill (DCACHE *dcache, ptid_t ptid, CORE_ADDR memaddr,
+		  const gdb_byte *myaddr, ULONGEST len);
+
 #endif /* DCACHE_H */
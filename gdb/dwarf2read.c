@@ -70,11 +70,18 @@
 #include "source.h"
 #include "filestuff.h"
 #include "build-id.h"
+#include "cli/cli-utils.h"
 
 #include <fcntl.h>
 #include <string.h>
 #include "gdb_assert.h"
 #include <sys/types.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#ifndef MAP_FAILED
+#define MAP_FAILED ((void *) -1)
+#endif
+#endif
 
 typedef struct symbol *symbolp;
 DEF_VEC_P (symbolp);
@@ -93,6 +100,15 @@ static int check_physname = 0;
 /* When non-zero, do not reject deprecated .gdb_index sections.  */
 static int use_deprecated_index_sections = 0;
 
+/* When non-zero, save the index of each objfile whose partial symbols
+   we build in the index cache, and use indices from the cache for
+   objfiles that have no .gdb_index section.  */
+static int index_cache_enabled = 0;
+
+/* The directory holding the index cache.  Cache files are named after
+   the build-id of the objfile they describe.  */
+static char *index_cache_directory;
+
 static const struct objfile_data *dwarf2_objfile_data_key;
 
 /* The "aclass" indices for various kinds of computed DWARF symbols.  */
@@ -202,6 +218,9 @@ struct mapped_index
 typedef struct dwarf2_per_cu_data *dwarf2_per_cu_ptr;
 DEF_VEC_P (dwarf2_per_cu_ptr);
 
+typedef struct abbrev_table *abbrev_table_ptr;
+DEF_VEC_P (abbrev_table_ptr);
+
 /* Collection of data recorded per objfile.
    This hangs off of dwarf2_objfile_data_key.  */
 
@@ -219,6 +238,8 @@ struct dwarf2_per_objfile
   struct dwarf2_section_info frame;
   struct dwarf2_section_info eh_frame;
   struct dwarf2_section_info gdb_index;
+  struct dwarf2_section_info debug_names;
+  struct dwarf2_section_info debug_aranges;
 
   VEC (dwarf2_section_info_def) *types;
 
@@ -293,6 +314,17 @@ struct dwarf2_per_objfile
   /* The mapped index, or NULL if .gdb_index is missing or not being used.  */
   struct mapped_index *index_table;
 
+  /* If INDEX_TABLE was read from the index cache rather than from the
+     .gdb_index section, the contents of the cache file.  If
+     INDEX_CACHE_MAPPED is non-zero they were mmapped, otherwise they
+     were allocated with xmalloc.  */
+  gdb_byte *index_cache_contents;
+  size_t index_cache_size;
+  unsigned char index_cache_mapped;
+
+  /* Non-zero if INDEX_TABLE was built from the .debug_names section.  */
+  unsigned char index_from_debug_names;
+
   /* When using index_table, this keeps track of all quick_file_names entries.
      TUs typically share line table entries with a CU, so we maintain a
      separate table of all line table entries to support the sharing.
@@ -313,6 +345,17 @@ struct dwarf2_per_objfile
 
   /* The CUs we recently read.  */
   VEC (dwarf2_per_cu_ptr) *just_read_cus;
+
+  /* A cache of the results of dwarf2_canonicalize_name, holding
+     struct canonical_name_entry objects.  Canonicalizing a C++ name
+     requires parsing it, and the same names are seen in many CUs, and
+     again when the CUs are expanded after reading psymtabs.  This is
+     NULL if not allocated yet.  */
+  htab_t canonical_names;
+
+  /* The abbrev tables most recently read by dwarf2_read_abbrevs, most
+     recently used first.  See abbrev_cache_get.  */
+  VEC (abbrev_table_ptr) *abbrev_cache;
 };
 
 static struct dwarf2_per_objfile *dwarf2_per_objfile;
@@ -337,6 +380,8 @@ static const struct dwarf2_debug_sections dwarf2_elf_names =
   { ".debug_frame", ".zdebug_frame" },
   { ".eh_frame", NULL },
   { ".gdb_index", ".zgdb_index" },
+  { ".debug_names", ".zdebug_names" },
+  { ".debug_aranges", ".zdebug_aranges" },
   23
 };
 
@@ -528,6 +573,11 @@ struct dwarf2_cu
      whether the DW_AT_ranges attribute came from the skeleton or DWO.  */
   ULONGEST ranges_base;
 
+  /* Non-NULL while write_debug_names_file scans this CU.  The partial
+     symbols the scan would create are then recorded here as name index
+     entries instead.  */
+  struct debug_names_cu_entries *debug_names_entries;
+
   /* Mark used when releasing cached dies.  */
   unsigned int mark : 1;
 
@@ -1168,6 +1218,10 @@ struct attr_abbrev
     ENUM_BITFIELD(dwarf_form) form : 16;
   };
 
+/* The number of unused abbrev tables kept in
+   dwarf2_per_objfile->abbrev_cache.  */
+#define ABBREV_CACHE_SIZE 16
+
 /* Size of abbrev_table.abbrev_hash_table.  */
 #define ABBREV_HASH_SIZE 121
 
@@ -1177,6 +1231,7 @@ struct abbrev_table
 {
   /* Where the abbrev table came from.
      This is used as a sanity check when the table is used.  */
+  struct dwarf2_section_info *section;
   sect_offset offset;
 
   /* Storage for the abbrev table.  */
@@ -1187,6 +1242,18 @@ struct abbrev_table
      It could be statically allocated, but the previous code didn't so we
      don't either.  */
   struct abbrev_info **abbrevs;
+
+  /* Producers number abbrevs densely from 1, so most tables can also
+     be indexed directly by abbrev number.  If so, this is an array of
+     NUM_ABBREVS_BY_NUMBER entries allocated in abbrev_obstack, with
+     NULL for the numbers that are not used.  Otherwise it is NULL.  */
+  struct abbrev_info **abbrevs_by_number;
+  unsigned int num_abbrevs_by_number;
+
+  /* Non-zero if this table is owned by dwarf2_per_objfile->abbrev_cache,
+     in which case USERS is the number of CUs currently using it.  */
+  unsigned char cached;
+  int users;
 };
 
 /* Attributes have a name and a value.  */
@@ -1368,6 +1435,8 @@ show_dwarf2_max_cache_age (struct ui_file *file, int from_tty,
 
 /* local function prototypes */
 
+static void index_cache_store (struct objfile *objfile);
+
 static const char *get_section_name (const struct dwarf2_section_info *);
 
 static const char *get_section_file_name (const struct dwarf2_section_info *);
@@ -1389,6 +1458,11 @@ static void scan_partial_symbols (struct partial_die_info *,
 static void add_partial_symbol (struct partial_die_info *,
 				struct dwarf2_cu *);
 
+static void debug_names_record_entry (struct dwarf2_cu *cu,
+				      struct partial_die_info *pdi,
+				      const char *qualified_name,
+				      int is_static);
+
 static void add_partial_namespace (struct partial_die_info *pdi,
 				   CORE_ADDR *lowpc, CORE_ADDR *highpc,
 				   int need_pc, struct dwarf2_cu *cu);
@@ -1975,6 +2049,10 @@ attr_value_as_address (struct attribute *attr)
 /* The suffix for an index file.  */
 #define INDEX_SUFFIX ".gdb-index"
 
+/* The suffixes for the files written by "save gdb-index -dwarf-5".  */
+#define DEBUG_NAMES_SUFFIX ".debug_names"
+#define DEBUG_STR_SUFFIX ".debug_str"
+
 /* Try to locate the sections we need for DWARF 2 debugging
    information and return true if we have enough to do something.
    NAMES points to the dwarf2 section names, or is NULL if the standard
@@ -2192,6 +2270,16 @@ dwarf2_locate_sections (bfd *abfd, asection *sectp, void *vnames)
       dwarf2_per_objfile->gdb_index.s.asection = sectp;
       dwarf2_per_objfile->gdb_index.size = bfd_get_section_size (sectp);
     }
+  else if (section_is_p (sectp->name, &names->debug_names))
+    {
+      dwarf2_per_objfile->debug_names.s.asection = sectp;
+      dwarf2_per_objfile->debug_names.size = bfd_get_section_size (sectp);
+    }
+  else if (section_is_p (sectp->name, &names->debug_aranges))
+    {
+      dwarf2_per_objfile->debug_aranges.s.asection = sectp;
+      dwarf2_per_objfile->debug_aranges.size = bfd_get_section_size (sectp);
+    }
 
   if ((bfd_get_section_flags (abfd, sectp) & SEC_LOAD)
       && bfd_section_vma (abfd, sectp) == 0)
@@ -2673,6 +2761,38 @@ dw2_instantiate_symtab (struct dwarf2_per_cu_data *per_cu)
   return per_cu->v.quick->symtab;
 }
 
+/* Ensure that the symbols for each CU in PER_CUS have been read in.
+   This is like calling dw2_instantiate_symtab on each of them, except
+   that the cache of loaded CUs is only flushed once the whole vector
+   has been processed.  CUs referenced by several of PER_CUS, like
+   partial units or the targets of DW_FORM_ref_addr, are then only read
+   once, subject to the usual aging of the cache.  */
+
+static void
+dw2_instantiate_symtabs (VEC (dwarf2_per_cu_ptr) *per_cus)
+{
+  struct dwarf2_per_cu_data *per_cu;
+  struct cleanup *back_to;
+  int ix;
+
+  gdb_assert (dwarf2_per_objfile->using_index);
+
+  if (VEC_empty (dwarf2_per_cu_ptr, per_cus))
+    return;
+
+  back_to = make_cleanup (free_cached_comp_units, NULL);
+  increment_reading_symtab ();
+
+  for (ix = 0; VEC_iterate (dwarf2_per_cu_ptr, per_cus, ix, per_cu); ++ix)
+    {
+      if (!per_cu->v.quick->symtab)
+	dw2_do_instantiate_symtab (per_cu);
+    }
+
+  process_cu_includes ();
+  do_cleanups (back_to);
+}
+
 /* Return the CU given its index.
 
    This is intended for loops like:
@@ -2992,44 +3112,37 @@ find_slot_in_mapped_hash (struct mapped_index *index, const char *name,
     }
 }
 
-/* A helper function that reads the .gdb_index from SECTION and fills
-   in MAP.  FILENAME is the name of the file containing the section;
-   it is used for error reporting.  DEPRECATED_OK is nonzero if it is
-   ok to use deprecated sections.
+/* A helper function that reads the index contents found in the SIZE
+   bytes at ADDR and fills in MAP.  FILENAME is the name of the file
+   containing the index; it is used for error reporting.  DEPRECATED_OK
+   is nonzero if it is ok to use deprecated indices.
 
    CU_LIST, CU_LIST_ELEMENTS, TYPES_LIST, and TYPES_LIST_ELEMENTS are
    out parameters that are filled in with information about the CU and
-   TU lists in the section.
+   TU lists in the index.
 
    Returns 1 if all went well, 0 otherwise.  */
 
 static int
-read_index_from_section (struct objfile *objfile,
-			 const char *filename,
-			 int deprecated_ok,
-			 struct dwarf2_section_info *section,
-			 struct mapped_index *map,
-			 const gdb_byte **cu_list,
-			 offset_type *cu_list_elements,
-			 const gdb_byte **types_list,
-			 offset_type *types_list_elements)
+read_index_from_buffer (struct objfile *objfile,
+			const char *filename,
+			int deprecated_ok,
+			const gdb_byte *addr,
+			bfd_size_type size,
+			struct mapped_index *map,
+			const gdb_byte **cu_list,
+			offset_type *cu_list_elements,
+			const gdb_byte **types_list,
+			offset_type *types_list_elements)
 {
-  const gdb_byte *addr;
   offset_type version;
   offset_type *metadata;
+  offset_type prev_offset;
   int i;
 
-  if (dwarf2_section_empty_p (section))
-    return 0;
-
-  /* Older elfutils strip versions could keep the section in the main
-     executable while splitting it for the separate debug info file.  */
-  if ((get_section_flags (section) & SEC_HAS_CONTENTS) == 0)
+  if (size < sizeof (offset_type))
     return 0;
 
-  dwarf2_read_section (objfile, section);
-
-  addr = section->buffer;
   /* Version check.  */
   version = MAYBE_SWAP (*(offset_type *) addr);
   /* Versions earlier than 3 emitted every copy of a psymbol.  This
@@ -3082,8 +3195,23 @@ to use the section anyway."),
   if (version > 8)
     return 0;
 
+  /* The version is followed by the offsets of the five tables.  Make
+     sure they are there, in order and inside the buffer, so that a
+     truncated index cannot make us read past its end.  */
+  if (size < 6 * sizeof (offset_type))
+    return 0;
+  prev_offset = 6 * sizeof (offset_type);
+  for (i = 1; i < 6; ++i)
+    {
+      offset_type offset = MAYBE_SWAP (((offset_type *) addr)[i]);
+
+      if (offset < prev_offset || offset > size)
+	return 0;
+      prev_offset = offset;
+    }
+
   map->version = version;
-  map->total_size = section->size;
+  map->total_size = size;
 
   metadata = (offset_type *) (addr + sizeof (offset_type));
 
@@ -3115,6 +3243,197 @@ to use the section anyway."),
   return 1;
 }
 
+/* A helper function that reads the .gdb_index from SECTION and fills
+   in MAP.  The other arguments are as for read_index_from_buffer.  */
+
+static int
+read_index_from_section (struct objfile *objfile,
+			 const char *filename,
+			 int deprecated_ok,
+			 struct dwarf2_section_info *section,
+			 struct mapped_index *map,
+			 const gdb_byte **cu_list,
+			 offset_type *cu_list_elements,
+			 const gdb_byte **types_list,
+			 offset_type *types_list_elements)
+{
+  if (dwarf2_section_empty_p (section))
+    return 0;
+
+  /* Older elfutils strip versions could keep the section in the main
+     executable while splitting it for the separate debug info file.  */
+  if ((get_section_flags (section) & SEC_HAS_CONTENTS) == 0)
+    return 0;
+
+  dwarf2_read_section (objfile, section);
+
+  return read_index_from_buffer (objfile, filename, deprecated_ok,
+				 section->buffer, section->size, map,
+				 cu_list, cu_list_elements,
+				 types_list, types_list_elements);
+}
+
+
+/* Return the name of the index cache file for OBJFILE, or NULL if
+   OBJFILE has no build-id.  The result is allocated with xmalloc.
+
+   A separate debug file has the same build-id as the objfile it
+   belongs to, and both can carry DWARF, so the build-id alone is not
+   enough: the name also says whether OBJFILE is a separate debug file,
+   and includes the size of its file.  */
+
+static char *
+index_cache_file_name (struct objfile *objfile)
+{
+  const struct elf_build_id *build_id = build_id_bfd_get (objfile->obfd);
+  char *hex, *result;
+  size_t i;
+
+  if (build_id == NULL || build_id->size == 0)
+    return NULL;
+
+  hex = xmalloc (2 * build_id->size + 1);
+  for (i = 0; i < build_id->size; ++i)
+    xsnprintf (&hex[2 * i], 3, "%02x", build_id->data[i]);
+
+  result = concat (index_cache_directory, SLASH_STRING, hex,
+		   (objfile->separate_debug_objfile_backlink != NULL
+		    ? "-debug-" : "-"),
+		   phex_nz (bfd_get_size (objfile->obfd), 8),
+		   INDEX_SUFFIX, (char *) NULL);
+  xfree (hex);
+  return result;
+}
+
+/* Try to find an index for OBJFILE in the index cache.  If one is
+   found, keep its contents alive in dwarf2_per_objfile and fill in MAP
+   and the CU and TU list out parameters as read_index_from_section
+   does.  Return 1 if all went well, 0 otherwise.  */
+
+static int
+read_index_from_cache (struct objfile *objfile,
+		       struct mapped_index *map,
+		       const gdb_byte **cu_list,
+		       offset_type *cu_list_elements,
+		       const gdb_byte **types_list,
+		       offset_type *types_list_elements)
+{
+  char *filename;
+  struct cleanup *cleanup;
+  struct stat st;
+  gdb_byte *contents = NULL;
+  int mapped = 0;
+  offset_type i;
+  int fd;
+
+  if (!index_cache_enabled || index_cache_directory == NULL)
+    return 0;
+
+  /* The cached index does not describe the contents of a .dwz file.  */
+  if (dwarf2_get_dwz_file () != NULL)
+    return 0;
+
+  filename = index_cache_file_name (objfile);
+  if (filename == NULL)
+    return 0;
+  cleanup = make_cleanup (xfree, filename);
+
+  fd = gdb_open_cloexec (filename, O_RDONLY | O_BINARY, 0);
+  if (fd < 0)
+    {
+      if (dwarf2_read_debug)
+	fprintf_unfiltered (gdb_stdlog, "index-cache: no index for %s\n",
+			    objfile_name (objfile));
+      do_cleanups (cleanup);
+      return 0;
+    }
+
+  if (fstat (fd, &st) < 0 || st.st_size == 0)
+    {
+      close (fd);
+      do_cleanups (cleanup);
+      return 0;
+    }
+
+#ifdef HAVE_MMAP
+  contents = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (contents == MAP_FAILED)
+    contents = NULL;
+  else
+    mapped = 1;
+#endif
+  if (contents == NULL)
+    {
+      ssize_t done = 0;
+
+      contents = xmalloc (st.st_size);
+      while (done < st.st_size)
+	{
+	  ssize_t n = read (fd, contents + done, st.st_size - done);
+
+	  if (n <= 0)
+	    break;
+	  done += n;
+	}
+      if (done != st.st_size)
+	{
+	  xfree (contents);
+	  close (fd);
+	  do_cleanups (cleanup);
+	  return 0;
+	}
+    }
+  close (fd);
+
+  /* The index was written by us, so it is never deprecated.  */
+  if (!read_index_from_buffer (objfile, filename, 0, contents, st.st_size,
+			       map, cu_list, cu_list_elements,
+			       types_list, types_list_elements))
+    goto fail;
+
+  /* The build-id matched, but make sure the CU list at least fits the
+     .debug_info section before trusting the rest of the index.  */
+  for (i = 0; i + 1 < *cu_list_elements; i += 2)
+    {
+      ULONGEST offset, length;
+
+      offset = extract_unsigned_integer (*cu_list + 8 * i, 8,
+					 BFD_ENDIAN_LITTLE);
+      length = extract_unsigned_integer (*cu_list + 8 * (i + 1), 8,
+					 BFD_ENDIAN_LITTLE);
+      if (offset > dwarf2_per_objfile->info.size
+	  || length > dwarf2_per_objfile->info.size - offset)
+	goto fail;
+    }
+
+  if (dwarf2_read_debug)
+    fprintf_unfiltered (gdb_stdlog, "index-cache: using %s for %s\n",
+			filename, objfile_name (objfile));
+
+  dwarf2_per_objfile->index_cache_contents = contents;
+  dwarf2_per_objfile->index_cache_size = st.st_size;
+  dwarf2_per_objfile->index_cache_mapped = mapped;
+  do_cleanups (cleanup);
+  return 1;
+
+ fail:
+  warning (_("Ignoring invalid index cache file %s."), filename);
+#ifdef HAVE_MMAP
+  if (mapped)
+    munmap (contents, st.st_size);
+  else
+#endif
+    xfree (contents);
+  do_cleanups (cleanup);
+  return 0;
+}
+
+static int read_index_from_debug_names (struct objfile *objfile,
+					struct mapped_index *map,
+					const gdb_byte **cu_list,
+					offset_type *cu_list_elements,
+					const gdb_byte **types_list,
+					offset_type *types_list_elements);
 
 /* Read the index file.  If everything went ok, initialize the "quick"
    elements of all the CUs and return 1.  Otherwise, return 0.  */
@@ -3131,7 +3450,13 @@ dwarf2_read_index (struct objfile *objfile)
 				use_deprecated_index_sections,
 				&dwarf2_per_objfile->gdb_index, &local_map,
 				&cu_list, &cu_list_elements,
-				&types_list, &types_list_elements))
+				&types_list, &types_list_elements)
+      && !read_index_from_debug_names (objfile, &local_map,
+				       &cu_list, &cu_list_elements,
+				       &types_list, &types_list_elements)
+      && !read_index_from_cache (objfile, &local_map,
+				 &cu_list, &cu_list_elements,
+				 &types_list, &types_list_elements))
     return 0;
 
   /* Don't use the index if it's empty.  */
@@ -3690,8 +4015,10 @@ dw2_dump (struct objfile *objfile)
   printf_filtered (".gdb_index:");
   if (dwarf2_per_objfile->index_table != NULL)
     {
-      printf_filtered (" version %d\n",
-		       dwarf2_per_objfile->index_table->version);
+      printf_filtered (" version %d%s\n",
+		       dwarf2_per_objfile->index_table->version,
+		       (dwarf2_per_objfile->index_from_debug_names
+			? " (built from .debug_names)" : ""));
     }
   else
     printf_filtered (" faked for \"readnow\"\n");
@@ -3734,27 +4061,33 @@ dw2_expand_symtabs_for_function (struct objfile *objfile,
 static void
 dw2_expand_all_symtabs (struct objfile *objfile)
 {
+  VEC (dwarf2_per_cu_ptr) *per_cus = NULL;
+  struct cleanup *cleanup;
   int i;
 
   dw2_setup (objfile);
 
+  cleanup = make_cleanup (VEC_cleanup (dwarf2_per_cu_ptr), &per_cus);
   for (i = 0; i < (dwarf2_per_objfile->n_comp_units
 		   + dwarf2_per_objfile->n_type_units); ++i)
-    {
-      struct dwarf2_per_cu_data *per_cu = dw2_get_cu (i);
+    VEC_safe_push (dwarf2_per_cu_ptr, per_cus, dw2_get_cu (i));
 
-      dw2_instantiate_symtab (per_cu);
-    }
+  dw2_instantiate_symtabs (per_cus);
+  do_cleanups (cleanup);
 }
 
 static void
 dw2_expand_symtabs_with_fullname (struct objfile *objfile,
 				  const char *fullname)
 {
+  VEC (dwarf2_per_cu_ptr) *per_cus = NULL;
+  struct cleanup *cleanup;
   int i;
 
   dw2_setup (objfile);
 
+  cleanup = make_cleanup (VEC_cleanup (dwarf2_per_cu_ptr), &per_cus);
+
   /* We don't need to consider type units here.
      This is only called for examining code, e.g. expand_line_sal.
      There can be an order of magnitude (or more) more type units
@@ -3780,11 +4113,14 @@ dw2_expand_symtabs_with_fullname (struct objfile *objfile,
 
 	  if (filename_cmp (this_fullname, fullname) == 0)
 	    {
-	      dw2_instantiate_symtab (per_cu);
+	      VEC_safe_push (dwarf2_per_cu_ptr, per_cus, per_cu);
 	      break;
 	    }
 	}
     }
+
+  dw2_instantiate_symtabs (per_cus);
+  do_cleanups (cleanup);
 }
 
 static void
@@ -3812,6 +4148,10 @@ dw2_expand_symtabs_matching
   int i;
   offset_type iter;
   struct mapped_index *index;
+  VEC (dwarf2_per_cu_ptr) *per_cus = NULL;
+  unsigned char *to_expand;
+  struct cleanup *back_to;
+  int n_units;
 
   dw2_setup (objfile);
 
@@ -3820,6 +4160,16 @@ dw2_expand_symtabs_matching
     return;
   index = dwarf2_per_objfile->index_table;
 
+  /* The matching CUs are only recorded while walking the symbol table,
+     and are expanded together at the end, in section order.  A CU
+     matching many names is thus only considered once, and the CUs it
+     shares with the others are not read in again for each of them.  */
+  n_units = (dwarf2_per_objfile->n_comp_units
+	     + dwarf2_per_objfile->n_type_units);
+  to_expand = xcalloc (n_units, 1);
+  back_to = make_cleanup (xfree, to_expand);
+  make_cleanup (VEC_cleanup (dwarf2_per_cu_ptr), &per_cus);
+
   if (file_matcher != NULL)
     {
       struct cleanup *cleanup;
@@ -3977,9 +4327,18 @@ dw2_expand_symtabs_matching
 
 	  per_cu = dw2_get_cu (cu_index);
 	  if (file_matcher == NULL || per_cu->v.quick->mark)
-	    dw2_instantiate_symtab (per_cu);
+	    to_expand[cu_index] = 1;
 	}
     }
+
+  for (i = 0; i < n_units; ++i)
+    {
+      if (to_expand[i])
+	VEC_safe_push (dwarf2_per_cu_ptr, per_cus, dw2_get_cu (i));
+    }
+
+  dw2_instantiate_symtabs (per_cus);
+  do_cleanups (back_to);
 }
 
 /* A helper for dw2_find_pc_sect_symtab which finds the most specific
@@ -4196,6 +4555,8 @@ dwarf2_build_psymtabs (struct objfile *objfile)
     }
   if (except.reason < 0)
     exception_print (gdb_stderr, except);
+  else
+    index_cache_store (objfile);
 }
 
 /* Return the total length of the CU described by HEADER.  */
@@ -6703,6 +7064,29 @@ partial_die_full_name (struct partial_die_info *pdi,
     return typename_concat (NULL, parent_scope, pdi->name, 0, cu);
 }
 
+/* Add a partial symbol for PDI, from compilation unit CU, to LIST; or,
+   if a .debug_names index is being written for CU, record an index
+   entry for PDI instead.  The other arguments are as for
+   add_psymbol_to_list.  */
+
+static void
+add_partial_die_psymbol (struct partial_die_info *pdi, struct dwarf2_cu *cu,
+			 const char *actual_name, int copy_name,
+			 domain_enum domain, enum address_class aclass,
+			 struct psymbol_allocation_list *list,
+			 CORE_ADDR coreaddr)
+{
+  struct objfile *objfile = cu->objfile;
+
+  if (cu->debug_names_entries != NULL)
+    debug_names_record_entry (cu, pdi, actual_name,
+			      list == &objfile->static_psymbols);
+  else
+    add_psymbol_to_list (actual_name, strlen (actual_name), copy_name,
+			 domain, aclass, list, 0, coreaddr, cu->language,
+			 objfile);
+}
+
 static void
 add_partial_symbol (struct partial_die_info *pdi, struct dwarf2_cu *cu)
 {
@@ -6732,23 +7116,19 @@ add_partial_symbol (struct partial_die_info *pdi, struct dwarf2_cu *cu)
              in the global scope.  */
 	  /* prim_record_minimal_symbol (actual_name, pdi->lowpc + baseaddr,
 	     mst_text, objfile); */
-	  add_psymbol_to_list (actual_name, strlen (actual_name),
-			       built_actual_name != NULL,
-			       VAR_DOMAIN, LOC_BLOCK,
-			       &objfile->global_psymbols,
-			       0, pdi->lowpc + baseaddr,
-			       cu->language, objfile);
+	  add_partial_die_psymbol (pdi, cu, actual_name,
+				   built_actual_name != NULL, VAR_DOMAIN,
+				   LOC_BLOCK, &objfile->global_psymbols,
+				   pdi->lowpc + baseaddr);
 	}
       else
 	{
 	  /* prim_record_minimal_symbol (actual_name, pdi->lowpc + baseaddr,
 	     mst_file_text, objfile); */
-	  add_psymbol_to_list (actual_name, strlen (actual_name),
-			       built_actual_name != NULL,
-			       VAR_DOMAIN, LOC_BLOCK,
-			       &objfile->static_psymbols,
-			       0, pdi->lowpc + baseaddr,
-			       cu->language, objfile);
+	  add_partial_die_psymbol (pdi, cu, actual_name,
+				   built_actual_name != NULL, VAR_DOMAIN,
+				   LOC_BLOCK, &objfile->static_psymbols,
+				   pdi->lowpc + baseaddr);
 	}
       break;
     case DW_TAG_constant:
@@ -6759,9 +7139,9 @@ add_partial_symbol (struct partial_die_info *pdi, struct dwarf2_cu *cu)
 	  list = &objfile->global_psymbols;
 	else
 	  list = &objfile->static_psymbols;
-	add_psymbol_to_list (actual_name, strlen (actual_name),
-			     built_actual_name != NULL, VAR_DOMAIN, LOC_STATIC,
-			     list, 0, 0, cu->language, objfile);
+	add_partial_die_psymbol (pdi, cu, actual_name,
+				 built_actual_name != NULL, VAR_DOMAIN,
+				 LOC_STATIC, list, 0);
       }
       break;
     case DW_TAG_variable:
@@ -6793,12 +7173,10 @@ add_partial_symbol (struct partial_die_info *pdi, struct dwarf2_cu *cu)
 	     table building.  */
 
 	  if (pdi->d.locdesc || pdi->has_type)
-	    add_psymbol_to_list (actual_name, strlen (actual_name),
-				 built_actual_name != NULL,
-				 VAR_DOMAIN, LOC_STATIC,
-				 &objfile->global_psymbols,
-				 0, addr + baseaddr,
-				 cu->language, objfile);
+	    add_partial_die_psymbol (pdi, cu, actual_name,
+				     built_actual_name != NULL, VAR_DOMAIN,
+				     LOC_STATIC, &objfile->global_psymbols,
+				     addr + baseaddr);
 	}
       else
 	{
@@ -6810,37 +7188,29 @@ add_partial_symbol (struct partial_die_info *pdi, struct dwarf2_cu *cu)
 	    }
 	  /* prim_record_minimal_symbol (actual_name, addr + baseaddr,
 	     mst_file_data, objfile); */
-	  add_psymbol_to_list (actual_name, strlen (actual_name),
-			       built_actual_name != NULL,
-			       VAR_DOMAIN, LOC_STATIC,
-			       &objfile->static_psymbols,
-			       0, addr + baseaddr,
-			       cu->language, objfile);
+	  add_partial_die_psymbol (pdi, cu, actual_name,
+				   built_actual_name != NULL, VAR_DOMAIN,
+				   LOC_STATIC, &objfile->static_psymbols,
+				   addr + baseaddr);
 	}
       break;
     case DW_TAG_typedef:
     case DW_TAG_base_type:
     case DW_TAG_subrange_type:
-      add_psymbol_to_list (actual_name, strlen (actual_name),
-			   built_actual_name != NULL,
-			   VAR_DOMAIN, LOC_TYPEDEF,
-			   &objfile->static_psymbols,
-			   0, (CORE_ADDR) 0, cu->language, objfile);
+      add_partial_die_psymbol (pdi, cu, actual_name, built_actual_name != NULL,
+			       VAR_DOMAIN, LOC_TYPEDEF,
+			       &objfile->static_psymbols, (CORE_ADDR) 0);
       break;
     case DW_TAG_imported_declaration:
     case DW_TAG_namespace:
-      add_psymbol_to_list (actual_name, strlen (actual_name),
-			   built_actual_name != NULL,
-			   VAR_DOMAIN, LOC_TYPEDEF,
-			   &objfile->global_psymbols,
-			   0, (CORE_ADDR) 0, cu->language, objfile);
+      add_partial_die_psymbol (pdi, cu, actual_name, built_actual_name != NULL,
+			       VAR_DOMAIN, LOC_TYPEDEF,
+			       &objfile->global_psymbols, (CORE_ADDR) 0);
       break;
     case DW_TAG_module:
-      add_psymbol_to_list (actual_name, strlen (actual_name),
-			   built_actual_name != NULL,
-			   MODULE_DOMAIN, LOC_TYPEDEF,
-			   &objfile->global_psymbols,
-			   0, (CORE_ADDR) 0, cu->language, objfile);
+      add_partial_die_psymbol (pdi, cu, actual_name, built_actual_name != NULL,
+			       MODULE_DOMAIN, LOC_TYPEDEF,
+			       &objfile->global_psymbols, (CORE_ADDR) 0);
       break;
     case DW_TAG_class_type:
     case DW_TAG_interface_type:
@@ -6860,25 +7230,23 @@ add_partial_symbol (struct partial_die_info *pdi, struct dwarf2_cu *cu)
 
       /* NOTE: carlton/2003-10-07: See comment in new_symbol about
 	 static vs. global.  */
-      add_psymbol_to_list (actual_name, strlen (actual_name),
-			   built_actual_name != NULL,
-			   STRUCT_DOMAIN, LOC_TYPEDEF,
-			   (cu->language == language_cplus
-			    || cu->language == language_java)
-			   ? &objfile->global_psymbols
-			   : &objfile->static_psymbols,
-			   0, (CORE_ADDR) 0, cu->language, objfile);
+      add_partial_die_psymbol (pdi, cu, actual_name, built_actual_name != NULL,
+			       STRUCT_DOMAIN, LOC_TYPEDEF,
+			       (cu->language == language_cplus
+				|| cu->language == language_java)
+			       ? &objfile->global_psymbols
+			       : &objfile->static_psymbols,
+			       (CORE_ADDR) 0);
 
       break;
     case DW_TAG_enumerator:
-      add_psymbol_to_list (actual_name, strlen (actual_name),
-			   built_actual_name != NULL,
-			   VAR_DOMAIN, LOC_CONST,
-			   (cu->language == language_cplus
-			    || cu->language == language_java)
-			   ? &objfile->global_psymbols
-			   : &objfile->static_psymbols,
-			   0, (CORE_ADDR) 0, cu->language, objfile);
+      add_partial_die_psymbol (pdi, cu, actual_name, built_actual_name != NULL,
+			       VAR_DOMAIN, LOC_CONST,
+			       (cu->language == language_cplus
+				|| cu->language == language_java)
+			       ? &objfile->global_psymbols
+			       : &objfile->static_psymbols,
+			       (CORE_ADDR) 0);
       break;
     default:
       break;
@@ -14912,6 +15280,13 @@ abbrev_table_lookup_abbrev (const struct abbrev_table *abbrev_table,
   unsigned int hash_number;
   struct abbrev_info *abbrev;
 
+  if (abbrev_table->abbrevs_by_number != NULL)
+    {
+      if (abbrev_number < abbrev_table->num_abbrevs_by_number)
+	return abbrev_table->abbrevs_by_number[abbrev_number];
+      return NULL;
+    }
+
   hash_number = abbrev_number % ABBREV_HASH_SIZE;
   abbrev = abbrev_table->abbrevs[hash_number];
 
@@ -14939,8 +15314,11 @@ abbrev_table_read_table (struct dwarf2_section_info *section,
   unsigned int abbrev_form;
   struct attr_abbrev *cur_attrs;
   unsigned int allocated_attrs;
+  unsigned int num_abbrevs = 0, max_abbrev_number = 0;
+  int i;
 
-  abbrev_table = XNEW (struct abbrev_table);
+  abbrev_table = XCNEW (struct abbrev_table);
+  abbrev_table->section = section;
   abbrev_table->offset = offset;
   obstack_init (&abbrev_table->abbrev_obstack);
   abbrev_table->abbrevs = obstack_alloc (&abbrev_table->abbrev_obstack,
@@ -14999,6 +15377,9 @@ abbrev_table_read_table (struct dwarf2_section_info *section,
 	      cur_abbrev->num_attrs * sizeof (struct attr_abbrev));
 
       abbrev_table_add_abbrev (abbrev_table, abbrev_number, cur_abbrev);
+      ++num_abbrevs;
+      if (abbrev_number > max_abbrev_number)
+	max_abbrev_number = abbrev_number;
 
       /* Get next abbreviation.
          Under Irix6 the abbreviations for a compilation unit are not
@@ -15016,6 +15397,33 @@ abbrev_table_read_table (struct dwarf2_section_info *section,
     }
 
   xfree (cur_attrs);
+
+  /* Index the abbrevs by number as well, unless the numbers are too
+     sparse for this to be worth the memory.  */
+  if (max_abbrev_number < 2 * num_abbrevs + ABBREV_HASH_SIZE)
+    {
+      struct abbrev_info **by_number;
+
+      by_number = obstack_alloc (&abbrev_table->abbrev_obstack,
+				 ((max_abbrev_number + 1)
+				  * sizeof (struct abbrev_info *)));
+      memset (by_number, 0,
+	      (max_abbrev_number + 1) * sizeof (struct abbrev_info *));
+      for (i = 0; i < ABBREV_HASH_SIZE; ++i)
+	for (cur_abbrev = abbrev_table->abbrevs[i];
+	     cur_abbrev != NULL;
+	     cur_abbrev = cur_abbrev->next)
+	  {
+	    /* Keep the first definition of a number, like the hash
+	       table lookup does.  */
+	    if (by_number[cur_abbrev->number] == NULL)
+	      by_number[cur_abbrev->number] = cur_abbrev;
+	  }
+
+      abbrev_table->abbrevs_by_number = by_number;
+      abbrev_table->num_abbrevs_by_number = max_abbrev_number + 1;
+    }
+
   return abbrev_table;
 }
 
@@ -15043,6 +15451,95 @@ abbrev_table_free_cleanup (void *table_ptr)
   *abbrev_table_ptr = NULL;
 }
 
+/* Return the abbrev table at OFFSET in SECTION, reading it if it is
+   not in dwarf2_per_objfile->abbrev_cache.  Many CUs, and type units
+   in particular, share their abbrev table, so the tables are kept
+   around after use.  Only ABBREV_CACHE_SIZE tables that are not in
+   use are kept; the others are freed, least recently used first.
+   The caller must release the table with abbrev_cache_release.  */
+
+static struct abbrev_table *
+abbrev_cache_get (struct dwarf2_section_info *section, sect_offset offset)
+{
+  struct abbrev_table *table = NULL, *iter;
+  int ix, unused;
+
+  for (ix = 0;
+       VEC_iterate (abbrev_table_ptr, dwarf2_per_objfile->abbrev_cache,
+		    ix, iter);
+       ++ix)
+    {
+      if (iter->section == section
+	  && iter->offset.sect_off == offset.sect_off)
+	{
+	  table = iter;
+	  VEC_ordered_remove (abbrev_table_ptr,
+			      dwarf2_per_objfile->abbrev_cache, ix);
+	  break;
+	}
+    }
+
+  if (table == NULL)
+    {
+      table = abbrev_table_read_table (section, offset);
+      table->cached = 1;
+    }
+
+  VEC_safe_insert (abbrev_table_ptr, dwarf2_per_objfile->abbrev_cache,
+		   0, table);
+  ++table->users;
+
+  /* Trim the cache, freeing the least recently used tables that are
+     not in use.  Tables still in use are not counted.  */
+  unused = 0;
+  for (ix = 0;
+       VEC_iterate (abbrev_table_ptr, dwarf2_per_objfile->abbrev_cache,
+		    ix, iter);
+       ++ix)
+    if (iter->users == 0)
+      ++unused;
+
+  ix = VEC_length (abbrev_table_ptr, dwarf2_per_objfile->abbrev_cache);
+  while (--ix >= 0 && unused > ABBREV_CACHE_SIZE)
+    {
+      iter = VEC_index (abbrev_table_ptr, dwarf2_per_objfile->abbrev_cache,
+			ix);
+      if (iter->users == 0)
+	{
+	  VEC_ordered_remove (abbrev_table_ptr,
+			      dwarf2_per_objfile->abbrev_cache, ix);
+	  abbrev_table_free (iter);
+	  --unused;
+	}
+    }
+
+  return table;
+}
+
+/* Release TABLE, which was returned by abbrev_cache_get.  */
+
+static void
+abbrev_cache_release (struct abbrev_table *table)
+{
+  gdb_assert (table->cached && table->users > 0);
+  --table->users;
+}
+
+/* Free all the abbrev tables in the cache of PER_OBJFILE.  */
+
+static void
+abbrev_cache_free (struct dwarf2_per_objfile *per_objfile)
+{
+  struct abbrev_table *table;
+  int ix;
+
+  for (ix = 0;
+       VEC_iterate (abbrev_table_ptr, per_objfile->abbrev_cache, ix, table);
+       ++ix)
+    abbrev_table_free (table);
+  VEC_free (abbrev_table_ptr, per_objfile->abbrev_cache);
+}
+
 /* Read the abbrev table for CU from ABBREV_SECTION.  */
 
 static void
@@ -15050,10 +15547,10 @@ dwarf2_read_abbrevs (struct dwarf2_cu *cu,
 		     struct dwarf2_section_info *abbrev_section)
 {
   cu->abbrev_table =
-    abbrev_table_read_table (abbrev_section, cu->header.abbrev_offset);
+    abbrev_cache_get (abbrev_section, cu->header.abbrev_offset);
 }
 
-/* Release the memory used by the abbrev table for a compilation unit.  */
+/* Release the abbrev table for a compilation unit.  */
 
 static void
 dwarf2_free_abbrev_table (void *ptr_to_cu)
@@ -15061,7 +15558,12 @@ dwarf2_free_abbrev_table (void *ptr_to_cu)
   struct dwarf2_cu *cu = ptr_to_cu;
 
   if (cu->abbrev_table != NULL)
-    abbrev_table_free (cu->abbrev_table);
+    {
+      if (cu->abbrev_table->cached)
+	abbrev_cache_release (cu->abbrev_table);
+      else
+	abbrev_table_free (cu->abbrev_table);
+    }
   /* Set this to NULL so that we SEGV if we try to read it later,
      and also because free_comp_unit verifies this is NULL.  */
   cu->abbrev_table = NULL;
@@ -15233,10 +15735,9 @@ load_partial_dies (const struct die_reader_specs *reader,
 	      || part_die->tag == DW_TAG_subrange_type))
 	{
 	  if (building_psymtab && part_die->name != NULL)
-	    add_psymbol_to_list (part_die->name, strlen (part_die->name), 0,
-				 VAR_DOMAIN, LOC_TYPEDEF,
-				 &objfile->static_psymbols,
-				 0, (CORE_ADDR) 0, cu->language, objfile);
+	    add_partial_die_psymbol (part_die, cu, part_die->name, 0,
+				     VAR_DOMAIN, LOC_TYPEDEF,
+				     &objfile->static_psymbols, (CORE_ADDR) 0);
 	  info_ptr = locate_pdi_sibling (reader, part_die, info_ptr);
 	  continue;
 	}
@@ -15269,13 +15770,18 @@ load_partial_dies (const struct die_reader_specs *reader,
 	    complaint (&symfile_complaints,
 		       _("malformed enumerator DIE ignored"));
 	  else if (building_psymtab)
-	    add_psymbol_to_list (part_die->name, strlen (part_die->name), 0,
-				 VAR_DOMAIN, LOC_CONST,
-				 (cu->language == language_cplus
-				  || cu->language == language_java)
-				 ? &objfile->global_psymbols
-				 : &objfile->static_psymbols,
-				 0, (CORE_ADDR) 0, cu->language, objfile);
+	    {
+	      /* PART_DIE is not saved, but add_partial_die_psymbol needs
+		 its parent.  */
+	      part_die->die_parent = parent_die;
+	      add_partial_die_psymbol (part_die, cu, part_die->name, 0,
+				       VAR_DOMAIN, LOC_CONST,
+				       (cu->language == language_cplus
+					|| cu->language == language_java)
+				       ? &objfile->global_psymbols
+				       : &objfile->static_psymbols,
+				       (CORE_ADDR) 0);
+	    }
 
 	  info_ptr = locate_pdi_sibling (reader, part_die, info_ptr);
 	  continue;
@@ -18751,26 +19257,83 @@ sibling_die (struct die_info *die)
   return die->sibling;
 }
 
-/* Get name of a die, return NULL if not found.  */
+/* An entry in the canonical_names cache.  */
 
-static const char *
-dwarf2_canonicalize_name (const char *name, struct dwarf2_cu *cu,
-			  struct obstack *obstack)
+struct canonical_name_entry
 {
-  if (name && cu->language == language_cplus)
-    {
-      char *canon_name = cp_canonicalize_string (name);
+  /* The name as found in the DWARF.  */
+  const char *name;
 
-      if (canon_name != NULL)
-	{
-	  if (strcmp (canon_name, name) != 0)
-	    name = obstack_copy0 (obstack, canon_name, strlen (canon_name));
-	  xfree (canon_name);
-	}
-    }
+  /* Its canonical form, or NULL if canonicalization leaves it
+     unchanged.  */
+  const char *canonical;
+};
 
-  return name;
-}
+/* Hash function for struct canonical_name_entry.  */
+
+static hashval_t
+hash_canonical_name_entry (const void *item)
+{
+  const struct canonical_name_entry *entry = item;
+
+  return htab_hash_string (entry->name);
+}
+
+/* Equality function for struct canonical_name_entry.  */
+
+static int
+eq_canonical_name_entry (const void *item_lhs, const void *item_rhs)
+{
+  const struct canonical_name_entry *lhs = item_lhs;
+  const struct canonical_name_entry *rhs = item_rhs;
+
+  return strcmp (lhs->name, rhs->name) == 0;
+}
+
+/* Return the canonical form of NAME, a name found in CU, if CU is a
+   C++ CU.  Any new string is allocated on OBSTACK, which must have the
+   lifetime of the objfile: the results are cached in
+   dwarf2_per_objfile->canonical_names.  */
+
+static const char *
+dwarf2_canonicalize_name (const char *name, struct dwarf2_cu *cu,
+			  struct obstack *obstack)
+{
+  if (name && cu->language == language_cplus)
+    {
+      struct canonical_name_entry entry, **slot;
+      char *canon_name;
+
+      if (dwarf2_per_objfile->canonical_names == NULL)
+	dwarf2_per_objfile->canonical_names
+	  = htab_create_alloc (1024, hash_canonical_name_entry,
+			       eq_canonical_name_entry, NULL,
+			       xcalloc, xfree);
+
+      entry.name = name;
+      slot = (struct canonical_name_entry **)
+	htab_find_slot (dwarf2_per_objfile->canonical_names, &entry, INSERT);
+      if (*slot != NULL)
+	return (*slot)->canonical != NULL ? (*slot)->canonical : name;
+
+      *slot = obstack_alloc (obstack, sizeof (struct canonical_name_entry));
+      (*slot)->name = obstack_copy0 (obstack, name, strlen (name));
+      (*slot)->canonical = NULL;
+
+      canon_name = cp_canonicalize_string (name);
+      if (canon_name != NULL)
+	{
+	  if (strcmp (canon_name, name) != 0)
+	    {
+	      name = obstack_copy0 (obstack, canon_name, strlen (canon_name));
+	      (*slot)->canonical = name;
+	    }
+	  xfree (canon_name);
+	}
+    }
+
+  return name;
+}
 
 /* Get name of a die, return NULL if not found.  */
 
@@ -21764,6 +22327,8 @@ dwarf2_per_objfile_free (struct objfile *objfile, void *d)
 
   VEC_free (dwarf2_section_info_def, data->types);
 
+  abbrev_cache_free (data);
+
   if (data->dwo_files)
     free_dwo_files (data->dwo_files, objfile);
   if (data->dwp_file)
@@ -21771,6 +22336,19 @@ dwarf2_per_objfile_free (struct objfile *objfile, void *d)
 
   if (data->dwz_file && data->dwz_file->dwz_bfd)
     gdb_bfd_unref (data->dwz_file->dwz_bfd);
+
+  if (data->canonical_names != NULL)
+    htab_delete (data->canonical_names);
+
+  if (data->index_cache_contents != NULL)
+    {
+#ifdef HAVE_MMAP
+      if (data->index_cache_mapped)
+	munmap (data->index_cache_contents, data->index_cache_size);
+      else
+#endif
+	xfree (data->index_cache_contents);
+    }
 }
 
 
@@ -22449,20 +23027,19 @@ recursively_write_psymbols (struct objfile *objfile,
 		  1);
 }
 
-/* Create an index file for OBJFILE in the directory DIR.  */
+/* Create an index file for OBJFILE named FILENAME.  */
 
 static void
-write_psymtabs_to_index (struct objfile *objfile, const char *dir)
+write_psymtabs_to_index_file (struct objfile *objfile, const char *filename)
 {
   struct cleanup *cleanup;
-  char *filename, *cleanup_filename;
+  char *cleanup_filename;
   struct obstack contents, addr_obstack, constant_pool, symtab_obstack;
   struct obstack cu_list, types_cu_list;
   int i;
   FILE *out_file;
   struct mapped_symtab *symtab;
   offset_type val, size_of_contents, total_len;
-  struct stat st;
   htab_t psyms_seen;
   htab_t cu_index_htab;
   struct psymtab_cu_index_map *psymtab_cu_index_map;
@@ -22476,19 +23053,12 @@ write_psymtabs_to_index (struct objfile *objfile, const char *dir)
   if (!objfile->psymtabs || !objfile->psymtabs_addrmap)
     return;
 
-  if (stat (objfile_name (objfile), &st) < 0)
-    perror_with_name (objfile_name (objfile));
-
-  filename = concat (dir, SLASH_STRING, lbasename (objfile_name (objfile)),
-		     INDEX_SUFFIX, (char *) NULL);
-  cleanup = make_cleanup (xfree, filename);
-
   out_file = gdb_fopen_cloexec (filename, "wb");
   if (!out_file)
     error (_("Can't open `%s' for writing"), filename);
 
-  cleanup_filename = filename;
-  make_cleanup (unlink_if_set, &cleanup_filename);
+  cleanup_filename = (char *) filename;
+  cleanup = make_cleanup (unlink_if_set, &cleanup_filename);
 
   symtab = create_mapped_symtab ();
   make_cleanup (cleanup_mapped_symtab, symtab);
@@ -22635,158 +23205,1927 @@ write_psymtabs_to_index (struct objfile *objfile, const char *dir)
   do_cleanups (cleanup);
 }
 
-/* Implementation of the `save gdb-index' command.
-   
-   Note that the file format used by this command is documented in the
-   GDB manual.  Any changes here must be documented there.  */
 
-static void
-save_gdb_index_command (char *arg, int from_tty)
-{
-  struct objfile *objfile;
+/* .debug_names support.
 
-  if (!arg || !*arg)
-    error (_("usage: save gdb-index DIRECTORY"));
+   Rather than teaching the dw2_* functions about a second index format,
+   a DWARF 5 name index is converted to an in-memory .gdb_index when it
+   is read, using the same code as "save gdb-index".  The name index has
+   no address table, so the address table is built from .debug_aranges
+   instead.  */
 
-  ALL_OBJFILES (objfile)
-  {
-    struct stat st;
+/* The DWARF 5 name index hash function.  This is the DJB hash, applied
+   after folding ASCII letters to lower case.  */
 
-    /* If the objfile does not correspond to an actual file, skip it.  */
-    if (stat (objfile_name (objfile), &st) < 0)
-      continue;
+static uint32_t
+dwarf5_djb_hash (const char *str_)
+{
+  const unsigned char *str = (const unsigned char *) str_;
+  uint32_t hash = 5381;
+  unsigned char c;
 
-    dwarf2_per_objfile = objfile_data (objfile, dwarf2_objfile_data_key);
-    if (dwarf2_per_objfile)
-      {
-	volatile struct gdb_exception except;
+  while ((c = *str++) != 0)
+    {
+      if (c < 0x80)
+	c = tolower (c);
+      hash = hash * 33 + c;
+    }
 
-	TRY_CATCH (except, RETURN_MASK_ERROR)
-	  {
-	    write_psymtabs_to_index (objfile, arg);
-	  }
-	if (except.reason < 0)
-	  exception_fprintf (gdb_stderr, except,
-			     _("Error while writing index for `%s': "),
-			     objfile_name (objfile));
-      }
-  }
+  return hash;
 }
 
-
+/* Return the symbol kind recorded in the in-memory index for a name
+   index entry with tag TAG.  */
 
-int dwarf2_always_disassemble;
+static gdb_index_symbol_kind
+debug_names_tag_kind (ULONGEST tag)
+{
+  switch (tag)
+    {
+    case DW_TAG_subprogram:
+    case DW_TAG_inlined_subroutine:
+      return GDB_INDEX_SYMBOL_KIND_FUNCTION;
+    case DW_TAG_variable:
+    case DW_TAG_constant:
+    case DW_TAG_enumerator:
+      return GDB_INDEX_SYMBOL_KIND_VARIABLE;
+    case DW_TAG_base_type:
+    case DW_TAG_class_type:
+    case DW_TAG_enumeration_type:
+    case DW_TAG_imported_declaration:
+    case DW_TAG_interface_type:
+    case DW_TAG_namespace:
+    case DW_TAG_structure_type:
+    case DW_TAG_subrange_type:
+    case DW_TAG_typedef:
+    case DW_TAG_union_type:
+    case DW_TAG_unspecified_type:
+      return GDB_INDEX_SYMBOL_KIND_TYPE;
+    default:
+      return GDB_INDEX_SYMBOL_KIND_OTHER;
+    }
+}
 
-static void
-show_dwarf2_always_disassemble (struct ui_file *file, int from_tty,
-				struct cmd_list_element *c, const char *value)
+/* An attribute specification in a .debug_names abbreviation.  */
+struct debug_names_attr
 {
-  fprintf_filtered (file,
-		    _("Whether to always disassemble "
-		      "DWARF expressions is %s.\n"),
-		    value);
+  ULONGEST idx;
+  ULONGEST form;
+};
+
+/* An abbreviation from the abbreviation table of a name index.  */
+struct debug_names_abbrev
+{
+  ULONGEST code;
+  ULONGEST tag;
+  int num_attrs;
+  struct debug_names_attr *attrs;
+};
+
+static hashval_t
+hash_debug_names_abbrev (const void *item)
+{
+  const struct debug_names_abbrev *abbrev = item;
+
+  return abbrev->code;
 }
 
-static void
-show_check_physname (struct ui_file *file, int from_tty,
-		     struct cmd_list_element *c, const char *value)
+static int
+eq_debug_names_abbrev (const void *item_lhs, const void *item_rhs)
 {
-  fprintf_filtered (file,
-		    _("Whether to check \"physname\" is %s.\n"),
-		    value);
+  const struct debug_names_abbrev *lhs = item_lhs;
+  const struct debug_names_abbrev *rhs = item_rhs;
+
+  return lhs->code == rhs->code;
 }
 
-void _initialize_dwarf2_read (void);
+/* An entry of a name index.  */
+struct debug_names_entry
+{
+  /* The offset of the entry in the entry pool.  */
+  ULONGEST offset;
 
-void
-_initialize_dwarf2_read (void)
+  /* The name of the entry, and the name qualified by the names of its
+     parents.  The latter is computed lazily.  */
+  const char *name;
+  const char *qualified_name;
+
+  ULONGEST tag;
+
+  /* Index of the CU in the table of all CUs.  */
+  offset_type cu_index;
+
+  /* 1 if the entry is known to be static, 0 if it is known to be
+     global, and -1 if the index does not say.  */
+  int is_static;
+
+  /* The entry pool offset of the parent entry, or -1 if there is
+     none.  */
+  ULONGEST parent;
+
+  struct debug_names_entry *next;
+};
+
+static hashval_t
+hash_debug_names_entry (const void *item)
 {
-  struct cmd_list_element *c;
+  const struct debug_names_entry *entry = item;
 
-  dwarf2_objfile_data_key
-    = register_objfile_data_with_cleanup (NULL, dwarf2_per_objfile_free);
+  return entry->offset;
+}
 
-  add_prefix_cmd ("dwarf2", class_maintenance, set_dwarf2_cmd, _("\
-Set DWARF 2 specific variables.\n\
-Configure DWARF 2 variables such as the cache size"),
-                  &set_dwarf2_cmdlist, "maintenance set dwarf2 ",
-                  0/*allow-unknown*/, &maintenance_set_cmdlist);
+static int
+eq_debug_names_entry (const void *item_lhs, const void *item_rhs)
+{
+  const struct debug_names_entry *lhs = item_lhs;
+  const struct debug_names_entry *rhs = item_rhs;
 
-  add_prefix_cmd ("dwarf2", class_maintenance, show_dwarf2_cmd, _("\
-Show DWARF 2 specific variables\n\
-Show DWARF 2 variables such as the cache size"),
-                  &show_dwarf2_cmdlist, "maintenance show dwarf2 ",
-                  0/*allow-unknown*/, &maintenance_show_cmdlist);
+  return lhs->offset == rhs->offset;
+}
 
-  add_setshow_zinteger_cmd ("max-cache-age", class_obscure,
-			    &dwarf2_max_cache_age, _("\
-Set the upper bound on the age of cached dwarf2 compilation units."), _("\
-Show the upper bound on the age of cached dwarf2 compilation units."), _("\
-A higher limit means that cached compilation units will be stored\n\
-in memory longer, and more total memory will be used.  Zero disables\n\
-caching, which can slow down startup."),
-			    NULL,
-			    show_dwarf2_max_cache_age,
-			    &set_dwarf2_cmdlist,
-			    &show_dwarf2_cmdlist);
+/* Return the name of ENTRY qualified by the names of its parents in
+   ENTRIES, allocating it on OBSTACK if needed.  As in GDB's own symbol
+   names, an enumerator is qualified by the scope of its enumeration
+   type rather than by the type itself.  */
 
-  add_setshow_boolean_cmd ("always-disassemble", class_obscure,
-			   &dwarf2_always_disassemble, _("\
-Set whether `info address' always disassembles DWARF expressions."), _("\
-Show whether `info address' always disassembles DWARF expressions."), _("\
-When enabled, DWARF expressions are always printed in an assembly-like\n\
-syntax.  When disabled, expressions will be printed in a more\n\
-conversational style, when possible."),
-			   NULL,
-			   show_dwarf2_always_disassemble,
-			   &set_dwarf2_cmdlist,
-			   &show_dwarf2_cmdlist);
+static const char *
+debug_names_qualified_name (htab_t entries, struct debug_names_entry *entry,
+			    struct obstack *obstack)
+{
+  struct debug_names_entry find, *parent;
 
-  add_setshow_zuinteger_cmd ("dwarf2-read", no_class, &dwarf2_read_debug, _("\
-Set debugging of the dwarf2 reader."), _("\
-Show debugging of the dwarf2 reader."), _("\
-When enabled (non-zero), debugging messages are printed during dwarf2\n\
-reading and symtab expansion.  A value of 1 (one) provides basic\n\
-information.  A value greater than 1 provides more verbose information."),
-			    NULL,
-			    NULL,
-			    &setdebuglist, &showdebuglist);
+  if (entry->qualified_name != NULL)
+    return entry->qualified_name;
 
-  add_setshow_zuinteger_cmd ("dwarf2-die", no_class, &dwarf2_die_debug, _("\
-Set debugging of the dwarf2 DIE reader."), _("\
-Show debugging of the dwarf2 DIE reader."), _("\
-When enabled (non-zero), DIEs are dumped after they are read in.\n\
-The value is the maximum depth to print."),
-			     NULL,
-			     NULL,
-			     &setdebuglist, &showdebuglist);
+  /* Set this first, so that a corrupt index with a cycle of parents
+     cannot make us recurse forever.  */
+  entry->qualified_name = entry->name;
 
-  add_setshow_boolean_cmd ("check-physname", no_class, &check_physname, _("\
-Set cross-checking of \"physname\" code against demangler."), _("\
-Show cross-checking of \"physname\" code against demangler."), _("\
-When enabled, GDB's internal \"physname\" code is checked against\n\
-the demangler."),
-			   NULL, show_check_physname,
-			   &setdebuglist, &showdebuglist);
+  if (entry->parent != (ULONGEST) -1)
+    {
+      find.offset = entry->parent;
+      parent = htab_find (entries, &find);
+      if (parent != NULL
+	  && entry->tag == DW_TAG_enumerator
+	  && parent->tag == DW_TAG_enumeration_type)
+	{
+	  find.offset = parent->parent;
+	  parent = (parent->parent != (ULONGEST) -1
+		    ? htab_find (entries, &find) : NULL);
+	}
+      if (parent != NULL)
+	entry->qualified_name
+	  = obconcat (obstack,
+		      debug_names_qualified_name (entries, parent, obstack),
+		      "::", entry->name, (char *) NULL);
+    }
 
-  add_setshow_boolean_cmd ("use-deprecated-index-sections",
-			   no_class, &use_deprecated_index_sections, _("\
-Set whether to use deprecated gdb_index sections."), _("\
-Show whether to use deprecated gdb_index sections."), _("\
-When enabled, deprecated .gdb_index sections are used anyway.\n\
-Normally they are ignored either because of a missing feature or\n\
-performance issue.\n\
-Warning: This option must be enabled before gdb reads the file."),
-			   NULL,
-			   NULL,
-			   &setlist, &showlist);
+  return entry->qualified_name;
+}
 
-  c = add_cmd ("gdb-index", class_files, save_gdb_index_command,
-	       _("\
-Save a gdb-index file.\n\
-Usage: save gdb-index DIRECTORY"),
-	       &save_cmdlist);
-  set_cmd_completer (c, filename_completer);
+/* Read a value of form FORM from a name index entry at P, which must
+   be before END, and store it in *VALUE.  OFFSET_SIZE is the offset
+   size of the name index.  Return a pointer just past the value, or
+   NULL if the form is not supported or the value is truncated.  */
+
+static const gdb_byte *
+read_debug_names_value (bfd *abfd, const gdb_byte *p, const gdb_byte *end,
+			ULONGEST form, unsigned int offset_size,
+			ULONGEST *value)
+{
+  unsigned int size;
+
+  switch (form)
+    {
+    case DW_FORM_flag_present:
+      *value = 1;
+      return p;
+    case DW_FORM_udata:
+    case DW_FORM_ref_udata:
+      {
+	uint64_t val;
+
+	p = gdb_read_uleb128 (p, end, &val);
+	*value = val;
+	return p;
+      }
+    case DW_FORM_sdata:
+      {
+	int64_t val;
+
+	p = gdb_read_sleb128 (p, end, &val);
+	*value = val;
+	return p;
+      }
+    case DW_FORM_flag:
+    case DW_FORM_data1:
+    case DW_FORM_ref1:
+      size = 1;
+      break;
+    case DW_FORM_data2:
+    case DW_FORM_ref2:
+      size = 2;
+      break;
+    case DW_FORM_data4:
+    case DW_FORM_ref4:
+      size = 4;
+      break;
+    case DW_FORM_data8:
+    case DW_FORM_ref8:
+    case DW_FORM_ref_sig8:
+      size = 8;
+      break;
+    case DW_FORM_sec_offset:
+      size = offset_size;
+      break;
+    default:
+      return NULL;
+    }
+
+  if (end - p < size)
+    return NULL;
+
+  switch (size)
+    {
+    case 1:
+      *value = read_1_byte (abfd, p);
+      break;
+    case 2:
+      *value = read_2_bytes (abfd, p);
+      break;
+    case 4:
+      *value = read_4_bytes (abfd, p);
+      break;
+    default:
+      *value = read_8_bytes (abfd, p);
+      break;
+    }
+
+  return p + size;
+}
+
+/* Return the index of the unit at OFFSET in the sorted array
+   CU_OFFSETS of N_CUS elements, or -1 if there is none.  */
+
+static int
+find_cu_offset_index (const ULONGEST *cu_offsets, int n_cus, ULONGEST offset)
+{
+  int low = 0, high = n_cus - 1;
+
+  while (low <= high)
+    {
+      int mid = low + (high - low) / 2;
+
+      if (cu_offsets[mid] == offset)
+	return mid;
+      if (cu_offsets[mid] < offset)
+	low = mid + 1;
+      else
+	high = mid - 1;
+    }
+
+  return -1;
+}
+
+/* Read the name index at P, which must end before SECTION_END, and
+   add its names to SYMTAB.  CU_OFFSETS holds the sorted .debug_info
+   offsets of the N_CUS compilation units; CU_SEEN is set for each of
+   them the name index covers.  Allocate names on OBSTACK.  Return a
+   pointer to the next name index, or NULL if this one cannot be
+   used.  */
+
+static const gdb_byte *
+read_debug_names_unit (bfd *abfd, const gdb_byte *p,
+		       const gdb_byte *section_end,
+		       const ULONGEST *cu_offsets, int n_cus,
+		       unsigned char *cu_seen,
+		       struct mapped_symtab *symtab, struct obstack *obstack)
+{
+  const struct dwarf2_section_info *str = &dwarf2_per_objfile->str;
+  const gdb_byte *unit_end, *cu_list, *str_offsets, *entry_offsets;
+  const gdb_byte *abbrev_ptr, *abbrev_end, *entry_pool;
+  struct debug_names_entry *entries = NULL, *entry;
+  unsigned int bytes_read, offset_size;
+  ULONGEST length, cu_count, local_tu_count, foreign_tu_count;
+  ULONGEST bucket_count, name_count, abbrev_table_size, augmentation_size;
+  ULONGEST i, tables_size;
+  htab_t abbrevs, entry_table;
+  struct cleanup *cleanup;
+  int *cu_map;
+  const gdb_byte *result = NULL;
+
+  if (section_end - p < 12)
+    return NULL;
+  length = read_initial_length (abfd, p, &bytes_read);
+  if (bytes_read != 4 && bytes_read != 12)
+    return NULL;
+  offset_size = bytes_read == 4 ? 4 : 8;
+  p += bytes_read;
+  if (p > section_end || length > section_end - p || length < 32)
+    return NULL;
+  unit_end = p + length;
+
+  if (read_2_bytes (abfd, p) != 5)
+    return NULL;
+  /* Skip the version and the padding.  */
+  p += 4;
+  cu_count = read_4_bytes (abfd, p);
+  local_tu_count = read_4_bytes (abfd, p + 4);
+  foreign_tu_count = read_4_bytes (abfd, p + 8);
+  bucket_count = read_4_bytes (abfd, p + 12);
+  name_count = read_4_bytes (abfd, p + 16);
+  abbrev_table_size = read_4_bytes (abfd, p + 20);
+  augmentation_size = read_4_bytes (abfd, p + 24);
+  p += 28;
+
+  /* Type units are not described by the CU list of the in-memory
+     index.  */
+  if (local_tu_count != 0 || foreign_tu_count != 0)
+    return NULL;
+
+  tables_size = (augmentation_size
+		 + cu_count * offset_size
+		 + bucket_count * 4
+		 + (bucket_count != 0 ? name_count * 4 : 0)
+		 + 2 * name_count * offset_size
+		 + abbrev_table_size);
+  if (tables_size > unit_end - p)
+    return NULL;
+
+  p += augmentation_size;
+  cu_list = p;
+  p += cu_count * offset_size;
+  p += bucket_count * 4;
+  if (bucket_count != 0)
+    p += name_count * 4;
+  str_offsets = p;
+  p += name_count * offset_size;
+  entry_offsets = p;
+  p += name_count * offset_size;
+  abbrev_ptr = p;
+  abbrev_end = p + abbrev_table_size;
+  entry_pool = abbrev_end;
+
+  /* Map the CUs of this name index to CU indices.  */
+  cu_map = XNEWVEC (int, cu_count);
+  cleanup = make_cleanup (xfree, cu_map);
+  for (i = 0; i < cu_count; ++i)
+    {
+      ULONGEST offset = read_offset_1 (abfd, cu_list + i * offset_size,
+				       offset_size);
+
+      cu_map[i] = find_cu_offset_index (cu_offsets, n_cus, offset);
+      if (cu_map[i] < 0)
+	goto done;
+      cu_seen[cu_map[i]] = 1;
+    }
+
+  /* Read the abbreviation table.  */
+  abbrevs = htab_create_alloc (20, hash_debug_names_abbrev,
+			       eq_debug_names_abbrev, NULL, xcalloc, xfree);
+  make_cleanup_htab_delete (abbrevs);
+  for (;;)
+    {
+      struct debug_names_abbrev *abbrev;
+      uint64_t code, tag, idx, form;
+      void **slot;
+
+      abbrev_ptr = gdb_read_uleb128 (abbrev_ptr, abbrev_end, &code);
+      if (abbrev_ptr == NULL)
+	goto done;
+      if (code == 0)
+	break;
+      abbrev_ptr = gdb_read_uleb128 (abbrev_ptr, abbrev_end, &tag);
+      if (abbrev_ptr == NULL)
+	goto done;
+
+      abbrev = obstack_alloc (obstack, sizeof (*abbrev));
+      abbrev->code = code;
+      abbrev->tag = tag;
+      abbrev->num_attrs = 0;
+      for (;;)
+	{
+	  struct debug_names_attr attr;
+
+	  abbrev_ptr = gdb_read_uleb128 (abbrev_ptr, abbrev_end, &idx);
+	  if (abbrev_ptr == NULL)
+	    goto done;
+	  abbrev_ptr = gdb_read_uleb128 (abbrev_ptr, abbrev_end, &form);
+	  if (abbrev_ptr == NULL)
+	    goto done;
+	  if (idx == 0 && form == 0)
+	    break;
+	  attr.idx = idx;
+	  attr.form = form;
+	  obstack_grow (obstack, &attr, sizeof (attr));
+	  ++abbrev->num_attrs;
+	}
+      abbrev->attrs = obstack_finish (obstack);
+
+      slot = htab_find_slot (abbrevs, abbrev, INSERT);
+      *slot = abbrev;
+    }
+
+  /* Read the entries of all the names.  */
+  entry_table = htab_create_alloc (name_count, hash_debug_names_entry,
+				   eq_debug_names_entry, NULL,
+				   xcalloc, xfree);
+  make_cleanup_htab_delete (entry_table);
+  for (i = 0; i < name_count; ++i)
+    {
+      ULONGEST str_offset, entry_offset;
+      const char *name;
+      const gdb_byte *q;
+
+      str_offset = read_offset_1 (abfd, str_offsets + i * offset_size,
+				  offset_size);
+      if (str_offset >= str->size
+	  || memchr (str->buffer + str_offset, '\0',
+		     str->size - str_offset) == NULL)
+	goto done;
+      name = (const char *) (str->buffer + str_offset);
+
+      entry_offset = read_offset_1 (abfd, entry_offsets + i * offset_size,
+				    offset_size);
+      if (entry_offset >= unit_end - entry_pool)
+	goto done;
+      q = entry_pool + entry_offset;
+
+      for (;;)
+	{
+	  struct debug_names_abbrev find_abbrev, *abbrev;
+	  ULONGEST offset = q - entry_pool;
+	  uint64_t code;
+	  int cu_index = cu_count == 1 ? cu_map[0] : -1;
+	  int j, is_type_unit = 0;
+	  void **slot;
+
+	  q = gdb_read_uleb128 (q, unit_end, &code);
+	  if (q == NULL)
+	    goto done;
+	  if (code == 0)
+	    break;
+
+	  find_abbrev.code = code;
+	  abbrev = htab_find (abbrevs, &find_abbrev);
+	  if (abbrev == NULL)
+	    goto done;
+
+	  entry = obstack_alloc (obstack, sizeof (*entry));
+	  entry->offset = offset;
+	  entry->name = name;
+	  entry->qualified_name = NULL;
+	  entry->tag = abbrev->tag;
+	  entry->is_static = -1;
+	  entry->parent = (ULONGEST) -1;
+
+	  for (j = 0; j < abbrev->num_attrs; ++j)
+	    {
+	      const struct debug_names_attr *attr = &abbrev->attrs[j];
+	      ULONGEST value;
+
+	      q = read_debug_names_value (abfd, q, unit_end, attr->form,
+					  offset_size, &value);
+	      if (q == NULL)
+		goto done;
+
+	      switch (attr->idx)
+		{
+		case DW_IDX_compile_unit:
+		  if (value >= cu_count)
+		    goto done;
+		  cu_index = cu_map[value];
+		  break;
+		case DW_IDX_type_unit:
+		  is_type_unit = 1;
+		  break;
+		case DW_IDX_parent:
+		  /* DW_FORM_flag_present means the entry has no parent
+		     in the index.  */
+		  if (attr->form != DW_FORM_flag_present)
+		    entry->parent = value;
+		  break;
+		case DW_IDX_GNU_internal:
+		  entry->is_static = 1;
+		  break;
+		case DW_IDX_GNU_external:
+		  entry->is_static = 0;
+		  break;
+		}
+	    }
+
+	  if (is_type_unit || cu_index < 0)
+	    continue;
+	  entry->cu_index = cu_index;
+
+	  slot = htab_find_slot (entry_table, entry, INSERT);
+	  *slot = entry;
+	  entry->next = entries;
+	  entries = entry;
+	}
+    }
+
+  for (entry = entries; entry != NULL; entry = entry->next)
+    {
+      const char *name = debug_names_qualified_name (entry_table, entry,
+						     obstack);
+      gdb_index_symbol_kind kind = debug_names_tag_kind (entry->tag);
+
+      /* If the index does not say whether the symbol is static, record
+	 it as both, so that lookups in either block find it.  */
+      if (entry->is_static != 1)
+	add_index_entry (symtab, name, 0, kind, entry->cu_index);
+      if (entry->is_static != 0)
+	add_index_entry (symtab, name, 1, kind, entry->cu_index);
+    }
+
+  result = unit_end;
+
+ done:
+  do_cleanups (cleanup);
+  return result;
+}
+
+/* Build the address table of an in-memory index in ADDR_OBSTACK from
+   the .debug_aranges section.  CU_OFFSETS and N_CUS are as for
+   read_debug_names_unit.  Return 1 if all went well, 0 otherwise.  */
+
+static int
+read_aranges_to_address_table (struct objfile *objfile,
+			       const ULONGEST *cu_offsets, int n_cus,
+			       struct obstack *addr_obstack)
+{
+  struct dwarf2_section_info *section = &dwarf2_per_objfile->debug_aranges;
+  const gdb_byte *p, *end;
+  bfd *abfd;
+
+  if (dwarf2_section_empty_p (section))
+    return 0;
+
+  dwarf2_read_section (objfile, section);
+  abfd = get_section_bfd_owner (section);
+  p = section->buffer;
+  end = section->buffer + section->size;
+
+  while (p < end)
+    {
+      const gdb_byte *unit_start = p, *unit_end;
+      unsigned int bytes_read, offset_size, address_size, tuple_size;
+      ULONGEST length, info_offset;
+      int cu_index;
+
+      if (end - p < 12)
+	return 0;
+      length = read_initial_length (abfd, p, &bytes_read);
+      if (bytes_read != 4 && bytes_read != 12)
+	return 0;
+      offset_size = bytes_read == 4 ? 4 : 8;
+      p += bytes_read;
+      if (p > end || length > end - p || length < 4 + offset_size)
+	return 0;
+      unit_end = p + length;
+
+      if (read_2_bytes (abfd, p) != 2)
+	return 0;
+      info_offset = read_offset_1 (abfd, p + 2, offset_size);
+      address_size = read_1_byte (abfd, p + 2 + offset_size);
+      /* Segmented addresses are not supported.  */
+      if (read_1_byte (abfd, p + 3 + offset_size) != 0
+	  || (address_size != 4 && address_size != 8))
+	return 0;
+      p += 4 + offset_size;
+
+      cu_index = find_cu_offset_index (cu_offsets, n_cus, info_offset);
+      if (cu_index < 0)
+	{
+	  complaint (&symfile_complaints,
+		     _(".debug_aranges entry refers to invalid CU offset %s"),
+		     hex_string (info_offset));
+	  p = unit_end;
+	  continue;
+	}
+
+      /* The tuples are aligned to twice the address size.  */
+      tuple_size = 2 * address_size;
+      p = unit_start + align_up (p - unit_start, tuple_size);
+
+      while (p <= unit_end && unit_end - p >= tuple_size)
+	{
+	  ULONGEST start, range_length;
+	  gdb_byte addr[8];
+	  offset_type val;
+
+	  if (address_size == 4)
+	    {
+	      start = read_4_bytes (abfd, p);
+	      range_length = read_4_bytes (abfd, p + 4);
+	    }
+	  else
+	    {
+	      start = read_8_bytes (abfd, p);
+	      range_length = read_8_bytes (abfd, p + 8);
+	    }
+	  p += tuple_size;
+
+	  if (start == 0 && range_length == 0)
+	    break;
+	  if (range_length == 0)
+	    continue;
+
+	  store_unsigned_integer (addr, 8, BFD_ENDIAN_LITTLE, start);
+	  obstack_grow (addr_obstack, addr, 8);
+	  store_unsigned_integer (addr, 8, BFD_ENDIAN_LITTLE,
+				  start + range_length);
+	  obstack_grow (addr_obstack, addr, 8);
+	  val = MAYBE_SWAP (cu_index);
+	  obstack_grow (addr_obstack, &val, sizeof (val));
+	}
+
+      p = unit_end;
+    }
+
+  return 1;
+}
+
+/* A cleanup that frees the entries of a mapped_symtab that has not
+   been written out by write_hash_table.  */
+
+static void
+cleanup_mapped_symtab_entries (void *p)
+{
+  struct mapped_symtab *symtab = p;
+  offset_type i;
+
+  for (i = 0; i < symtab->size; ++i)
+    if (symtab->data[i] != NULL)
+      delete_symtab_entry (symtab->data[i]);
+}
+
+/* Try to convert the .debug_names section of OBJFILE to an in-memory
+   index.  If that works, fill in MAP and the CU and TU list out
+   parameters as read_index_from_section does and return 1.  Otherwise,
+   return 0.  */
+
+static int
+read_index_from_debug_names (struct objfile *objfile,
+			     struct mapped_index *map,
+			     const gdb_byte **cu_list,
+			     offset_type *cu_list_elements,
+			     const gdb_byte **types_list,
+			     offset_type *types_list_elements)
+{
+  struct dwarf2_section_info *section = &dwarf2_per_objfile->debug_names;
+  struct dwarf2_section_info *info = &dwarf2_per_objfile->info;
+  struct obstack temp_obstack, cu_list_obstack, addr_obstack;
+  struct obstack constant_pool, symtab_obstack;
+  struct cleanup *cleanup, *entries_cleanup;
+  struct mapped_symtab *symtab;
+  const char *reason = NULL;
+  const gdb_byte *p, *end;
+  ULONGEST *cu_offsets = NULL;
+  unsigned char *cu_seen;
+  int n_cus = 0, allocated_cus = 0, i;
+  offset_type header[6], total_len;
+  gdb_byte *buffer, *dest;
+  bfd *abfd;
+
+  if (dwarf2_section_empty_p (section))
+    return 0;
+
+  if (!VEC_empty (dwarf2_section_info_def, dwarf2_per_objfile->types))
+    reason = "file has .debug_types sections";
+  else if (dwarf2_get_dwz_file () != NULL)
+    reason = "file uses a .dwz file";
+  else if (dwarf2_section_empty_p (&dwarf2_per_objfile->str))
+    reason = "file has no .debug_str section";
+  if (reason != NULL)
+    goto reject;
+
+  dwarf2_read_section (objfile, section);
+  dwarf2_read_section (objfile, info);
+  dwarf2_read_section (objfile, &dwarf2_per_objfile->str);
+  abfd = get_section_bfd_owner (section);
+
+  obstack_init (&temp_obstack);
+  cleanup = make_cleanup_obstack_free (&temp_obstack);
+  obstack_init (&cu_list_obstack);
+  make_cleanup_obstack_free (&cu_list_obstack);
+  obstack_init (&addr_obstack);
+  make_cleanup_obstack_free (&addr_obstack);
+
+  /* The name index only refers to the CUs it covers, but the
+     in-memory index needs all of them, so scan the CU headers.  */
+  p = info->buffer;
+  end = info->buffer + info->size;
+  while (p < end)
+    {
+      ULONGEST offset = p - info->buffer, length;
+      unsigned int bytes_read;
+      gdb_byte val[8];
+
+      if (end - p < 12)
+	break;
+      length = read_initial_length (abfd, p, &bytes_read);
+      if (length > end - p - bytes_read)
+	break;
+      length += bytes_read;
+
+      if (n_cus == allocated_cus)
+	{
+	  allocated_cus = allocated_cus == 0 ? 16 : 2 * allocated_cus;
+	  cu_offsets = xrealloc (cu_offsets, allocated_cus * sizeof (ULONGEST));
+	}
+      cu_offsets[n_cus++] = offset;
+
+      store_unsigned_integer (val, 8, BFD_ENDIAN_LITTLE, offset);
+      obstack_grow (&cu_list_obstack, val, 8);
+      store_unsigned_integer (val, 8, BFD_ENDIAN_LITTLE, length);
+      obstack_grow (&cu_list_obstack, val, 8);
+
+      p += length;
+    }
+  make_cleanup (xfree, cu_offsets);
+  cu_seen = obstack_alloc (&temp_obstack, n_cus + 1);
+  memset (cu_seen, 0, n_cus + 1);
+
+  if (!read_aranges_to_address_table (objfile, cu_offsets, n_cus,
+				      &addr_obstack))
+    {
+      reason = "no usable .debug_aranges section";
+      goto reject_with_cleanups;
+    }
+
+  symtab = create_mapped_symtab ();
+  make_cleanup (cleanup_mapped_symtab, symtab);
+  entries_cleanup = make_cleanup (cleanup_mapped_symtab_entries, symtab);
+
+  /* A section can hold several name indexes, e.g. when the linker
+     concatenated those of the input files.  */
+  p = section->buffer;
+  end = section->buffer + section->size;
+  while (p < end)
+    {
+      p = read_debug_names_unit (abfd, p, end, cu_offsets, n_cus, cu_seen,
+				 symtab, &temp_obstack);
+      if (p == NULL)
+	{
+	  reason = "invalid or unsupported name index";
+	  goto reject_with_cleanups;
+	}
+    }
+
+  /* If a CU is not covered, lookups could miss its symbols.  */
+  for (i = 0; i < n_cus; ++i)
+    if (!cu_seen[i])
+      {
+	reason = "name index does not cover all CUs";
+	goto reject_with_cleanups;
+      }
+
+  uniquify_cu_indices (symtab);
+
+  /* From here on the entries are owned by write_hash_table.  */
+  discard_cleanups (entries_cleanup);
+  obstack_init (&constant_pool);
+  make_cleanup_obstack_free (&constant_pool);
+  obstack_init (&symtab_obstack);
+  make_cleanup_obstack_free (&symtab_obstack);
+  write_hash_table (symtab, &symtab_obstack, &constant_pool);
+
+  /* Lay out the index as write_psymtabs_to_index_file does.  */
+  total_len = sizeof (header);
+  header[0] = MAYBE_SWAP (8);
+  header[1] = MAYBE_SWAP (total_len);
+  total_len += obstack_object_size (&cu_list_obstack);
+  header[2] = MAYBE_SWAP (total_len);
+  header[3] = MAYBE_SWAP (total_len);
+  total_len += obstack_object_size (&addr_obstack);
+  header[4] = MAYBE_SWAP (total_len);
+  total_len += obstack_object_size (&symtab_obstack);
+  header[5] = MAYBE_SWAP (total_len);
+  total_len += obstack_object_size (&constant_pool);
+
+  buffer = obstack_alloc (&objfile->objfile_obstack, total_len);
+  dest = buffer;
+  memcpy (dest, header, sizeof (header));
+  dest += sizeof (header);
+  memcpy (dest, obstack_base (&cu_list_obstack),
+	  obstack_object_size (&cu_list_obstack));
+  dest += obstack_object_size (&cu_list_obstack);
+  memcpy (dest, obstack_base (&addr_obstack),
+	  obstack_object_size (&addr_obstack));
+  dest += obstack_object_size (&addr_obstack);
+  memcpy (dest, obstack_base (&symtab_obstack),
+	  obstack_object_size (&symtab_obstack));
+  dest += obstack_object_size (&symtab_obstack);
+  memcpy (dest, obstack_base (&constant_pool),
+	  obstack_object_size (&constant_pool));
+
+  do_cleanups (cleanup);
+
+  if (!read_index_from_buffer (objfile, objfile_name (objfile), 1,
+			       buffer, total_len, map,
+			       cu_list, cu_list_elements,
+			       types_list, types_list_elements))
+    {
+      reason = "internal error";
+      goto reject;
+    }
+
+  if (dwarf2_read_debug)
+    fprintf_unfiltered (gdb_stdlog, "debug_names: using index for %s\n",
+			objfile_name (objfile));
+  dwarf2_per_objfile->index_from_debug_names = 1;
+  return 1;
+
+ reject_with_cleanups:
+  do_cleanups (cleanup);
+ reject:
+  if (dwarf2_read_debug)
+    fprintf_unfiltered (gdb_stdlog, "debug_names: not using index for %s: %s\n",
+			objfile_name (objfile), reason);
+  return 0;
+}
+
+/* Append VALUE to OBSTACK as an unsigned LEB128 number.  */
+
+static void
+uleb128_to_obstack (struct obstack *obstack, ULONGEST value)
+{
+  do
+    {
+      gdb_byte byte = value & 0x7f;
+
+      value >>= 7;
+      if (value != 0)
+	byte |= 0x80;
+      obstack_1grow (obstack, byte);
+    }
+  while (value != 0);
+}
+
+/* An entry being written to a .debug_names index, describing the DIE
+   of one partial symbol.  */
+struct debug_names_out_entry
+{
+  /* The offset of the DIE in its section, and in its CU.  */
+  sect_offset offset;
+  cu_offset die_offset;
+
+  ULONGEST tag;
+
+  /* Index of the CU in the table of all CUs.  */
+  offset_type cu_index;
+
+  int is_static;
+
+  /* The name of the partial symbol, qualified by the names of its
+     scopes.  */
+  const char *qualified_name;
+
+  /* The name written to the index.  This is QUALIFIED_NAME without
+     the qualification that the entry of PARENT supplies.  */
+  const char *name;
+
+  /* The partial DIE of the scope containing the DIE.  This is only
+     valid while the CU is being scanned.  */
+  struct partial_die_info *scope;
+
+  /* The entry of the scope containing the DIE, or NULL if the entry
+     is written without a parent.  */
+  struct debug_names_out_entry *parent;
+
+  /* Non-zero once PARENT and NAME have been computed.  */
+  int resolved;
+
+  /* The offset of the entry, and of its DW_IDX_parent value if any,
+     in the entry pool.  */
+  ULONGEST pool_offset;
+  ULONGEST parent_ref_offset;
+
+  /* The next entry with the same NAME.  */
+  struct debug_names_out_entry *next;
+};
+
+static hashval_t
+hash_debug_names_out_entry (const void *item)
+{
+  const struct debug_names_out_entry *entry = item;
+
+  return entry->offset.sect_off;
+}
+
+static int
+eq_debug_names_out_entry (const void *item_lhs, const void *item_rhs)
+{
+  const struct debug_names_out_entry *lhs = item_lhs;
+  const struct debug_names_out_entry *rhs = item_rhs;
+
+  return lhs->offset.sect_off == rhs->offset.sect_off;
+}
+
+/* A name being written to a .debug_names index.  */
+struct debug_names_name
+{
+  const char *name;
+  struct debug_names_out_entry *entries;
+  uint32_t hash;
+  uint32_t bucket;
+};
+
+static hashval_t
+hash_debug_names_name (const void *item)
+{
+  const struct debug_names_name *name = item;
+
+  return htab_hash_string (name->name);
+}
+
+static int
+eq_debug_names_name (const void *item_lhs, const void *item_rhs)
+{
+  const struct debug_names_name *lhs = item_lhs;
+  const struct debug_names_name *rhs = item_rhs;
+
+  return strcmp (lhs->name, rhs->name) == 0;
+}
+
+/* An abbreviation being written to a .debug_names index.  */
+struct debug_names_out_abbrev
+{
+  ULONGEST code;
+  ULONGEST tag;
+  int is_static;
+  int has_parent;
+};
+
+static hashval_t
+hash_debug_names_out_abbrev (const void *item)
+{
+  const struct debug_names_out_abbrev *abbrev = item;
+
+  return abbrev->tag * 4 + abbrev->is_static * 2 + abbrev->has_parent;
+}
+
+static int
+eq_debug_names_out_abbrev (const void *item_lhs, const void *item_rhs)
+{
+  const struct debug_names_out_abbrev *lhs = item_lhs;
+  const struct debug_names_out_abbrev *rhs = item_rhs;
+
+  return (lhs->tag == rhs->tag
+	  && lhs->is_static == rhs->is_static
+	  && lhs->has_parent == rhs->has_parent);
+}
+
+/* The index entries of the CU that write_debug_names_file is
+   scanning.  */
+struct debug_names_cu_entries
+{
+  /* Index of the CU in the table of all CUs.  */
+  offset_type cu_index;
+
+  /* The entries of the CU, hashed by DIE offset.  */
+  htab_t entries;
+
+  /* All the names of the index so far.  */
+  htab_t names;
+
+  /* Where the entries and names are allocated.  */
+  struct obstack *obstack;
+};
+
+/* Return the partial DIE of the scope containing PDI, from compilation
+   unit CU, or NULL if PDI is at the top level.  Like
+   partial_die_parent_scope, this follows DW_AT_specification.  */
+
+static struct partial_die_info *
+debug_names_scope_die (struct partial_die_info *pdi, struct dwarf2_cu *cu)
+{
+  while (pdi->has_specification)
+    pdi = find_partial_die (pdi->spec_offset, pdi->spec_is_dwz, cu);
+
+  return pdi->die_parent;
+}
+
+/* Record an index entry for PDI, from compilation unit CU, whose
+   partial symbol would be called QUALIFIED_NAME.  IS_STATIC is
+   non-zero if the symbol would be static.  */
+
+static void
+debug_names_record_entry (struct dwarf2_cu *cu, struct partial_die_info *pdi,
+			  const char *qualified_name, int is_static)
+{
+  struct debug_names_cu_entries *cu_entries = cu->debug_names_entries;
+  struct debug_names_out_entry find, *entry;
+  void **slot;
+
+  find.offset = pdi->offset;
+  slot = htab_find_slot (cu_entries->entries, &find, INSERT);
+  if (*slot != NULL)
+    return;
+
+  entry = obstack_alloc (cu_entries->obstack, sizeof (*entry));
+  memset (entry, 0, sizeof (*entry));
+  entry->offset = pdi->offset;
+  entry->die_offset.cu_off = pdi->offset.sect_off - cu->header.offset.sect_off;
+  entry->tag = pdi->tag;
+  entry->cu_index = cu_entries->cu_index;
+  entry->is_static = is_static;
+  entry->qualified_name = obstack_copy0 (cu_entries->obstack, qualified_name,
+					 strlen (qualified_name));
+  /* PDI may be a temporary of load_partial_dies, so find its scope
+     now.  */
+  entry->scope = debug_names_scope_die (pdi, cu);
+  *slot = entry;
+}
+
+/* Compute the parent and the index name of ENTRY, from compilation
+   unit CU.  A reader of the index qualifies the name of an entry by
+   the qualified name of its parent entry, except that enumerators are
+   qualified by the scope of their enumeration type, as in
+   partial_die_parent_scope.  ENTRY only gets a parent if this gives
+   back ENTRY's qualified name.  */
+
+static void
+debug_names_resolve_parent (struct debug_names_out_entry *entry,
+			    struct dwarf2_cu *cu)
+{
+  htab_t entries = cu->debug_names_entries->entries;
+  struct partial_die_info *scope = entry->scope;
+  struct debug_names_out_entry find, *parent = NULL;
+  const char *prefix;
+  size_t len;
+
+  if (entry->resolved)
+    return;
+  entry->resolved = 1;
+  entry->name = entry->qualified_name;
+
+  /* Anonymous scopes, which have no entry, do not qualify the name;
+     look through them.  */
+  while (scope != NULL && offset_in_cu_p (&cu->header, scope->offset))
+    {
+      find.offset = scope->offset;
+      parent = htab_find (entries, &find);
+      if (parent != NULL || scope->name != NULL)
+	break;
+      scope = debug_names_scope_die (scope, cu);
+    }
+  if (parent == NULL)
+    return;
+
+  debug_names_resolve_parent (parent, cu);
+
+  if (entry->tag == DW_TAG_enumerator
+      && parent->tag == DW_TAG_enumeration_type)
+    prefix = parent->parent != NULL ? parent->parent->qualified_name : NULL;
+  else
+    prefix = parent->qualified_name;
+
+  if (prefix == NULL)
+    {
+      entry->parent = parent;
+      return;
+    }
+
+  len = strlen (prefix);
+  if (strncmp (entry->qualified_name, prefix, len) == 0
+      && entry->qualified_name[len] == ':'
+      && entry->qualified_name[len + 1] == ':'
+      && entry->qualified_name[len + 2] != '\0')
+    {
+      entry->parent = parent;
+      entry->name = entry->qualified_name + len + 2;
+    }
+}
+
+/* htab_traverse_noresize function for debug_names_cu_reader, which
+   resolves the parent of the entry in *SLOT.  D is the dwarf2_cu.  */
+
+static int
+debug_names_resolve_one (void **slot, void *d)
+{
+  debug_names_resolve_parent (*slot, d);
+  return 1;
+}
+
+/* htab_traverse_noresize function for write_debug_names_file, which
+   adds the entry in *SLOT to the list of its name.  D is the
+   debug_names_cu_entries of the entry's CU.  */
+
+static int
+debug_names_add_to_name (void **slot, void *d)
+{
+  struct debug_names_out_entry *entry = *slot;
+  struct debug_names_cu_entries *cu_entries = d;
+  struct debug_names_name find, *name;
+  void **name_slot;
+
+  /* The partial DIEs of the CU are about to go away.  */
+  entry->scope = NULL;
+
+  find.name = entry->name;
+  name_slot = htab_find_slot (cu_entries->names, &find, INSERT);
+  if (*name_slot == NULL)
+    {
+      name = obstack_alloc (cu_entries->obstack, sizeof (*name));
+      memset (name, 0, sizeof (*name));
+      name->name = entry->name;
+      *name_slot = name;
+    }
+  name = *name_slot;
+  entry->next = name->entries;
+  name->entries = entry;
+
+  return 1;
+}
+
+/* Reader function for write_debug_names_file.  Scan the partial DIEs
+   of the CU like process_psymtab_comp_unit_reader, but record index
+   entries in DATA, a debug_names_cu_entries, instead of creating
+   partial symbols.  */
+
+static void
+debug_names_cu_reader (const struct die_reader_specs *reader,
+		       const gdb_byte *info_ptr,
+		       struct die_info *comp_unit_die,
+		       int has_children,
+		       void *data)
+{
+  struct dwarf2_cu *cu = reader->cu;
+  struct partial_die_info *first_die;
+  CORE_ADDR lowpc, highpc;
+
+  prepare_one_comp_unit (cu, comp_unit_die, language_minimal);
+
+  if (cu->language == language_ada)
+    error (_("Ada is not currently supported by the index"));
+
+  if (!has_children)
+    return;
+
+  lowpc = ((CORE_ADDR) -1);
+  highpc = ((CORE_ADDR) 0);
+
+  cu->debug_names_entries = data;
+  first_die = load_partial_dies (reader, info_ptr, 1);
+  scan_partial_symbols (first_die, &lowpc, &highpc, 0, cu);
+  htab_traverse_noresize (cu->debug_names_entries->entries,
+			  debug_names_resolve_one, cu);
+  cu->debug_names_entries = NULL;
+}
+
+/* qsort helper routine for write_debug_names_file, which sorts the
+   names by hash bucket.  */
+
+static int
+debug_names_name_compare (const void *ap, const void *bp)
+{
+  const struct debug_names_name *a = *(const struct debug_names_name **) ap;
+  const struct debug_names_name *b = *(const struct debug_names_name **) bp;
+
+  return (a->bucket > b->bucket) - (b->bucket > a->bucket);
+}
+
+/* htab_traverse_noresize function for write_debug_names_file, which
+   appends the name in *SLOT to the array at *D.  */
+
+static int
+debug_names_collect_name (void **slot, void *d)
+{
+  struct debug_names_name ***next = d;
+
+  *(*next)++ = *slot;
+  return 1;
+}
+
+/* htab_traverse_noresize function for write_debug_names_file, which
+   writes the abbreviation in *SLOT to the obstack D.  */
+
+static int
+debug_names_write_abbrev (void **slot, void *d)
+{
+  const struct debug_names_out_abbrev *abbrev = *slot;
+  struct obstack *abbrev_table = d;
+
+  uleb128_to_obstack (abbrev_table, abbrev->code);
+  uleb128_to_obstack (abbrev_table, abbrev->tag);
+  uleb128_to_obstack (abbrev_table, DW_IDX_compile_unit);
+  uleb128_to_obstack (abbrev_table, DW_FORM_udata);
+  uleb128_to_obstack (abbrev_table, DW_IDX_die_offset);
+  uleb128_to_obstack (abbrev_table, DW_FORM_ref4);
+  if (abbrev->has_parent)
+    {
+      uleb128_to_obstack (abbrev_table, DW_IDX_parent);
+      uleb128_to_obstack (abbrev_table, DW_FORM_ref4);
+    }
+  uleb128_to_obstack (abbrev_table,
+		      abbrev->is_static
+		      ? DW_IDX_GNU_internal : DW_IDX_GNU_external);
+  uleb128_to_obstack (abbrev_table, DW_FORM_flag_present);
+  uleb128_to_obstack (abbrev_table, 0);
+  uleb128_to_obstack (abbrev_table, 0);
+
+  return 1;
+}
+
+/* Write a DWARF 5 name index for OBJFILE to the file named FILENAME.
+   The names in the index are written to the file named STR_FILENAME;
+   their offsets assume that its contents are appended to the
+   .debug_str section of OBJFILE.
+
+   The partial DIEs of each CU are scanned again, and each DIE that
+   would get a partial symbol gets an entry with its real tag and DIE
+   offset.  The name of an entry is qualified by its DW_IDX_parent
+   entry, so that the index holds "method" under a parent "klass"
+   rather than "klass::method".  */
+
+static void
+write_debug_names_file (struct objfile *objfile, const char *filename,
+			const char *str_filename)
+{
+  enum bfd_endian byte_order = (bfd_big_endian (objfile->obfd)
+				? BFD_ENDIAN_BIG : BFD_ENDIAN_LITTLE);
+  struct cleanup *cleanup;
+  char *cleanup_filename, *cleanup_str_filename;
+  struct obstack contents, cu_list, hash_table, name_table, abbrev_table;
+  struct obstack entry_pool, str_table, entries_obstack;
+  struct debug_names_cu_entries cu_entries;
+  struct debug_names_name **names, **next_name;
+  htab_t abbrevs;
+  ULONGEST str_base;
+  offset_type i, j, name_count, bucket_count;
+  FILE *out_file, *str_file;
+  gdb_byte val[8];
+
+  if (dwarf2_per_objfile->using_index)
+    error (_("Cannot use an index to create the index"));
+
+  if (!VEC_empty (dwarf2_section_info_def, dwarf2_per_objfile->types))
+    error (_("Cannot make a .debug_names index when the file has "
+	     ".debug_types sections"));
+
+  if (dwarf2_get_dwz_file () != NULL)
+    error (_("Cannot make a .debug_names index when the file uses "
+	     "a .dwz file"));
+
+  if (!objfile->psymtabs)
+    return;
+
+  out_file = gdb_fopen_cloexec (filename, "wb");
+  if (!out_file)
+    error (_("Can't open `%s' for writing"), filename);
+  cleanup_filename = (char *) filename;
+  cleanup = make_cleanup (unlink_if_set, &cleanup_filename);
+  make_cleanup_fclose (out_file);
+
+  str_file = gdb_fopen_cloexec (str_filename, "wb");
+  if (!str_file)
+    error (_("Can't open `%s' for writing"), str_filename);
+  cleanup_str_filename = (char *) str_filename;
+  make_cleanup (unlink_if_set, &cleanup_str_filename);
+  make_cleanup_fclose (str_file);
+
+  obstack_init (&contents);
+  make_cleanup_obstack_free (&contents);
+  obstack_init (&cu_list);
+  make_cleanup_obstack_free (&cu_list);
+  obstack_init (&hash_table);
+  make_cleanup_obstack_free (&hash_table);
+  obstack_init (&name_table);
+  make_cleanup_obstack_free (&name_table);
+  obstack_init (&abbrev_table);
+  make_cleanup_obstack_free (&abbrev_table);
+  obstack_init (&entry_pool);
+  make_cleanup_obstack_free (&entry_pool);
+  obstack_init (&str_table);
+  make_cleanup_obstack_free (&str_table);
+  obstack_init (&entries_obstack);
+  make_cleanup_obstack_free (&entries_obstack);
+
+  cu_entries.obstack = &entries_obstack;
+  cu_entries.names = htab_create_alloc (100, hash_debug_names_name,
+					eq_debug_names_name, NULL,
+					xcalloc, xfree);
+  make_cleanup_htab_delete (cu_entries.names);
+  abbrevs = htab_create_alloc (20, hash_debug_names_out_abbrev,
+			       eq_debug_names_out_abbrev, NULL,
+			       xcalloc, xfree);
+  make_cleanup_htab_delete (abbrevs);
+
+  make_cleanup (free_cached_comp_units, NULL);
+
+  for (i = 0; i < dwarf2_per_objfile->n_comp_units; ++i)
+    {
+      struct dwarf2_per_cu_data *per_cu
+	= dwarf2_per_objfile->all_comp_units[i];
+      struct partial_symtab *psymtab = per_cu->v.psymtab;
+      struct cleanup *cu_cleanup;
+
+      store_unsigned_integer (val, 4, byte_order, per_cu->offset.sect_off);
+      obstack_grow (&cu_list, val, 4);
+
+      if (psymtab == NULL)
+	continue;
+
+      /* The symbols of a partial unit belong to the CUs that import
+	 it, which the DIE offsets of the index cannot express.  */
+      if (psymtab->user != NULL || psymtab->number_of_dependencies != 0)
+	error (_("Cannot make a .debug_names index when the file has "
+		 "partial units"));
+
+      cu_entries.cu_index = i;
+      cu_entries.entries = htab_create_alloc (100, hash_debug_names_out_entry,
+					      eq_debug_names_out_entry,
+					      NULL, xcalloc, xfree);
+      cu_cleanup = make_cleanup_htab_delete (cu_entries.entries);
+
+      /* The cached copy, if any, may lack the DIEs that the scan
+	 needs; see process_psymtab_comp_unit.  */
+      if (per_cu->cu != NULL)
+	free_one_cached_comp_unit (per_cu);
+      init_cutu_and_read_dies (per_cu, NULL, 0, 0, debug_names_cu_reader,
+			       &cu_entries);
+      age_cached_comp_units ();
+
+      htab_traverse_noresize (cu_entries.entries, debug_names_add_to_name,
+			      &cu_entries);
+      do_cleanups (cu_cleanup);
+    }
+
+  /* Collect the names, and sort them by hash bucket, aiming for about
+     two names per bucket.  */
+  name_count = htab_elements (cu_entries.names);
+  names = XNEWVEC (struct debug_names_name *, name_count);
+  make_cleanup (xfree, names);
+  next_name = names;
+  htab_traverse_noresize (cu_entries.names, debug_names_collect_name,
+			  &next_name);
+  bucket_count = (name_count + 1) / 2;
+  for (i = 0; i < name_count; ++i)
+    {
+      names[i]->hash = dwarf5_djb_hash (names[i]->name);
+      names[i]->bucket = names[i]->hash % bucket_count;
+    }
+  qsort (names, name_count, sizeof (*names), debug_names_name_compare);
+
+  /* The bucket array, holding the one-based index of the first name
+     in each bucket, followed by the hashes of all the names.  */
+  for (i = 0, j = 0; i < bucket_count; ++i)
+    {
+      offset_type first = 0;
+
+      if (j < name_count && names[j]->bucket == i)
+	{
+	  first = j + 1;
+	  while (j < name_count && names[j]->bucket == i)
+	    ++j;
+	}
+      store_unsigned_integer (val, 4, byte_order, first);
+      obstack_grow (&hash_table, val, 4);
+    }
+  for (i = 0; i < name_count; ++i)
+    {
+      store_unsigned_integer (val, 4, byte_order, names[i]->hash);
+      obstack_grow (&hash_table, val, 4);
+    }
+
+  /* The string offsets, followed by the entry offsets.  Each entry
+     has the tag of its DIE, and gets an abbreviation for that tag,
+     its static-ness and whether it has a parent.  The DW_IDX_parent
+     values are filled in once all the entries have been laid out.  */
+  str_base = dwarf2_per_objfile->str.size;
+  for (i = 0; i < name_count; ++i)
+    {
+      ULONGEST offset = str_base + obstack_object_size (&str_table);
+
+      if (offset > 0xffffffff)
+	error (_("The .debug_str section is too large for a .debug_names "
+		 "index"));
+      store_unsigned_integer (val, 4, byte_order, offset);
+      obstack_grow (&name_table, val, 4);
+      obstack_grow_str0 (&str_table, names[i]->name);
+    }
+  for (i = 0; i < name_count; ++i)
+    {
+      struct debug_names_out_entry *entry;
+
+      store_unsigned_integer (val, 4, byte_order,
+			      obstack_object_size (&entry_pool));
+      obstack_grow (&name_table, val, 4);
+
+      for (entry = names[i]->entries; entry != NULL; entry = entry->next)
+	{
+	  struct debug_names_out_abbrev find, *abbrev;
+	  void **slot;
+
+	  find.tag = entry->tag;
+	  find.is_static = entry->is_static;
+	  find.has_parent = entry->parent != NULL;
+	  slot = htab_find_slot (abbrevs, &find, INSERT);
+	  if (*slot == NULL)
+	    {
+	      abbrev = obstack_alloc (&entries_obstack, sizeof (*abbrev));
+	      *abbrev = find;
+	      abbrev->code = htab_elements (abbrevs);
+	      *slot = abbrev;
+	    }
+	  abbrev = *slot;
+
+	  entry->pool_offset = obstack_object_size (&entry_pool);
+	  uleb128_to_obstack (&entry_pool, abbrev->code);
+	  uleb128_to_obstack (&entry_pool, entry->cu_index);
+	  store_unsigned_integer (val, 4, byte_order,
+				  entry->die_offset.cu_off);
+	  obstack_grow (&entry_pool, val, 4);
+	  if (entry->parent != NULL)
+	    {
+	      entry->parent_ref_offset = obstack_object_size (&entry_pool);
+	      obstack_grow (&entry_pool, val, 4);
+	    }
+	}
+      uleb128_to_obstack (&entry_pool, 0);
+    }
+  for (i = 0; i < name_count; ++i)
+    {
+      struct debug_names_out_entry *entry;
+
+      for (entry = names[i]->entries; entry != NULL; entry = entry->next)
+	if (entry->parent != NULL)
+	  store_unsigned_integer ((gdb_byte *) obstack_base (&entry_pool)
+				  + entry->parent_ref_offset,
+				  4, byte_order, entry->parent->pool_offset);
+    }
+
+  htab_traverse_noresize (abbrevs, debug_names_write_abbrev, &abbrev_table);
+  uleb128_to_obstack (&abbrev_table, 0);
+
+  /* Finally the header.  */
+  store_unsigned_integer (val, 4, byte_order,
+			  2 + 2 + 7 * 4 + 4
+			  + obstack_object_size (&cu_list)
+			  + obstack_object_size (&hash_table)
+			  + obstack_object_size (&name_table)
+			  + obstack_object_size (&abbrev_table)
+			  + obstack_object_size (&entry_pool));
+  obstack_grow (&contents, val, 4);
+  store_unsigned_integer (val, 2, byte_order, 5);
+  obstack_grow (&contents, val, 2);
+  store_unsigned_integer (val, 2, byte_order, 0);
+  obstack_grow (&contents, val, 2);
+  store_unsigned_integer (val, 4, byte_order,
+			  dwarf2_per_objfile->n_comp_units);
+  obstack_grow (&contents, val, 4);
+  store_unsigned_integer (val, 4, byte_order, 0);
+  obstack_grow (&contents, val, 4);
+  obstack_grow (&contents, val, 4);
+  store_unsigned_integer (val, 4, byte_order, bucket_count);
+  obstack_grow (&contents, val, 4);
+  store_unsigned_integer (val, 4, byte_order, name_count);
+  obstack_grow (&contents, val, 4);
+  store_unsigned_integer (val, 4, byte_order,
+			  obstack_object_size (&abbrev_table));
+  obstack_grow (&contents, val, 4);
+  store_unsigned_integer (val, 4, byte_order, 4);
+  obstack_grow (&contents, val, 4);
+  obstack_grow (&contents, "GDB1", 4);
+
+  write_obstack (out_file, &contents);
+  write_obstack (out_file, &cu_list);
+  write_obstack (out_file, &hash_table);
+  write_obstack (out_file, &name_table);
+  write_obstack (out_file, &abbrev_table);
+  write_obstack (out_file, &entry_pool);
+  write_obstack (str_file, &str_table);
+
+  /* We want to keep the files, so we set the cleanup file names to
+     NULL here.  See unlink_if_set.  */
+  cleanup_filename = NULL;
+  cleanup_str_filename = NULL;
+
+  do_cleanups (cleanup);
+}
+
+/* Create an index file for OBJFILE in the directory DIR.  If DWARF5
+   is non-zero, create DWARF 5 .debug_names and .debug_str contents
+   instead of a .gdb_index.  */
+
+static void
+write_psymtabs_to_index (struct objfile *objfile, const char *dir, int dwarf5)
+{
+  struct cleanup *cleanup;
+  char *filename;
+  struct stat st;
+
+  if (stat (objfile_name (objfile), &st) < 0)
+    perror_with_name (objfile_name (objfile));
+
+  if (dwarf5)
+    {
+      char *str_filename;
+
+      filename = concat (dir, SLASH_STRING, lbasename (objfile_name (objfile)),
+			 DEBUG_NAMES_SUFFIX, (char *) NULL);
+      cleanup = make_cleanup (xfree, filename);
+      str_filename = concat (dir, SLASH_STRING,
+			     lbasename (objfile_name (objfile)),
+			     DEBUG_STR_SUFFIX, (char *) NULL);
+      make_cleanup (xfree, str_filename);
+
+      write_debug_names_file (objfile, filename, str_filename);
+    }
+  else
+    {
+      filename = concat (dir, SLASH_STRING, lbasename (objfile_name (objfile)),
+			 INDEX_SUFFIX, (char *) NULL);
+      cleanup = make_cleanup (xfree, filename);
+
+      write_psymtabs_to_index_file (objfile, filename);
+    }
+
+  do_cleanups (cleanup);
+}
+
+#ifdef USE_WIN32API
+#undef mkdir
+#define mkdir(pathname, mode) mkdir (pathname)
+#endif
+
+/* Create directory DIR and any missing parent directories.  Return 0
+   on success, or -1 with errno set on failure.  */
+
+static int
+mkdir_recursive (const char *dir)
+{
+  char *copy = xstrdup (dir);
+  char *p = copy;
+  int result = 0;
+
+  while (result == 0)
+    {
+      char save;
+
+      /* Skip over the separators, then find the end of the next
+	 component.  */
+      while (IS_DIR_SEPARATOR (*p))
+	++p;
+      while (*p != '\0' && !IS_DIR_SEPARATOR (*p))
+	++p;
+
+      save = *p;
+      *p = '\0';
+      if (mkdir (copy, S_IRWXU) != 0 && errno != EEXIST)
+	result = -1;
+      *p = save;
+
+      if (save == '\0')
+	break;
+    }
+
+  xfree (copy);
+  return result;
+}
+
+/* Save the index of OBJFILE, whose partial symbols have just been
+   built, in the index cache.  Failures are not reported as errors:
+   the index cache is only an optimization.  */
+
+static void
+index_cache_store (struct objfile *objfile)
+{
+  volatile struct gdb_exception except;
+  char *filename, *tmp_filename;
+  struct cleanup *cleanup;
+
+  if (!index_cache_enabled || index_cache_directory == NULL
+      || dwarf2_per_objfile->using_index)
+    return;
+
+  filename = index_cache_file_name (objfile);
+  if (filename == NULL)
+    return;
+  cleanup = make_cleanup (xfree, filename);
+
+  /* Write to a temporary file, then rename it into place, so that
+     other GDB sessions never see a partially written index.  */
+  tmp_filename = xstrprintf ("%s.%ld.tmp", filename, (long) getpid ());
+  make_cleanup (xfree, tmp_filename);
+
+  TRY_CATCH (except, RETURN_MASK_ERROR)
+    {
+      if (dwarf2_get_dwz_file () != NULL)
+	error (_("objfile uses a .dwz file"));
+
+      if (mkdir_recursive (index_cache_directory) != 0)
+	perror_with_name (index_cache_directory);
+
+      write_psymtabs_to_index_file (objfile, tmp_filename);
+
+      if (rename (tmp_filename, filename) != 0)
+	{
+	  int save_errno = errno;
+
+	  unlink (tmp_filename);
+	  errno = save_errno;
+	  perror_with_name (filename);
+	}
+    }
+
+  if (dwarf2_read_debug)
+    {
+      if (except.reason < 0)
+	exception_fprintf (gdb_stdlog, except,
+			   "index-cache: not saving index for %s: ",
+			   objfile_name (objfile));
+      else
+	fprintf_unfiltered (gdb_stdlog, "index-cache: saved %s for %s\n",
+			    filename, objfile_name (objfile));
+    }
+
+  do_cleanups (cleanup);
+}
+
+/* Implementation of the `save gdb-index' command.
+   
+   Note that the file format used by this command is documented in the
+   GDB manual.  Any changes here must be documented there.  */
+
+static void
+save_gdb_index_command (char *arg, int from_tty)
+{
+  struct objfile *objfile;
+  int dwarf5 = 0;
+
+  if (arg != NULL && strncmp (arg, "-dwarf-5", 8) == 0
+      && (arg[8] == '\0' || isspace (arg[8])))
+    {
+      dwarf5 = 1;
+      arg = skip_spaces (arg + 8);
+    }
+
+  if (!arg || !*arg)
+    error (_("usage: save gdb-index [-dwarf-5] DIRECTORY"));
+
+  ALL_OBJFILES (objfile)
+  {
+    struct stat st;
+
+    /* If the objfile does not correspond to an actual file, skip it.  */
+    if (stat (objfile_name (objfile), &st) < 0)
+      continue;
+
+    dwarf2_per_objfile = objfile_data (objfile, dwarf2_objfile_data_key);
+    if (dwarf2_per_objfile)
+      {
+	volatile struct gdb_exception except;
+
+	TRY_CATCH (except, RETURN_MASK_ERROR)
+	  {
+	    write_psymtabs_to_index (objfile, arg, dwarf5);
+	  }
+	if (except.reason < 0)
+	  exception_fprintf (gdb_stderr, except,
+			     _("Error while writing index for `%s': "),
+			     objfile_name (objfile));
+      }
+  }
+}
+
+
+
+/* The "set index-cache" and "show index-cache" prefix commands.  */
+
+static struct cmd_list_element *set_index_cache_prefix_list;
+static struct cmd_list_element *show_index_cache_prefix_list;
+
+static void
+set_index_cache_command (char *arg, int from_tty)
+{
+  printf_unfiltered (_("\
+\"set index-cache\" must be followed by an appropriate subcommand.\n"));
+  help_list (set_index_cache_prefix_list, "set index-cache ", all_commands,
+	     gdb_stdout);
+}
+
+static void
+show_index_cache_command (char *arg, int from_tty)
+{
+  printf_filtered (_("The index cache is currently %s.\n"),
+		   index_cache_enabled ? _("enabled") : _("disabled"));
+  cmd_show_list (show_index_cache_prefix_list, from_tty, "");
+}
+
+/* Implementation of "set index-cache on".  */
+
+static void
+set_index_cache_on_command (char *arg, int from_tty)
+{
+  if (arg != NULL && *arg != '\0')
+    error (_("Junk after command: %s"), arg);
+
+  index_cache_enabled = 1;
+}
+
+/* Implementation of "set index-cache off".  */
+
+static void
+set_index_cache_off_command (char *arg, int from_tty)
+{
+  if (arg != NULL && *arg != '\0')
+    error (_("Junk after command: %s"), arg);
+
+  index_cache_enabled = 0;
+}
+
+/* Implementation of "set index-cache directory".  Make the directory
+   absolute, so that changing the current directory does not move the
+   cache.  */
+
+static void
+set_index_cache_directory_command (char *arg, int from_tty,
+				   struct cmd_list_element *c)
+{
+  char *abs_dir = gdb_abspath (index_cache_directory);
+
+  xfree (index_cache_directory);
+  index_cache_directory = abs_dir;
+}
+
+static void
+show_index_cache_directory (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("The directory of the index cache is \"%s\".\n"),
+		    value);
+}
+
+/* Compute the default location of the index cache: $XDG_CACHE_HOME/gdb
+   if set, otherwise $HOME/.cache/gdb.  Return NULL if neither
+   environment variable is available.  */
+
+static char *
+index_cache_default_directory (void)
+{
+  const char *xdg_cache_home = getenv ("XDG_CACHE_HOME");
+  const char *home;
+
+  if (xdg_cache_home != NULL && IS_ABSOLUTE_PATH (xdg_cache_home))
+    return concat (xdg_cache_home, SLASH_STRING, "gdb", (char *) NULL);
+
+  home = getenv ("HOME");
+  if (home != NULL && *home != '\0')
+    return concat (home, SLASH_STRING, ".cache", SLASH_STRING, "gdb",
+		   (char *) NULL);
+
+  return NULL;
+}
+
+
+
+int dwarf2_always_disassemble;
+
+static void
+show_dwarf2_always_disassemble (struct ui_file *file, int from_tty,
+				struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file,
+		    _("Whether to always disassemble "
+		      "DWARF expressions is %s.\n"),
+		    value);
+}
+
+static void
+show_check_physname (struct ui_file *file, int from_tty,
+		     struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file,
+		    _("Whether to check \"physname\" is %s.\n"),
+		    value);
+}
+
+void _initialize_dwarf2_read (void);
+
+void
+_initialize_dwarf2_read (void)
+{
+  struct cmd_list_element *c;
+
+  dwarf2_objfile_data_key
+    = register_objfile_data_with_cleanup (NULL, dwarf2_per_objfile_free);
+
+  add_prefix_cmd ("dwarf2", class_maintenance, set_dwarf2_cmd, _("\
+Set DWARF 2 specific variables.\n\
+Configure DWARF 2 variables such as the cache size"),
+                  &set_dwarf2_cmdlist, "maintenance set dwarf2 ",
+                  0/*allow-unknown*/, &maintenance_set_cmdlist);
+
+  add_prefix_cmd ("dwarf2", class_maintenance, show_dwarf2_cmd, _("\
+Show DWARF 2 specific variables\n\
+Show DWARF 2 variables such as the cache size"),
+                  &show_dwarf2_cmdlist, "maintenance show dwarf2 ",
+                  0/*allow-unknown*/, &maintenance_show_cmdlist);
+
+  add_setshow_zinteger_cmd ("max-cache-age", class_obscure,
+			    &dwarf2_max_cache_age, _("\
+Set the upper bound on the age of cached dwarf2 compilation units."), _("\
+Show the upper bound on the age of cached dwarf2 compilation units."), _("\
+A higher limit means that cached compilation units will be stored\n\
+in memory longer, and more total memory will be used.  Zero disables\n\
+caching, which can slow down startup."),
+			    NULL,
+			    show_dwarf2_max_cache_age,
+			    &set_dwarf2_cmdlist,
+			    &show_dwarf2_cmdlist);
+
+  add_setshow_boolean_cmd ("always-disassemble", class_obscure,
+			   &dwarf2_always_disassemble, _("\
+Set whether `info address' always disassembles DWARF expressions."), _("\
+Show whether `info address' always disassembles DWARF expressions."), _("\
+When enabled, DWARF expressions are always printed in an assembly-like\n\
+syntax.  When disabled, expressions will be printed in a more\n\
+conversational style, when possible."),
+			   NULL,
+			   show_dwarf2_always_disassemble,
+			   &set_dwarf2_cmdlist,
+			   &show_dwarf2_cmdlist);
+
+  add_setshow_zuinteger_cmd ("dwarf2-read", no_class, &dwarf2_read_debug, _("\
+Set debugging of the dwarf2 reader."), _("\
+Show debugging of the dwarf2 reader."), _("\
+When enabled (non-zero), debugging messages are printed during dwarf2\n\
+reading and symtab expansion.  A value of 1 (one) provides basic\n\
+information.  A value greater than 1 provides more verbose information."),
+			    NULL,
+			    NULL,
+			    &setdebuglist, &showdebuglist);
+
+  add_setshow_zuinteger_cmd ("dwarf2-die", no_class, &dwarf2_die_debug, _("\
+Set debugging of the dwarf2 DIE reader."), _("\
+Show debugging of the dwarf2 DIE reader."), _("\
+When enabled (non-zero), DIEs are dumped after they are read in.\n\
+The value is the maximum depth to print."),
+			     NULL,
+			     NULL,
+			     &setdebuglist, &showdebuglist);
+
+  add_setshow_boolean_cmd ("check-physname", no_class, &check_physname, _("\
+Set cross-checking of \"physname\" code against demangler."), _("\
+Show cross-checking of \"physname\" code against demangler."), _("\
+When enabled, GDB's internal \"physname\" code is checked against\n\
+the demangler."),
+			   NULL, show_check_physname,
+			   &setdebuglist, &showdebuglist);
+
+  add_setshow_boolean_cmd ("use-deprecated-index-sections",
+			   no_class, &use_deprecated_index_sections, _("\
+Set whether to use deprecated gdb_index sections."), _("\
+Show whether to use deprecated gdb_index sections."), _("\
+When enabled, deprecated .gdb_index sections are used anyway.\n\
+Normally they are ignored either because of a missing feature or\n\
+performance issue.\n\
+Warning: This option must be enabled before gdb reads the file."),
+			   NULL,
+			   NULL,
+			   &setlist, &showlist);
+
+  c = add_cmd ("gdb-index", class_files, save_gdb_index_command,
+	       _("\
+Save a gdb-index file.\n\
+Usage: save gdb-index [-dwarf-5] DIRECTORY\n\
+\n\
+With -dwarf-5, save the index as DWARF 5 .debug_names and .debug_str\n\
+contents instead; the latter must be appended to the .debug_str section."),
+	       &save_cmdlist);
+  set_cmd_completer (c, filename_completer);
+
+  add_prefix_cmd ("index-cache", class_files, set_index_cache_command, _("\
+Set index-cache options.\n\
+When enabled, the index of each file with a build-id and no .gdb_index\n\
+section is saved in the cache directory the first time its debug info is\n\
+read, and later GDB sessions read that index instead of scanning the\n\
+debug info again."),
+		  &set_index_cache_prefix_list, "set index-cache ",
+		  0 /*allow-unknown*/, &setlist);
+  add_prefix_cmd ("index-cache", class_files, show_index_cache_command, _("\
+Show index-cache options."),
+		  &show_index_cache_prefix_list, "show index-cache ",
+		  0 /*allow-unknown*/, &showlist);
+
+  add_cmd ("on", class_files, set_index_cache_on_command,
+	   _("Enable the index cache."), &set_index_cache_prefix_list);
+  add_cmd ("off", class_files, set_index_cache_off_command,
+	   _("Disable the index cache."), &set_index_cache_prefix_list);
+
+  index_cache_directory = index_cache_default_directory ();
+  add_setshow_filename_cmd ("directory", class_files, &index_cache_directory,
+			    _("\
+Set the directory of the index cache."), _("\
+Show the directory of the index cache."), NULL,
+			    set_index_cache_directory_command,
+			    show_index_cache_directory,
+			    &set_index_cache_prefix_list,
+			    &show_index_cache_prefix_list);
 
   dwarf2_locexpr_index = register_symbol_computed_impl (LOC_COMPUTED,
 							&dwarf2_locexpr_funcs);
@@ -351,6 +351,138 @@ get_section_descriptor (asection *section)
   return result;
 }
 
+#if defined (HAVE_MMAP) && defined (HAVE_ZLIB_H)
+
+/* The size of the chunks in which map_compressed_section reads and
+   decompresses a section.  */
+
+#define DECOMPRESS_CHUNK_SIZE (64 * 1024)
+
+/* Decompress the zlib-compressed section SECTP of ABFD into an
+   unlinked temporary file, map that file into memory and fill in
+   DESCRIPTOR.  Unlike a malloc'd buffer, the mapped pages are backed by
+   the file, so the system can evict the ones that are not being used
+   and read them back in on demand.  The section is decompressed in
+   chunks, so it is never held in memory all at once.  Return 1 on
+   success, 0 on failure.  */
+
+static int
+map_compressed_section (bfd *abfd, asection *sectp,
+			struct gdb_bfd_section_data *descriptor)
+{
+  gdb_byte header[12];
+  gdb_byte *in_buf, *out_buf;
+  bfd_size_type compressed_left, uncompressed_size, written;
+  z_stream strm;
+  char *filename;
+  void *map;
+  int fd, i, status, result = 0;
+
+  if (sectp->compress_status == DECOMPRESS_SECTION_SIZED)
+    compressed_left = sectp->compressed_size;
+  else if (sectp->compress_status == COMPRESS_SECTION_NONE)
+    compressed_left = bfd_get_section_size (sectp);
+  else
+    return 0;
+
+  /* The section starts with "ZLIB" and the big-endian uncompressed
+     size.  */
+  if (compressed_left < sizeof (header)
+      || bfd_seek (abfd, sectp->filepos, SEEK_SET) != 0
+      || bfd_bread (header, sizeof (header), abfd) != sizeof (header)
+      || memcmp (header, "ZLIB", 4) != 0)
+    return 0;
+  compressed_left -= sizeof (header);
+  uncompressed_size = 0;
+  for (i = 4; i < 12; ++i)
+    uncompressed_size = (uncompressed_size << 8) | header[i];
+  if (uncompressed_size == 0)
+    return 0;
+
+  filename = make_temp_file (NULL);
+  fd = gdb_open_cloexec (filename, O_RDWR, 0);
+  unlink (filename);
+  xfree (filename);
+  if (fd < 0)
+    return 0;
+
+  memset (&strm, 0, sizeof (strm));
+  if (inflateInit (&strm) != Z_OK)
+    {
+      close (fd);
+      return 0;
+    }
+
+  in_buf = xmalloc (DECOMPRESS_CHUNK_SIZE);
+  out_buf = xmalloc (DECOMPRESS_CHUNK_SIZE);
+  written = 0;
+  status = Z_OK;
+  while (status == Z_OK)
+    {
+      if (strm.avail_in == 0)
+	{
+	  bfd_size_type count = compressed_left;
+
+	  if (count == 0)
+	    break;
+	  if (count > DECOMPRESS_CHUNK_SIZE)
+	    count = DECOMPRESS_CHUNK_SIZE;
+	  if (bfd_bread (in_buf, count, abfd) != count)
+	    break;
+	  compressed_left -= count;
+	  strm.next_in = in_buf;
+	  strm.avail_in = count;
+	}
+
+      strm.next_out = out_buf;
+      strm.avail_out = DECOMPRESS_CHUNK_SIZE;
+      status = inflate (&strm, Z_NO_FLUSH);
+      if (status == Z_OK || status == Z_STREAM_END)
+	{
+	  size_t len = DECOMPRESS_CHUNK_SIZE - strm.avail_out;
+	  gdb_byte *p = out_buf;
+
+	  if (len > uncompressed_size - written)
+	    break;
+	  written += len;
+	  while (len > 0)
+	    {
+	      ssize_t n = write (fd, p, len);
+
+	      if (n <= 0)
+		{
+		  status = Z_ERRNO;
+		  break;
+		}
+	      p += n;
+	      len -= n;
+	    }
+	}
+    }
+  inflateEnd (&strm);
+  xfree (in_buf);
+  xfree (out_buf);
+
+  if (status == Z_STREAM_END && written == uncompressed_size)
+    {
+      map = mmap (NULL, uncompressed_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED)
+	{
+	  descriptor->size = uncompressed_size;
+	  descriptor->data = map;
+	  descriptor->map_addr = map;
+	  descriptor->map_len = uncompressed_size;
+	  result = 1;
+	}
+    }
+
+  /* The mapping keeps the file alive.  */
+  close (fd);
+  return result;
+}
+
+#endif /* HAVE_MMAP && HAVE_ZLIB_H */
+
 /* See gdb_bfd.h.  */
 
 const gdb_byte *
@@ -359,6 +491,9 @@ gdb_bfd_map_section (asection *sectp, bfd_size_type *size)
   bfd *abfd;
   struct gdb_bfd_section_data *descriptor;
   bfd_byte *data;
+#ifdef HAVE_MMAP
+  static int pagesize;
+#endif
 
   gdb_assert ((sectp->flags & SEC_RELOC) == 0);
   gdb_assert (size != NULL);
@@ -372,14 +507,12 @@ gdb_bfd_map_section (asection *sectp, bfd_size_type *size)
     goto done;
 
 #ifdef HAVE_MMAP
+  /* The page size, used when mmapping.  */
+  if (pagesize == 0)
+    pagesize = getpagesize ();
+
   if (!bfd_is_section_compressed (abfd, sectp))
     {
-      /* The page size, used when mmapping.  */
-      static int pagesize;
-
-      if (pagesize == 0)
-	pagesize = getpagesize ();
-
       /* Only try to mmap sections which are large enough: we don't want
 	 to waste space due to fragmentation.  */
 
@@ -404,10 +537,17 @@ gdb_bfd_map_section (asection *sectp, bfd_size_type *size)
 	  memset (descriptor, 0, sizeof (*descriptor));
 	}
     }
+#ifdef HAVE_ZLIB_H
+  /* Large compressed sections are decompressed to a file and mapped,
+     so that their pages can be evicted.  */
+  else if (bfd_get_section_size (sectp) > 4 * pagesize
+	   && map_compressed_section (abfd, sectp, descriptor))
+    goto done;
+#endif /* HAVE_ZLIB_H */
 #endif /* HAVE_MMAP */
 
-  /* Handle compressed sections, or ordinary uncompressed sections in
-     the no-mmap case.  */
+  /* Handle small compressed sections, or ordinary uncompressed
+     sections in the no-mmap case.  */
 
   descriptor->size = bfd_get_section_size (sectp);
   descriptor->data = NULL;
@@ -9,6 +9,9 @@ sinclude(../libmcheck.m4)
 dnl This gets autoconf bugfixes
 sinclude(../../config/override.m4)
 
+dnl For AM_ZLIB.
+sinclude(../../config/zlib.m4)
+
 dnl For ACX_PKGVERSION and ACX_BUGURL.
 sinclude(../../config/acx.m4)
 
@@ -910,21 +910,253 @@ ax_printf (CORE_ADDR fn, CORE_ADDR chan, const char *format,
   fflush (stdout);
 }
 
-/* The agent expression evaluator, as specified by the GDB docs. It
-   returns 0 if everything went OK, and a nonzero error code
-   otherwise.  */
+/* An agent expression bytecode, with its operands decoded.  */
 
-enum eval_result_type
-gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
-		     struct agent_expr *aexpr,
-		     ULONGEST *rslt)
+struct agent_insn
+{
+  /* The opcode.  Zero, which is not a valid opcode, stands for a
+     bytecode whose operands run past the end of the expression.  */
+  unsigned char op;
+
+  /* The offset of the following bytecode.  */
+  int next;
+
+  /* The operand of OP, if it has one: the offset to jump to, the
+     register or trace state variable number, the number of bits, or
+     the number of printf arguments.  */
+  int arg;
+
+  /* The constant pushed by the const bytecodes, or the length of the
+     printf format string.  */
+  ULONGEST value;
+
+  /* The printf format string, which points into the expression.  */
+  const char *format;
+};
+
+/* Decode the bytecode at offset PC of AEXPR into INSN.  */
+
+static void
+decode_agent_insn (const struct agent_expr *aexpr, int pc,
+		   struct agent_insn *insn)
+{
+  const unsigned char *bytes = aexpr->bytes;
+  int size, i;
+
+  memset (insn, 0, sizeof (*insn));
+  if (pc < 0 || pc >= aexpr->length)
+    return;
+
+  insn->op = bytes[pc++];
+  if (insn->op < gdb_agent_op_last)
+    size = gdb_agent_op_sizes[insn->op];
+  else
+    size = 0;
+  if (insn->op == gdb_agent_op_printf)
+    size = 3;
+  if (pc + size > aexpr->length)
+    {
+      insn->op = 0;
+      return;
+    }
+
+  switch (insn->op)
+    {
+    case gdb_agent_op_const8:
+    case gdb_agent_op_const16:
+    case gdb_agent_op_const32:
+    case gdb_agent_op_const64:
+      for (i = 0; i < size; i++)
+	insn->value = (insn->value << 8) + bytes[pc + i];
+      break;
+
+    case gdb_agent_op_printf:
+      insn->arg = bytes[pc];
+      insn->value = (bytes[pc + 1] << 8) + bytes[pc + 2];
+      insn->format = (const char *) &bytes[pc + 3];
+      size += insn->value;
+      if (pc + size > aexpr->length)
+	{
+	  insn->op = 0;
+	  return;
+	}
+      break;
+
+    default:
+      for (i = 0; i < size; i++)
+	insn->arg = (insn->arg << 8) + bytes[pc + i];
+      break;
+    }
+
+  insn->next = pc + size;
+}
+
+/* A bytecode that the goto bytecodes of an expression jump to.  */
+
+struct agent_jump_target
+{
+  /* The offset of the bytecode in the expression.  */
+  int offset;
+
+  /* Its index in the decoded bytecodes.  */
+  int index;
+};
+
+/* The bytecodes of an agent expression, decoded ahead of time.  */
+
+struct decoded_agent_expr
+{
+  /* The bytecodes met decoding the expression from its start, in
+     order.  The one at index I starts where the one at I - 1 ends.  */
+  int num_insns;
+  struct agent_insn *insns;
+
+  /* The bytecodes of INSNS that a goto or if_goto jumps to, sorted by
+     offset.  Jumps to offsets not in here land in the middle of a
+     bytecode; those are decoded as they are evaluated.  */
+  int num_targets;
+  struct agent_jump_target *targets;
+};
+
+/* Return the offset of the bytecode at index INDEX of DEXPR.  */
+
+static int
+decoded_insn_offset (const struct decoded_agent_expr *dexpr, int index)
+{
+  return index == 0 ? 0 : dexpr->insns[index - 1].next;
+}
+
+/* Return the bytecode at offset PC of DEXPR, and set *INDEX to its
+   index, or return NULL if PC does not start one we know about.  On
+   entry, *INDEX is the index of the bytecode following the previous
+   one that was evaluated, which is where PC is unless it jumped.  */
+
+static const struct agent_insn *
+decoded_insn_at (const struct decoded_agent_expr *dexpr, int pc,
+		 int *index)
+{
+  int lo, hi;
+
+  if (*index >= 0 && *index < dexpr->num_insns
+      && decoded_insn_offset (dexpr, *index) == pc)
+    return &dexpr->insns[*index];
+
+  lo = 0;
+  hi = dexpr->num_targets;
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+
+      if (dexpr->targets[mid].offset < pc)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  if (lo < dexpr->num_targets && dexpr->targets[lo].offset == pc)
+    {
+      *index = dexpr->targets[lo].index;
+      return &dexpr->insns[*index];
+    }
+
+  return NULL;
+}
+
+#ifndef IN_PROCESS_AGENT
+
+/* See ax.h.  */
+
+struct decoded_agent_expr *
+gdb_decode_agent_expr (struct agent_expr *aexpr)
+{
+  struct decoded_agent_expr *dexpr;
+  struct agent_insn insn;
+  unsigned char *is_target;
+  int pc, i;
+
+  dexpr = xcalloc (1, sizeof (*dexpr));
+
+  /* Count the bytecodes first, so that they can be stored without
+     wasting space.  A truncated bytecode (one with a zero opcode)
+     ends the expression.  */
+  for (pc = 0; pc < aexpr->length; pc = insn.next)
+    {
+      decode_agent_insn (aexpr, pc, &insn);
+      dexpr->num_insns++;
+      if (insn.op == 0)
+	break;
+    }
+
+  dexpr->insns = xmalloc (dexpr->num_insns * sizeof (*dexpr->insns));
+  is_target = xcalloc (aexpr->length > 0 ? aexpr->length : 1, 1);
+
+  for (i = 0, pc = 0; i < dexpr->num_insns; i++)
+    {
+      decode_agent_insn (aexpr, pc, &dexpr->insns[i]);
+      pc = dexpr->insns[i].next;
+
+      if ((dexpr->insns[i].op == gdb_agent_op_goto
+	   || dexpr->insns[i].op == gdb_agent_op_if_goto)
+	  && dexpr->insns[i].arg < aexpr->length)
+	is_target[dexpr->insns[i].arg] = 1;
+    }
+
+  /* Walking the bytecodes in order gives the targets sorted.  */
+  for (i = 0; i < dexpr->num_insns; i++)
+    if (is_target[decoded_insn_offset (dexpr, i)])
+      dexpr->num_targets++;
+
+  dexpr->targets = xmalloc (dexpr->num_targets * sizeof (*dexpr->targets));
+  dexpr->num_targets = 0;
+  for (i = 0; i < dexpr->num_insns; i++)
+    if (is_target[decoded_insn_offset (dexpr, i)])
+      {
+	dexpr->targets[dexpr->num_targets].offset
+	  = decoded_insn_offset (dexpr, i);
+	dexpr->targets[dexpr->num_targets].index = i;
+	dexpr->num_targets++;
+      }
+
+  free (is_target);
+  return dexpr;
+}
+
+/* See ax.h.  */
+
+void
+gdb_free_decoded_agent_expr (struct decoded_agent_expr *dexpr)
+{
+  if (dexpr == NULL)
+    return;
+
+  free (dexpr->insns);
+  free (dexpr->targets);
+  free (dexpr);
+}
+
+#endif
+
+/* The agent expression evaluator, as specified by the GDB docs.  If
+   DEXPR is not NULL, it holds the bytecodes of AEXPR decoded by
+   gdb_decode_agent_expr; otherwise, the bytecodes are decoded as
+   they are evaluated.  It returns 0 if everything went OK, and a
+   nonzero error code otherwise.  */
+
+static enum eval_result_type
+eval_agent_expr_1 (struct eval_agent_expr_context *ctx,
+		   struct agent_expr *aexpr,
+		   const struct decoded_agent_expr *dexpr,
+		   ULONGEST *rslt)
 {
   int pc = 0;
+  int index = 0;
 #define STACK_MAX 100
   ULONGEST stack[STACK_MAX], top;
   int sp = 0;
   unsigned char op;
   int arg;
+  const struct agent_insn *insn;
+  struct agent_insn decoded;
 
   /* This union is a convenient way to convert representations.  For
      now, assume a standard architecture where the hardware integer
@@ -967,7 +1199,19 @@ gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
 
   while (1)
     {
-      op = aexpr->bytes[pc++];
+      insn = NULL;
+      if (dexpr != NULL)
+	insn = decoded_insn_at (dexpr, pc, &index);
+      if (insn == NULL)
+	{
+	  decode_agent_insn (aexpr, pc, &decoded);
+	  insn = &decoded;
+	  index = -1;
+	}
+      else
+	index++;
+      op = insn->op;
+      pc = insn->next;
 
       ax_debug ("About to interpret byte 0x%x", op);
 
@@ -1041,7 +1285,7 @@ gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
 	  break;
 
 	case gdb_agent_op_trace_quick:
-	  arg = aexpr->bytes[pc++];
+	  arg = insn->arg;
 	  agent_mem_read (ctx, NULL, (CORE_ADDR) top, (ULONGEST) arg);
 	  break;
 
@@ -1078,7 +1322,7 @@ gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
 	  break;
 
 	case gdb_agent_op_ext:
-	  arg = aexpr->bytes[pc++];
+	  arg = insn->arg;
 	  if (arg < (sizeof (LONGEST) * 8))
 	    {
 	      LONGEST mask = 1 << (arg - 1);
@@ -1109,57 +1353,28 @@ gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
 
 	case gdb_agent_op_if_goto:
 	  if (top)
-	    pc = (aexpr->bytes[pc] << 8) + (aexpr->bytes[pc + 1]);
-	  else
-	    pc += 2;
+	    pc = insn->arg;
 	  if (--sp >= 0)
 	    top = stack[sp];
 	  break;
 
 	case gdb_agent_op_goto:
-	  pc = (aexpr->bytes[pc] << 8) + (aexpr->bytes[pc + 1]);
+	  pc = insn->arg;
 	  break;
 
 	case gdb_agent_op_const8:
-	  /* Flush the cached stack top.  */
-	  stack[sp++] = top;
-	  top = aexpr->bytes[pc++];
-	  break;
-
 	case gdb_agent_op_const16:
-	  /* Flush the cached stack top.  */
-	  stack[sp++] = top;
-	  top = aexpr->bytes[pc++];
-	  top = (top << 8) + aexpr->bytes[pc++];
-	  break;
-
 	case gdb_agent_op_const32:
-	  /* Flush the cached stack top.  */
-	  stack[sp++] = top;
-	  top = aexpr->bytes[pc++];
-	  top = (top << 8) + aexpr->bytes[pc++];
-	  top = (top << 8) + aexpr->bytes[pc++];
-	  top = (top << 8) + aexpr->bytes[pc++];
-	  break;
-
 	case gdb_agent_op_const64:
 	  /* Flush the cached stack top.  */
 	  stack[sp++] = top;
-	  top = aexpr->bytes[pc++];
-	  top = (top << 8) + aexpr->bytes[pc++];
-	  top = (top << 8) + aexpr->bytes[pc++];
-	  top = (top << 8) + aexpr->bytes[pc++];
-	  top = (top << 8) + aexpr->bytes[pc++];
-	  top = (top << 8) + aexpr->bytes[pc++];
-	  top = (top << 8) + aexpr->bytes[pc++];
-	  top = (top << 8) + aexpr->bytes[pc++];
+	  top = insn->value;
 	  break;
 
 	case gdb_agent_op_reg:
 	  /* Flush the cached stack top.  */
 	  stack[sp++] = top;
-	  arg = aexpr->bytes[pc++];
-	  arg = (arg << 8) + aexpr->bytes[pc++];
+	  arg = insn->arg;
 	  {
 	    int regnum = arg;
 	    struct regcache *regcache = ctx->regcache;
@@ -1214,7 +1429,7 @@ gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
 	  break;
 
 	case gdb_agent_op_pick:
-	  arg = aexpr->bytes[pc++];
+	  arg = insn->arg;
 	  stack[sp] = top;
 	  top = stack[sp - arg];
 	  ++sp;
@@ -1231,7 +1446,7 @@ gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
 	  break;
 
 	case gdb_agent_op_zero_ext:
-	  arg = aexpr->bytes[pc++];
+	  arg = insn->arg;
 	  if (arg < (sizeof (LONGEST) * 8))
 	    top &= ((LONGEST) 1 << arg) - 1;
 	  break;
@@ -1247,22 +1462,19 @@ gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
 	case gdb_agent_op_getv:
 	  /* Flush the cached stack top.  */
 	  stack[sp++] = top;
-	  arg = aexpr->bytes[pc++];
-	  arg = (arg << 8) + aexpr->bytes[pc++];
+	  arg = insn->arg;
 	  top = agent_get_trace_state_variable_value (arg);
 	  break;
 
 	case gdb_agent_op_setv:
-	  arg = aexpr->bytes[pc++];
-	  arg = (arg << 8) + aexpr->bytes[pc++];
+	  arg = insn->arg;
 	  agent_set_trace_state_variable_value (arg, top);
 	  /* Note that we leave the value on the stack, for the
 	     benefit of later/enclosing expressions.  */
 	  break;
 
 	case gdb_agent_op_tracev:
-	  arg = aexpr->bytes[pc++];
-	  arg = (arg << 8) + aexpr->bytes[pc++];
+	  arg = insn->arg;
 	  agent_tsv_read (ctx, arg);
 	  break;
 
@@ -1279,13 +1491,11 @@ gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
 	    CORE_ADDR fn = 0, chan = 0;
 	    /* Can't have more args than the entire size of the stack.  */
 	    ULONGEST args[STACK_MAX];
-	    char *format;
+	    const char *format;
 
-	    nargs = aexpr->bytes[pc++];
-	    slen = aexpr->bytes[pc++];
-	    slen = (slen << 8) + aexpr->bytes[pc++];
-	    format = (char *) &(aexpr->bytes[pc]);
-	    pc += slen;
+	    nargs = insn->arg;
+	    slen = insn->value;
+	    format = insn->format;
 	    /* Pop function and channel.  */
 	    fn = top;
 	    if (--sp >= 0)
@@ -1347,3 +1557,28 @@ gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
 		gdb_agent_op_name (op), sp, phex_nz (top, 0));
     }
 }
+
+/* See ax.h.  */
+
+enum eval_result_type
+gdb_eval_agent_expr (struct eval_agent_expr_context *ctx,
+		     struct agent_expr *aexpr,
+		     ULONGEST *rslt)
+{
+  return eval_agent_expr_1 (ctx, aexpr, NULL, rslt);
+}
+
+#ifndef IN_PROCESS_AGENT
+
+/* See ax.h.  */
+
+enum eval_result_type
+gdb_eval_decoded_agent_expr (struct eval_agent_expr_context *ctx,
+			     struct agent_expr *aexpr,
+			     const struct decoded_agent_expr *dexpr,
+			     ULONGEST *rslt)
+{
+  return eval_agent_expr_1 (ctx, aexpr, dexpr, rslt);
+}
+
+#endif
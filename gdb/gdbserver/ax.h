@@ -84,6 +84,31 @@ enum eval_result_type
 		       struct agent_expr *aexpr,
 		       ULONGEST *rslt);
 
+#ifndef IN_PROCESS_AGENT
+
+struct decoded_agent_expr;
+
+/* Decode the bytecodes of AEXPR ahead of time, for expressions that
+   are evaluated many times, like breakpoint conditions.  This
+   allocates the result, which refers to AEXPR's bytes; callers
+   should free it with gdb_free_decoded_agent_expr when they free
+   AEXPR.  */
+struct decoded_agent_expr *gdb_decode_agent_expr (struct agent_expr *aexpr);
+
+/* Free DEXPR, a result of gdb_decode_agent_expr.  */
+void gdb_free_decoded_agent_expr (struct decoded_agent_expr *dexpr);
+
+/* Like gdb_eval_agent_expr, but use DEXPR, the result of
+   gdb_decode_agent_expr for AEXPR, instead of decoding the bytecodes
+   of AEXPR again.  */
+enum eval_result_type
+  gdb_eval_decoded_agent_expr (struct eval_agent_expr_context *ctx,
+			       struct agent_expr *aexpr,
+			       const struct decoded_agent_expr *dexpr,
+			       ULONGEST *rslt);
+
+#endif
+
 /* Bytecode compilation function vector.  */
 
 struct emit_ops
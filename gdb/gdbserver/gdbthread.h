@@ -79,6 +79,24 @@ struct thread_info *add_thread (ptid_t ptid, void *target_data);
 struct thread_info *get_first_thread (void);
 
 struct thread_info *find_thread_ptid (ptid_t ptid);
+struct thread_info *find_thread_lwp (long lwp);
+
+/* Incremented each time a thread is added to or removed from
+   ALL_THREADS.  */
+extern ULONGEST thread_list_generation;
+
+/* Return nonzero if the thread list changes since generation GEN are
+   still known.  */
+int thread_changes_known_p (ULONGEST gen);
+
+/* Call CALLBACK with DATA for each thread added to or removed from
+   ALL_THREADS since generation GEN, in the order that happened.  The
+   arguments of CALLBACK are the thread's id as GDB knows it, and
+   whether the thread was added.  The changes since GEN must be
+   known.  */
+void for_each_thread_change (ULONGEST gen,
+			     void (*callback) (ptid_t, int, void *),
+			     void *data);
 
 /* Get current thread ID (Linux task ID).  */
 #define current_ptid (current_inferior->entry.id)
@@ -23,6 +23,7 @@
 #include "server.h"
 #include "gdbthread.h"
 #include "dll.h"
+#include "hashtab.h"
 
 struct inferior_list all_processes;
 struct inferior_list all_threads;
@@ -31,6 +32,98 @@ struct thread_info *current_inferior;
 
 #define get_thread(inf) ((struct thread_info *)(inf))
 
+/* Index of ALL_THREADS by thread id, so that looking up the thread of
+   an event doesn't walk the whole list.  Threads are hashed on their
+   LWP, or on their PID if the id has no LWP, so that they can also be
+   found by LWP alone.  */
+static htab_t thread_id_htab;
+
+/* How many thread list changes to remember, so that GDB can read
+   just the changes since the thread list it last read.  */
+#define THREAD_CHANGE_LOG_SIZE 1024
+
+/* A thread added to or removed from ALL_THREADS.  ID is the thread's
+   id as GDB knows it.  */
+
+struct thread_change
+{
+  ptid_t id;
+  int added;
+};
+
+ULONGEST thread_list_generation;
+
+/* The last THREAD_CHANGE_LOG_SIZE thread list changes.  The change
+   that made generation GEN is at GEN % THREAD_CHANGE_LOG_SIZE.  */
+static struct thread_change thread_change_log[THREAD_CHANGE_LOG_SIZE];
+
+/* The oldest generation the changes since are in THREAD_CHANGE_LOG,
+   if not pushed out since.  Changes not logged one by one, like
+   clear_inferiors', move it forward.  */
+static ULONGEST thread_change_log_start;
+
+/* The key used to look up THREAD_ID_HTAB.  If LWP_ONLY is set, match
+   any thread whose LWP is that of ID.  */
+
+struct thread_id_key
+{
+  ptid_t id;
+  int lwp_only;
+};
+
+/* Return the hash of thread id ID in THREAD_ID_HTAB.  */
+
+static hashval_t
+thread_id_hash (ptid_t id)
+{
+  long lwp = ptid_get_lwp (id);
+
+  return lwp != 0 ? lwp : ptid_get_pid (id);
+}
+
+/* Hash function for THREAD_ID_HTAB.  */
+
+static hashval_t
+hash_thread_entry (const void *item)
+{
+  const struct thread_info *thread = item;
+
+  return thread_id_hash (thread->entry.id);
+}
+
+/* Equality function for THREAD_ID_HTAB, comparing a thread with a
+   struct thread_id_key.  */
+
+static int
+eq_thread_entry (const void *item, const void *key_ptr)
+{
+  const struct thread_info *thread = item;
+  const struct thread_id_key *key = key_ptr;
+
+  if (key->lwp_only)
+    return ptid_get_lwp (thread->entry.id) == ptid_get_lwp (key->id);
+  return ptid_equal (thread->entry.id, key->id);
+}
+
+/* Return the slot of THREAD_ID_HTAB matching KEY, or NULL if there is
+   no such slot and INSERT is NO_INSERT.  */
+
+static void **
+thread_id_slot (const struct thread_id_key *key, enum insert_option insert)
+{
+  if (thread_id_htab == NULL)
+    {
+      if (insert == NO_INSERT)
+	return NULL;
+      thread_id_htab = htab_create_alloc (13, hash_thread_entry,
+					  eq_thread_entry, NULL,
+					  xcalloc, free);
+    }
+
+  return htab_find_slot_with_hash (thread_id_htab, key,
+				   thread_id_hash (key->id), insert);
+}
+
 void
 add_inferior_to_list (struct inferior_list *list,
 		      struct inferior_list_entry *new_inferior)
@@ -104,10 +197,26 @@ remove_inferior (struct inferior_list *list,
     list->tail = *cur;
 }
 
+/* Record that THREAD is being added to ALL_THREADS if ADDED is
+   nonzero, or removed from it otherwise.  */
+
+static void
+log_thread_change (struct thread_info *thread, int added)
+{
+  struct thread_change *change;
+
+  thread_list_generation++;
+  change = &thread_change_log[thread_list_generation
+			      % THREAD_CHANGE_LOG_SIZE];
+  change->id = thread_to_gdb_id (thread);
+  change->added = added;
+}
+
 struct thread_info *
 add_thread (ptid_t thread_id, void *target_data)
 {
   struct thread_info *new_thread = xmalloc (sizeof (*new_thread));
+  struct thread_id_key key;
 
   memset (new_thread, 0, sizeof (*new_thread));
 
@@ -116,12 +225,17 @@ add_thread (ptid_t thread_id, void *target_data)
   new_thread->last_status.kind = TARGET_WAITKIND_IGNORE;
 
   add_inferior_to_list (&all_threads, &new_thread->entry);
+  key.id = thread_id;
+  key.lwp_only = 0;
+  *thread_id_slot (&key, INSERT) = new_thread;
 
   if (current_inferior == NULL)
     current_inferior = new_thread;
 
   new_thread->target_data = target_data;
 
+  log_thread_change (new_thread, 1);
+
   return new_thread;
 }
 
@@ -142,7 +256,27 @@ get_first_thread (void)
 struct thread_info *
 find_thread_ptid (ptid_t ptid)
 {
-  return (struct thread_info *) find_inferior_id (&all_threads, ptid);
+  struct thread_id_key key;
+  void **slot;
+
+  key.id = ptid;
+  key.lwp_only = 0;
+  slot = thread_id_slot (&key, NO_INSERT);
+  return slot != NULL ? *slot : NULL;
+}
+
+/* Find the thread whose id has LWP as its lwp, whatever its process.  */
+
+struct thread_info *
+find_thread_lwp (long lwp)
+{
+  struct thread_id_key key;
+  void **slot;
+
+  key.id = ptid_build (0, lwp, 0);
+  key.lwp_only = 1;
+  slot = thread_id_slot (&key, NO_INSERT);
+  return slot != NULL ? *slot : NULL;
 }
 
 ptid_t
@@ -164,13 +298,52 @@ free_one_thread (struct inferior_list_entry *inf)
 void
 remove_thread (struct thread_info *thread)
 {
+  struct thread_id_key key;
+  void **slot;
+
   if (thread->btrace != NULL)
     target_disable_btrace (thread->btrace);
 
+  key.id = thread->entry.id;
+  key.lwp_only = 0;
+  slot = thread_id_slot (&key, NO_INSERT);
+  if (slot != NULL && *slot == thread)
+    htab_clear_slot (thread_id_htab, slot);
+
+  log_thread_change (thread, 0);
+
   remove_inferior (&all_threads, (struct inferior_list_entry *) thread);
   free_one_thread (&thread->entry);
 }
 
+/* See gdbthread.h.  */
+
+int
+thread_changes_known_p (ULONGEST gen)
+{
+  return (gen >= thread_change_log_start
+	  && gen <= thread_list_generation
+	  && thread_list_generation - gen <= THREAD_CHANGE_LOG_SIZE);
+}
+
+/* See gdbthread.h.  */
+
+void
+for_each_thread_change (ULONGEST gen,
+			void (*callback) (ptid_t, int, void *),
+			void *data)
+{
+  gdb_assert (thread_changes_known_p (gen));
+
+  while (gen++ < thread_list_generation)
+    {
+      struct thread_change *change
+	= &thread_change_log[gen % THREAD_CHANGE_LOG_SIZE];
+
+      callback (change->id, change->added, data);
+    }
+}
+
 /* Return a pointer to the first inferior in LIST, or NULL if there isn't one.
    This is for cases where the caller needs a thread, but doesn't care
    which one.  */
@@ -210,6 +383,9 @@ find_inferior_id (struct inferior_list *list, ptid_t id)
 {
   struct inferior_list_entry *inf = list->head;
 
+  if (list == &all_threads)
+    return (struct inferior_list_entry *) find_thread_ptid (id);
+
   while (inf != NULL)
     {
       if (ptid_equal (inf->id, id))
@@ -266,6 +442,11 @@ clear_inferiors (void)
 {
   for_each_inferior (&all_threads, free_one_thread);
   clear_inferior_list (&all_threads);
+  if (thread_id_htab != NULL)
+    htab_empty (thread_id_htab);
+
+  thread_list_generation++;
+  thread_change_log_start = thread_list_generation;
 
   clear_dlls ();
 
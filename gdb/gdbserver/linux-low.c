@@ -224,6 +224,7 @@ static void proceed_all_lwps (void);
 static int finish_step_over (struct lwp_info *lwp);
 static CORE_ADDR get_stop_pc (struct lwp_info *lwp);
 static int kill_lwp (unsigned long lwpid, int signo);
+static void linux_proc_mem_file_close (int pid);
 
 /* True if the low target can hardware single-step.  Such targets
    don't need a BREAKPOINT_REINSERT_ADDR callback.  */
@@ -342,6 +343,7 @@ delete_lwp (struct lwp_info *lwp)
   if (debug_threads)
     debug_printf ("deleting %ld\n", lwpid_of (thr));
 
+  linux_proc_mem_file_close (lwpid_of (thr));
   remove_thread (thr);
   free (lwp->arch_private);
   free (lwp);
@@ -1238,33 +1240,22 @@ status_pending_p_callback (struct inferior_list_entry *entry, void *arg)
   return lwp->status_pending_p;
 }
 
-static int
-same_lwp (struct inferior_list_entry *entry, void *data)
+struct lwp_info *
+find_lwp_pid (ptid_t ptid)
 {
-  ptid_t ptid = *(ptid_t *) data;
-  int lwp;
+  struct thread_info *thread;
+  long lwp;
 
   if (ptid_get_lwp (ptid) != 0)
     lwp = ptid_get_lwp (ptid);
   else
     lwp = ptid_get_pid (ptid);
 
-  if (ptid_get_lwp (entry->id) == lwp)
-    return 1;
-
-  return 0;
-}
-
-struct lwp_info *
-find_lwp_pid (ptid_t ptid)
-{
-  struct inferior_list_entry *thread
-    = find_inferior (&all_threads, same_lwp, &ptid);
-
+  thread = find_thread_lwp (lwp);
   if (thread == NULL)
     return NULL;
 
-  return get_thread_lwp ((struct thread_info *) thread);
+  return get_thread_lwp (thread);
 }
 
 /* Return the number of known LWPs in the tgid given by PID.  */
@@ -4616,46 +4607,140 @@ linux_store_registers (struct regcache *regcache, int regno)
 }
 
 
-/* Copy LEN bytes from inferior's memory starting at MEMADDR
-   to debugger memory starting at MYADDR.  */
+/* The /proc/PID/mem file of the LWP whose memory we last read through
+   the /proc filesystem, kept open to save opening it for every read,
+   or -1.  The file refers to the address space the LWP had when it
+   was opened, so it has to be closed when the LWP goes away.  */
+
+static int proc_mem_file = -1;
+
+/* The LWP PROC_MEM_FILE belongs to.  */
+
+static int proc_mem_file_pid;
+
+/* Close PROC_MEM_FILE if it belongs to PID.  */
+
+static void
+linux_proc_mem_file_close (int pid)
+{
+  if (proc_mem_file != -1 && pid == proc_mem_file_pid)
+    {
+      close (proc_mem_file);
+      proc_mem_file = -1;
+    }
+}
+
+/* Read LEN bytes at MEMADDR from the /proc/PID/mem file into MYADDR.
+   Return the number of bytes read, or -1 on error.  If the cached
+   file fails, try again with a freshly opened one, in case the
+   process has exec'd since.  */
 
 static int
-linux_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
+linux_proc_mem_pread (int pid, CORE_ADDR memaddr, unsigned char *myaddr,
+		      int len)
 {
-  int pid = lwpid_of (current_inferior);
-  register PTRACE_XFER_TYPE *buffer;
-  register CORE_ADDR addr;
-  register int count;
-  char filename[64];
-  register int i;
-  int ret;
-  int fd;
+  int attempt;
 
-  /* Try using /proc.  Don't bother for one word.  */
-  if (len >= 3 * sizeof (long))
+  for (attempt = 0; attempt < 2; attempt++)
     {
       int bytes;
 
-      /* We could keep this file open and cache it - possibly one per
-	 thread.  That requires some juggling, but is even faster.  */
-      sprintf (filename, "/proc/%d/mem", pid);
-      fd = open (filename, O_RDONLY | O_LARGEFILE);
-      if (fd == -1)
-	goto no_proc;
+      if (proc_mem_file == -1 || proc_mem_file_pid != pid)
+	{
+	  char filename[64];
+
+	  linux_proc_mem_file_close (proc_mem_file_pid);
+	  sprintf (filename, "/proc/%d/mem", pid);
+	  proc_mem_file = open (filename, O_RDONLY | O_LARGEFILE);
+	  if (proc_mem_file == -1)
+	    return -1;
+	  proc_mem_file_pid = pid;
+	}
 
       /* If pread64 is available, use it.  It's faster if the kernel
 	 supports it (only one syscall), and it's 64-bit safe even on
 	 32-bit platforms (for instance, SPARC debugging a SPARC64
 	 application).  */
 #ifdef HAVE_PREAD64
-      bytes = pread64 (fd, myaddr, len, memaddr);
+      bytes = pread64 (proc_mem_file, myaddr, len, memaddr);
 #else
       bytes = -1;
-      if (lseek (fd, memaddr, SEEK_SET) != -1)
-	bytes = read (fd, myaddr, len);
+      if (lseek (proc_mem_file, memaddr, SEEK_SET) != -1)
+	bytes = read (proc_mem_file, myaddr, len);
 #endif
+      if (bytes > 0)
+	return bytes;
 
-      close (fd);
+      linux_proc_mem_file_close (pid);
+    }
+
+  return -1;
+}
+
+/* Whether the process_vm_readv and process_vm_writev system calls
+   work.  Cleared the first time the kernel says it doesn't have
+   them.  */
+
+static int have_process_vm = 1;
+
+/* Transfer LEN bytes at MEMADDR in the address space of process PID to
+   READBUF, or from WRITEBUF, with process_vm_readv or
+   process_vm_writev, which copy the memory without going through a
+   file.  Return the number of bytes transferred, or -1 on error.  */
+
+static int
+linux_process_vm_xfer (int pid, CORE_ADDR memaddr, unsigned char *readbuf,
+		       const unsigned char *writebuf, int len)
+{
+#if defined (__NR_process_vm_readv) && defined (__NR_process_vm_writev)
+  struct iovec local, remote;
+  int ret;
+
+  /* The remote address has to fit in a host pointer.  */
+  if (!have_process_vm || (uintptr_t) memaddr != memaddr)
+    return -1;
+
+  local.iov_base = readbuf != NULL ? (void *) readbuf : (void *) writebuf;
+  local.iov_len = len;
+  remote.iov_base = (void *) (uintptr_t) memaddr;
+  remote.iov_len = len;
+
+  if (readbuf != NULL)
+    ret = syscall (__NR_process_vm_readv, pid, &local, 1, &remote, 1, 0);
+  else
+    ret = syscall (__NR_process_vm_writev, pid, &local, 1, &remote, 1, 0);
+
+  if (ret == -1 && errno == ENOSYS)
+    have_process_vm = 0;
+
+  return ret;
+#else
+  return -1;
+#endif
+}
+
+/* Copy LEN bytes from inferior's memory starting at MEMADDR
+   to debugger memory starting at MYADDR.  */
+
+static int
+linux_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
+{
+  int pid = lwpid_of (current_inferior);
+  register PTRACE_XFER_TYPE *buffer;
+  register CORE_ADDR addr;
+  register int count;
+  register int i;
+  int ret;
+
+  /* Try using process_vm_readv, and then /proc.  Don't bother for one
+     word.  */
+  if (len >= 3 * sizeof (long))
+    {
+      int bytes;
+
+      bytes = linux_process_vm_xfer (pid, memaddr, myaddr, NULL, len);
+      if (bytes <= 0)
+	bytes = linux_proc_mem_pread (pid, memaddr, myaddr, len);
       if (bytes == len)
 	return 0;
 
@@ -4668,7 +4753,6 @@ linux_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
 	}
     }
 
- no_proc:
   /* Round starting address down to longword boundary.  */
   addr = memaddr & -(CORE_ADDR) sizeof (PTRACE_XFER_TYPE);
   /* Round ending address up; get number of longwords that makes.  */
@@ -4745,6 +4829,13 @@ linux_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
 		    val, (long)memaddr);
     }
 
+  /* Try using process_vm_writev.  It can't write to read-only
+     memory, such as the program's text, so fall back to ptrace if it
+     doesn't write everything.  Don't bother for one word.  */
+  if (len >= 3 * sizeof (long)
+      && linux_process_vm_xfer (pid, memaddr, NULL, myaddr, len) == len)
+    return 0;
+
   /* Fill start and end extra bytes of buffer with existing memory data.  */
 
   errno = 0;
@@ -93,6 +93,9 @@ struct point_cond_list
      conditional.  */
   struct agent_expr *cond;
 
+  /* COND, decoded by gdb_decode_agent_expr.  */
+  struct decoded_agent_expr *cond_decoded;
+
   /* Pointer to the next condition.  */
   struct point_cond_list *next;
 };
@@ -103,6 +106,9 @@ struct point_command_list
      commands.  */
   struct agent_expr *cmd;
 
+  /* CMD, decoded by gdb_decode_agent_expr.  */
+  struct decoded_agent_expr *cmd_decoded;
+
   /* Flag that is true if this command should run even while GDB is
      disconnected.  */
   int persistence;
@@ -767,6 +773,7 @@ clear_gdb_breakpoint_conditions (CORE_ADDR addr)
       struct point_cond_list *cond_next;
 
       cond_next = cond->next;
+      gdb_free_decoded_agent_expr (cond->cond_decoded);
       free (cond->cond->bytes);
       free (cond->cond);
       free (cond);
@@ -787,6 +794,7 @@ add_condition_to_breakpoint (struct breakpoint *bp,
   /* Create new condition.  */
   new_cond = xcalloc (1, sizeof (*new_cond));
   new_cond->cond = condition;
+  new_cond->cond_decoded = gdb_decode_agent_expr (condition);
 
   /* Add condition to the list.  */
   new_cond->next = bp->cond_list;
@@ -858,7 +866,8 @@ gdb_condition_true_at_breakpoint (CORE_ADDR where)
        cl && !value && !err; cl = cl->next)
     {
       /* Evaluate the condition.  */
-      err = gdb_eval_agent_expr (&ctx, cl->cond, &value);
+      err = gdb_eval_decoded_agent_expr (&ctx, cl->cond, cl->cond_decoded,
+					 &value);
     }
 
   if (err)
@@ -878,6 +887,7 @@ add_commands_to_breakpoint (struct breakpoint *bp,
   /* Create new command.  */
   new_cmd = xcalloc (1, sizeof (*new_cmd));
   new_cmd->cmd = commands;
+  new_cmd->cmd_decoded = gdb_decode_agent_expr (commands);
   new_cmd->persistence = persist;
 
   /* Add commands to the list.  */
@@ -954,7 +964,8 @@ run_breakpoint_commands (CORE_ADDR where)
        cl && !value && !err; cl = cl->next)
     {
       /* Run the command.  */
-      err = gdb_eval_agent_expr (&ctx, cl->cmd, &value);
+      err = gdb_eval_decoded_agent_expr (&ctx, cl->cmd, cl->cmd_decoded,
+					 &value);
 
       /* If one command has a problem, stop digging the hole deeper.  */
       if (err)
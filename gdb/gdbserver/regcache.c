@@ -60,6 +60,7 @@ get_thread_regcache (struct thread_info *thread, int fetch)
       fetch_inferior_registers (regcache, -1);
       current_inferior = saved_inferior;
       regcache->registers_valid = 1;
+      regcache->registers_dirty = 0;
     }
 
   return regcache;
@@ -75,7 +76,7 @@ regcache_invalidate_thread (struct thread_info *thread)
   if (regcache == NULL)
     return;
 
-  if (regcache->registers_valid)
+  if (regcache->registers_valid && regcache->registers_dirty)
     {
       struct thread_info *saved_inferior = current_inferior;
 
@@ -85,6 +86,7 @@ regcache_invalidate_thread (struct thread_info *thread)
     }
 
   regcache->registers_valid = 0;
+  regcache->registers_dirty = 0;
 }
 
 static int
@@ -146,6 +148,9 @@ init_register_cache (struct regcache *regcache,
     }
 
   regcache->registers_valid = 0;
+#ifndef IN_PROCESS_AGENT
+  regcache->registers_dirty = 0;
+#endif
 
   return regcache;
 }
@@ -189,6 +194,7 @@ regcache_cpy (struct regcache *dst, struct regcache *src)
   if (dst->register_status != NULL && src->register_status != NULL)
     memcpy (dst->register_status, src->register_status,
 	    src->tdesc->num_registers);
+  dst->registers_dirty = 1;
 #endif
   dst->registers_valid = src->registers_valid;
 }
@@ -235,6 +241,7 @@ registers_from_string (struct regcache *regcache, char *buf)
 	len = tdesc->registers_size * 2;
     }
   hex2bin (buf, registers, len / 2);
+  regcache->registers_dirty = 1;
 }
 
 struct reg *
@@ -332,6 +339,7 @@ supply_register (struct regcache *regcache, int n, const void *buf)
 #ifndef IN_PROCESS_AGENT
       if (regcache->register_status != NULL)
 	regcache->register_status[n] = REG_VALID;
+      regcache->registers_dirty = 1;
 #endif
     }
   else
@@ -341,6 +349,7 @@ supply_register (struct regcache *regcache, int n, const void *buf)
 #ifndef IN_PROCESS_AGENT
       if (regcache->register_status != NULL)
 	regcache->register_status[n] = REG_UNAVAILABLE;
+      regcache->registers_dirty = 1;
 #endif
     }
 }
@@ -355,6 +364,7 @@ supply_register_zeroed (struct regcache *regcache, int n)
 #ifndef IN_PROCESS_AGENT
   if (regcache->register_status != NULL)
     regcache->register_status[n] = REG_VALID;
+  regcache->registers_dirty = 1;
 #endif
 }
 
@@ -376,6 +386,7 @@ supply_regblock (struct regcache *regcache, const void *buf)
 
 	for (i = 0; i < tdesc->num_registers; i++)
 	  regcache->register_status[i] = REG_VALID;
+	regcache->registers_dirty = 1;
       }
 #endif
     }
@@ -390,6 +401,7 @@ supply_regblock (struct regcache *regcache, const void *buf)
 
 	for (i = 0; i < tdesc->num_registers; i++)
 	  regcache->register_status[i] = REG_UNAVAILABLE;
+	regcache->registers_dirty = 1;
       }
 #endif
     }
@@ -49,6 +49,12 @@ struct regcache
 #ifndef IN_PROCESS_AGENT
   /* One of REG_UNAVAILBLE or REG_VALID.  */
   unsigned char *register_status;
+
+  /* Whether the REGISTERS buffer was written to since it was fetched
+     from the target.  Only then does it need to be stored back when
+     the regcache is invalidated; evaluating a breakpoint condition,
+     say, only reads the registers.  */
+  int registers_dirty;
 #endif
 };
 
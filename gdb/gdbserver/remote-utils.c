@@ -122,6 +122,20 @@ int noack_mode = 0;
 /* If true, then we tell GDB to use noack mode by default.  */
 int transport_is_reliable = 0;
 
+/* The streams that compress the packets we send to GDB and
+   decompress the packets GDB sends us, once GDB has asked for packet
+   compression with QCompress.  */
+static struct rsp_zstream *deflate_stream;
+static struct rsp_zstream *inflate_stream;
+
+/* If true, the reply to QCompress has not been sent yet.  That reply
+   is not compressed, and neither is anything before it.  */
+static int compression_pending;
+
+/* The compressed packet being read by getpkt, and its size.  */
+static char *compressed_buf;
+static int compressed_buf_size;
+
 #ifdef USE_WIN32API
 # define read(fd, buf, len) recv (fd, (char *) buf, len, 0)
 # define write(fd, buf, len) send (fd, (char *) buf, len, 0)
@@ -416,6 +430,41 @@ remote_close (void)
   remote_desc = INVALID_DESCRIPTOR;
 
   reset_readchar ();
+  remote_stop_compression ();
+}
+
+/* See remote-utils.h.  */
+
+int
+remote_start_compression (void)
+{
+  if (deflate_stream != NULL)
+    return 0;
+
+  deflate_stream = rsp_zstream_new (1);
+  inflate_stream = rsp_zstream_new (0);
+  if (deflate_stream == NULL || inflate_stream == NULL)
+    {
+      remote_stop_compression ();
+      return 0;
+    }
+
+  compression_pending = 1;
+  return 1;
+}
+
+/* See remote-utils.h.  */
+
+void
+remote_stop_compression (void)
+{
+  if (deflate_stream != NULL)
+    rsp_zstream_free (deflate_stream);
+  if (inflate_stream != NULL)
+    rsp_zstream_free (inflate_stream);
+  deflate_stream = NULL;
+  inflate_stream = NULL;
+  compression_pending = 0;
 }
 
 #endif
@@ -625,6 +674,12 @@ putpkt_binary_1 (char *buf, int cnt, int is_notif)
   char *buf2;
   char *p;
   int cc;
+  int compressed = deflate_stream != NULL && !compression_pending;
+
+  /* What goes on the wire, and what the checksum covers, is the
+     compressed payload.  */
+  if (compressed)
+    buf = rsp_zstream_deflate (deflate_stream, buf, cnt, &cnt);
 
   buf2 = xmalloc (strlen ("$") + cnt + strlen ("#nn") + 1);
 
@@ -657,6 +712,10 @@ putpkt_binary_1 (char *buf, int cnt, int is_notif)
 	  return -1;
 	}
 
+      /* Once the reply to QCompress is out, compress everything.  */
+      if (!is_notif)
+	compression_pending = 0;
+
       if (noack_mode || is_notif)
 	{
 	  /* Don't expect an ack then.  */
@@ -942,8 +1001,19 @@ int
 getpkt (char *buf)
 {
   char *bp;
+  char *frame;
   unsigned char csum, c1, c2;
   int c;
+  int compressed = inflate_stream != NULL && !compression_pending;
+
+  /* A compressed packet can be longer than BUF before it is
+     decompressed, so read it into a buffer of its own.  */
+  if (compressed && compressed_buf == NULL)
+    {
+      compressed_buf_size = PBUFSIZ;
+      compressed_buf = xmalloc (compressed_buf_size);
+    }
+  frame = compressed ? compressed_buf : buf;
 
   while (1)
     {
@@ -964,7 +1034,7 @@ getpkt (char *buf)
 	    return -1;
 	}
 
-      bp = buf;
+      bp = frame;
       while (1)
 	{
 	  c = readchar ();
@@ -972,6 +1042,15 @@ getpkt (char *buf)
 	    return -1;
 	  if (c == '#')
 	    break;
+	  if (compressed && bp - frame >= compressed_buf_size - 1)
+	    {
+	      int len = bp - frame;
+
+	      compressed_buf_size *= 2;
+	      compressed_buf = xrealloc (compressed_buf, compressed_buf_size);
+	      frame = compressed_buf;
+	      bp = frame + len;
+	    }
 	  *bp++ = c;
 	  csum += c;
 	}
@@ -988,17 +1067,32 @@ getpkt (char *buf)
 	  fprintf (stderr,
 		   "Bad checksum, sentsum=0x%x, csum=0x%x, "
 		   "buf=%s [no-ack-mode, Bad medium?]\n",
-		   (c1 << 4) + c2, csum, buf);
+		   (c1 << 4) + c2, csum, frame);
 	  /* Not much we can do, GDB wasn't expecting an ack/nac.  */
 	  break;
 	}
 
       fprintf (stderr, "Bad checksum, sentsum=0x%x, csum=0x%x, buf=%s\n",
-	       (c1 << 4) + c2, csum, buf);
+	       (c1 << 4) + c2, csum, frame);
       if (write_prim ("-", 1) != 1)
 	return -1;
     }
 
+  if (compressed)
+    {
+      char *packet;
+      int len;
+
+      packet = rsp_zstream_inflate (inflate_stream, frame, bp - frame, &len);
+      if (packet == NULL || len > PBUFSIZ)
+	{
+	  fprintf (stderr, "Bad compressed packet from GDB\n");
+	  return -1;
+	}
+      memcpy (buf, packet, len + 1);
+      bp = buf + len;
+    }
+
   if (!noack_mode)
     {
       if (remote_debug)
@@ -1067,6 +1161,69 @@ outreg (struct regcache *regcache, int regno, char *buf)
   return buf;
 }
 
+/* Write the "stack:ADDR,DATA" stop reply field to BUF, with at most
+   SIZE bytes of the stack of the thread whose registers are in
+   REGCACHE, as asked by QStackPrefetch.  ADDR is the stack pointer
+   rounded down to a multiple of 64 bytes, so that the data covers
+   whole lines of GDB's memory cache.  Return the end of the field,
+   or BUF if there is nothing to send.  */
+
+static char *
+outstack (struct regcache *regcache, char *buf, int size)
+{
+  int regno = stack_prefetch_regno;
+  unsigned char *data;
+  CORE_ADDR sp;
+
+  if (regno < 0 || regno >= regcache->tdesc->num_registers)
+    return buf;
+
+  switch (register_size (regcache->tdesc, regno))
+    {
+    case 4:
+      {
+	uint32_t val;
+
+	collect_register (regcache, regno, &val);
+	sp = val;
+	break;
+      }
+    case 8:
+      {
+	uint64_t val;
+
+	collect_register (regcache, regno, &val);
+	sp = val;
+	break;
+      }
+    default:
+      return buf;
+    }
+
+  sp &= ~(CORE_ADDR) 63;
+  size &= ~63;
+  if (size <= 0)
+    return buf;
+
+  /* The stack may end before SIZE bytes from its pointer, so read
+     less if we must.  */
+  data = alloca (size);
+  while (read_inferior_memory (sp, data, size) != 0)
+    {
+      size = (size / 2) & ~63;
+      if (size < 64)
+	return buf;
+    }
+
+  sprintf (buf, "stack:%s,", paddress (sp));
+  buf += strlen (buf);
+  bin2hex (data, buf, size);
+  buf += 2 * size;
+  *buf++ = ';';
+
+  return buf;
+}
+
 void
 new_thread_notify (int id)
 {
@@ -1115,6 +1272,7 @@ prepare_resume_reply (char *buf, ptid_t ptid,
 	struct thread_info *saved_inferior;
 	const char **regp;
 	struct regcache *regcache;
+	char *start = buf;
 
 	sprintf (buf, "T%02x", status->value.sig);
 	buf += strlen (buf);
@@ -1147,10 +1305,35 @@ prepare_resume_reply (char *buf, ptid_t ptid,
 	    *buf++ = ';';
 	  }
 
-	while (*regp)
+	/* Send all the registers if GDB asked for them, unless they
+	   would not leave room in the packet for the rest of the
+	   reply.  GDB only knows all our register numbers if it read
+	   our target description.  */
+	if (expedite_all_registers && gdb_read_target_xml
+	    && (2 * regcache->tdesc->registers_size
+		+ 6 * regcache->tdesc->num_registers) < PBUFSIZ / 2)
 	  {
-	    buf = outreg (regcache, find_regno (regcache->tdesc, *regp), buf);
-	    regp ++;
+	    int i;
+
+	    for (i = 0; i < regcache->tdesc->num_registers; i++)
+	      if (register_size (regcache->tdesc, i) != 0)
+		buf = outreg (regcache, i, buf);
+	  }
+	else
+	  while (*regp)
+	    {
+	      buf = outreg (regcache, find_regno (regcache->tdesc, *regp), buf);
+	      regp ++;
+	    }
+
+	if (stack_prefetch_size > 0)
+	  {
+	    /* Leave room for the rest of the reply.  */
+	    int room = (PBUFSIZ - 512 - (buf - start)) / 2;
+
+	    buf = outstack (regcache, buf,
+			    stack_prefetch_size < room
+			    ? stack_prefetch_size : room);
 	  }
 	*buf = '\0';
 
@@ -38,6 +38,14 @@ int getpkt (char *buf);
 void remote_prepare (char *name);
 void remote_open (char *name);
 void remote_close (void);
+
+/* Start compressing the packets exchanged with GDB, after the next
+   reply.  Return zero if that is not possible.  */
+int remote_start_compression (void);
+
+/* Stop compressing packets.  */
+void remote_stop_compression (void);
+
 void write_ok (char *buf);
 void write_enn (char *buf);
 void initialize_async_io (void);
@@ -61,6 +61,19 @@ static int exit_requested;
 int run_once;
 
 int multi_process;
+
+/* Whether GDB asked for all the registers in stop replies, not only
+   the expedite registers of the target description.  */
+int expedite_all_registers;
+
+/* Whether GDB read our target description, so that it numbers the
+   registers as we do.  */
+int gdb_read_target_xml;
+
+/* The register holding the stack pointer, and how many bytes of the
+   stack to send in stop replies, as set by QStackPrefetch.  */
+int stack_prefetch_regno;
+int stack_prefetch_size;
 int non_stop;
 
 /* Whether we should attempt to disable the operating system's address
@@ -550,6 +563,24 @@ handle_general_set (char *own_buf)
       return;
     }
 
+  if (strcmp (own_buf, "QCompress") == 0)
+    {
+      /* A packet sent again after a NAK would be inflated twice and
+	 corrupt the stream, so compression requires no-ack mode.  */
+      if (noack_mode && remote_start_compression ())
+	{
+	  if (remote_debug)
+	    {
+	      fprintf (stderr, "[packet compression enabled]\n");
+	      fflush (stderr);
+	    }
+	  write_ok (own_buf);
+	}
+      else
+	write_enn (own_buf);
+      return;
+    }
+
   if (strncmp (own_buf, "QNonStop:", 9) == 0)
     {
       char *mode = own_buf + 9;
@@ -608,6 +639,36 @@ handle_general_set (char *own_buf)
       return;
     }
 
+  if (strncmp ("QStackPrefetch:", own_buf,
+	       strlen ("QStackPrefetch:")) == 0)
+    {
+      char *packet = own_buf + strlen ("QStackPrefetch:");
+      ULONGEST regno, size;
+
+      packet = unpack_varlen_hex (packet, &regno);
+      if (*packet++ != ',')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      unpack_varlen_hex (packet, &size);
+
+      /* prepare_resume_reply sends less if the rest of the stop
+	 reply leaves no room for that much.  */
+      stack_prefetch_regno = regno;
+      stack_prefetch_size = size < PBUFSIZ / 2 ? size : PBUFSIZ / 2;
+
+      if (remote_debug)
+	{
+	  fprintf (stderr, "[stack prefetch of %d bytes from register %d]\n",
+		   stack_prefetch_size, stack_prefetch_regno);
+	  fflush (stderr);
+	}
+
+      write_ok (own_buf);
+      return;
+    }
+
   if (target_supports_tracepoints ()
       && handle_tracepoint_general_set (own_buf))
     return;
@@ -1133,6 +1194,10 @@ handle_qxfer_features (const char *annex,
     len = total_len - offset;
 
   memcpy (readbuf, document + offset, len);
+
+  if (strcmp (annex, "target.xml") == 0)
+    gdb_read_target_xml = 1;
+
   return len;
 }
 
@@ -1348,6 +1413,59 @@ handle_qxfer_threads_proper (struct buffer *buffer)
   buffer_grow_str0 (buffer, "</threads>\n");
 }
 
+/* Helper for handle_qxfer_threads_delta.  */
+
+static void
+handle_qxfer_threads_change (ptid_t ptid, int added, void *arg)
+{
+  struct buffer *buffer = arg;
+
+  if (added)
+    {
+      struct thread_info *thread
+	= find_thread_ptid (gdb_id_to_thread_id (ptid));
+
+      /* Don't list threads that are gone already; a later change says
+	 they were removed.  */
+      if (thread != NULL)
+	handle_qxfer_threads_worker (&thread->entry, buffer);
+    }
+  else
+    {
+      char ptid_s[100];
+
+      write_ptid (ptid_s, ptid);
+      buffer_xml_printf (buffer, "<removed id=\"%s\"/>\n", ptid_s);
+    }
+}
+
+/* Helper for handle_qxfer_threads.  GDB has the thread list of
+   generation GEN, or none if GEN is 0.  If we still know the changes
+   since, list only the threads added and removed, in order.
+   Otherwise list all the threads.  Either way, say which generation
+   the list brings GDB to.  */
+
+static void
+handle_qxfer_threads_delta (struct buffer *buffer, ULONGEST gen)
+{
+  if (gen != 0 && thread_changes_known_p (gen))
+    {
+      buffer_xml_printf (buffer, "<threads generation=\"%s\" from=\"%s\">\n",
+			 pulongest (thread_list_generation),
+			 pulongest (gen));
+      for_each_thread_change (gen, handle_qxfer_threads_change, buffer);
+    }
+  else
+    {
+      buffer_xml_printf (buffer, "<threads generation=\"%s\">\n",
+			 pulongest (thread_list_generation));
+      for_each_inferior_with_data (&all_threads, handle_qxfer_threads_worker,
+				   buffer);
+    }
+
+  buffer_grow_str0 (buffer, "</threads>\n");
+}
+
 /* Handle qXfer:threads:read.  */
 
 static int
@@ -1361,12 +1479,23 @@ handle_qxfer_threads (const char *annex,
   if (writebuf != NULL)
     return -2;
 
-  if (!target_running () || annex[0] != '\0')
+  if (!target_running ())
     return -1;
 
   if (offset == 0)
     {
       struct buffer buffer;
+      ULONGEST gen;
+
+      /* A non-empty annex is the generation of the thread list GDB
+	 has.  */
+      if (annex[0] != '\0'
+	  && *unpack_varlen_hex ((char *) annex, &gen) != '\0')
+	{
+	  strcpy (own_buf, "E.Bad annex.");
+	  return -3;
+	}
+
       /* When asked for data at offset 0, generate everything and store into
 	 'result'.  Successive reads will be served off 'result'.  */
       if (result)
@@ -1374,7 +1503,10 @@ handle_qxfer_threads (const char *annex,
 
       buffer_init (&buffer);
 
-      handle_qxfer_threads_proper (&buffer);
+      if (annex[0] != '\0')
+	handle_qxfer_threads_delta (&buffer, gen);
+      else
+	handle_qxfer_threads_proper (&buffer);
 
       result = buffer_finish (&buffer);
       result_length = strlen (result);
@@ -1862,6 +1994,11 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 		  /* GDB supports relocate instruction requests.  */
 		  gdb_supports_qRelocInsn = 1;
 		}
+	      else if (strcmp (p, "expediteAllRegisters+") == 0)
+		{
+		  /* GDB wants all the registers in stop replies.  */
+		  expedite_all_registers = 1;
+		}
 	      else
 		target_process_qsupported (p);
 
@@ -1941,6 +2078,23 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       strcat (own_buf, ";ConditionalBreakpoints+");
       strcat (own_buf, ";BreakpointCommands+");
 
+      strcat (own_buf, ";vReadMemory+");
+
+#ifdef HAVE_ZLIB_H
+      strcat (own_buf, ";QCompress+");
+#endif
+
+      /* We read and process packets in order even if GDB sends more
+	 before we reply.  */
+      strcat (own_buf, ";pipelining+");
+
+      if (expedite_all_registers)
+	strcat (own_buf, ";expediteAllRegisters+");
+
+      strcat (own_buf, ";QStackPrefetch+");
+
+      strcat (own_buf, ";ThreadListDelta+");
+
       if (target_supports_agent ())
 	strcat (own_buf, ";QAgent+");
 
@@ -2544,6 +2698,74 @@ handle_v_kill (char *own_buf)
     }
 }
 
+/* Handle a "vReadMemory" packet: read each of the ranges it lists,
+   and reply with their contents, hex-encoded and separated by
+   semicolons.  Ranges that don't fit in the reply are cut short or
+   dropped.  */
+
+static void
+handle_v_read_memory (char *own_buf)
+{
+  char *request = xstrdup (own_buf + strlen ("vReadMemory:"));
+  unsigned char *mem_buf = xmalloc (PBUFSIZ);
+  char *p = request;
+  char *out = own_buf;
+  int room = PBUFSIZ - 1;
+  int nread = 0;
+  int malformed = 0;
+  int i;
+
+  for (i = 0; *p != '\0'; i++)
+    {
+      ULONGEST addr, len;
+      int res;
+
+      p = unpack_varlen_hex (p, &addr);
+      if (*p != ',')
+	{
+	  malformed = 1;
+	  break;
+	}
+      p = unpack_varlen_hex (p + 1, &len);
+      if (*p == ';')
+	p++;
+      else if (*p != '\0')
+	{
+	  malformed = 1;
+	  break;
+	}
+
+      /* Separate every range from the previous one, even if that one
+	 could not be read, so that GDB can tell which data is whose.  */
+      if (i > 0)
+	{
+	  if (room < 1)
+	    break;
+	  *out++ = ';';
+	  room--;
+	}
+
+      if (len > room / 2)
+	len = room / 2;
+      res = len > 0 ? gdb_read_memory (addr, mem_buf, len) : 0;
+      if (res > 0)
+	{
+	  bin2hex (mem_buf, out, res);
+	  out += 2 * res;
+	  room -= 2 * res;
+	  nread += res;
+	}
+    }
+  *out = '\0';
+
+  /* An empty reply would mean the packet isn't supported.  */
+  if (malformed || nread == 0)
+    write_enn (own_buf);
+
+  free (mem_buf);
+  free (request);
+}
+
 /* Handle all of the extended 'v' packets.  */
 void
 handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
@@ -2609,6 +2831,13 @@ handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
       return;
     }
 
+  if (strncmp (own_buf, "vReadMemory:", 12) == 0)
+    {
+      require_running (own_buf);
+      handle_v_read_memory (own_buf);
+      return;
+    }
+
   if (handle_notif_ack (own_buf, packet_len))
     return;
 
@@ -3269,6 +3498,9 @@ main (int argc, char *argv[])
     {
       noack_mode = 0;
       multi_process = 0;
+      expedite_all_registers = 0;
+      gdb_read_target_xml = 0;
+      stack_prefetch_size = 0;
       /* Be sure we're out of tfind mode.  */
       current_traceframe = -1;
 
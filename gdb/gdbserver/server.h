@@ -124,6 +124,10 @@ extern int disable_packet_qfThreadInfo;
 
 extern int run_once;
 extern int multi_process;
+extern int expedite_all_registers;
+extern int gdb_read_target_xml;
+extern int stack_prefetch_regno;
+extern int stack_prefetch_size;
 extern int non_stop;
 
 extern int disable_randomization;
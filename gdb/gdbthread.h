@@ -136,6 +136,7 @@ struct thread_suspend_state
 
 struct thread_info
 {
+  struct thread_info *prev;
   struct thread_info *next;
   ptid_t ptid;			/* "Actual process id";
 				    In fact, this may be overloaded with 
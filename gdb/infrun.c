@@ -1132,21 +1132,13 @@ struct displaced_step_request
   struct displaced_step_request *next;
 };
 
-/* Per-inferior displaced stepping state.  */
-struct displaced_step_inferior_state
+/* A displaced stepping buffer: a scratch area of the inferior, of
+   gdbarch_max_insn_length bytes, where one thread at a time executes
+   a copy of an instruction.  */
+struct displaced_step_buffer
 {
-  /* Pointer to next in linked list.  */
-  struct displaced_step_inferior_state *next;
-
-  /* The process this displaced step state refers to.  */
-  int pid;
-
-  /* A queue of pending displaced stepping requests.  One entry per
-     thread that needs to do a displaced step.  */
-  struct displaced_step_request *step_request_queue;
-
   /* If this is not null_ptid, this is the thread carrying out a
-     displaced single-step in process PID.  This thread's state will
+     displaced single-step in this buffer.  This thread's state will
      require fixing up once it has completed its step.  */
   ptid_t step_ptid;
 
@@ -1157,14 +1149,59 @@ struct displaced_step_inferior_state
      for post-step cleanup.  */
   struct displaced_step_closure *step_closure;
 
-  /* The address of the original instruction, and the copy we
-     made.  */
+  /* The address of the original instruction, and the copy we made.
+     STEP_COPY is the address of the buffer.  */
   CORE_ADDR step_original, step_copy;
 
-  /* Saved contents of copy area.  */
+  /* Saved contents of the buffer.  */
   gdb_byte *step_saved_copy;
 };
 
+/* Per-inferior displaced stepping state.  */
+struct displaced_step_inferior_state
+{
+  /* Pointer to next in linked list.  */
+  struct displaced_step_inferior_state *next;
+
+  /* The process this displaced step state refers to.  */
+  int pid;
+
+  /* A queue of pending displaced stepping requests.  One entry per
+     thread that needs to do a displaced step.  */
+  struct displaced_step_request *step_request_queue;
+
+  /* The displaced stepping buffers of process PID, and the
+     architecture they were laid out for.  They are laid out again
+     whenever a displaced step starts while none of them is in use,
+     since the scratch area can move, e.g. after an exec.  */
+  int num_buffers;
+  struct displaced_step_buffer *buffers;
+  struct gdbarch *buffers_gdbarch;
+
+  /* The end of the function holding the scratch area at ROOM_BASE,
+     as found for ROOM_GDBARCH, or zero if there is none.  This saves
+     a symbol lookup each time the buffers are laid out.  ROOM_GDBARCH
+     is NULL if it has not been looked up since the symbols last
+     changed.  */
+  struct gdbarch *room_gdbarch;
+  CORE_ADDR room_base;
+  CORE_ADDR room_end;
+};
+
+/* The maximum number of displaced stepping buffers per inferior.  */
+static unsigned int displaced_stepping_buffers = 4;
+
+static void
+show_displaced_stepping_buffers (struct ui_file *file, int from_tty,
+				 struct cmd_list_element *c,
+				 const char *value)
+{
+  fprintf_filtered (file,
+		    _("The maximum number of displaced stepping buffers "
+		      "is %s.\n"),
+		    value);
+}
+
 /* The list of states of processes involved in displaced stepping
    presently.  */
 static struct displaced_step_inferior_state *displaced_step_inferior_states;
@@ -1208,6 +1245,36 @@ add_displaced_stepping_state (int pid)
   return state;
 }
 
+/* Return the buffer of DISPLACED in which thread PTID is displaced
+   stepping, or NULL if it is not.  */
+
+static struct displaced_step_buffer *
+displaced_step_buffer_of_thread
+  (struct displaced_step_inferior_state *displaced, ptid_t ptid)
+{
+  int i;
+
+  for (i = 0; i < displaced->num_buffers; i++)
+    if (ptid_equal (displaced->buffers[i].step_ptid, ptid))
+      return &displaced->buffers[i];
+
+  return NULL;
+}
+
+/* Return non-zero if any thread of DISPLACED is displaced stepping.  */
+
+static int
+displaced_step_in_progress (struct displaced_step_inferior_state *displaced)
+{
+  int i;
+
+  for (i = 0; i < displaced->num_buffers; i++)
+    if (!ptid_equal (displaced->buffers[i].step_ptid, null_ptid))
+      return 1;
+
+  return 0;
+}
+
 /* If inferior is in displaced stepping, and ADDR equals to starting address
    of copy area, return corresponding displaced_step_closure.  Otherwise,
    return NULL.  */
@@ -1217,15 +1284,100 @@ get_displaced_step_closure_by_addr (CORE_ADDR addr)
 {
   struct displaced_step_inferior_state *displaced
     = get_displaced_stepping_state (ptid_get_pid (inferior_ptid));
+  int i;
+
+  if (displaced == NULL)
+    return NULL;
 
   /* If checking the mode of displaced instruction in copy area.  */
-  if (displaced && !ptid_equal (displaced->step_ptid, null_ptid)
-     && (displaced->step_copy == addr))
-    return displaced->step_closure;
+  for (i = 0; i < displaced->num_buffers; i++)
+    if (!ptid_equal (displaced->buffers[i].step_ptid, null_ptid)
+	&& displaced->buffers[i].step_copy == addr)
+      return displaced->buffers[i].step_closure;
 
   return NULL;
 }
 
+/* Free the displaced stepping buffers of DISPLACED.  */
+
+static void
+free_displaced_step_buffers (struct displaced_step_inferior_state *displaced)
+{
+  int i;
+
+  for (i = 0; i < displaced->num_buffers; i++)
+    xfree (displaced->buffers[i].step_saved_copy);
+  xfree (displaced->buffers);
+  displaced->buffers = NULL;
+  displaced->num_buffers = 0;
+}
+
+/* Lay out the displaced stepping buffers of DISPLACED for a thread of
+   architecture GDBARCH, unless they already are laid out that way.
+   None of them may be in use.
+
+   The buffers are consecutive, starting at the address returned by
+   gdbarch_displaced_step_location.  That area is normally the code
+   at the program's entry point, which only runs at startup; so we
+   only use more than one buffer if they all fit in the function
+   holding it.  */
+
+static void
+displaced_step_layout_buffers (struct displaced_step_inferior_state *displaced,
+			       struct gdbarch *gdbarch)
+{
+  CORE_ADDR base = gdbarch_displaced_step_location (gdbarch);
+  ULONGEST len = gdbarch_max_insn_length (gdbarch);
+  ULONGEST count = 1;
+  int i;
+
+  if (displaced_stepping_buffers > 1
+      && (displaced->room_gdbarch != gdbarch
+	  || displaced->room_base != base))
+    {
+      CORE_ADDR func_end;
+
+      if (!find_pc_partial_function (base, NULL, NULL, &func_end))
+	func_end = 0;
+      displaced->room_gdbarch = gdbarch;
+      displaced->room_base = base;
+      displaced->room_end = func_end;
+    }
+
+  if (displaced_stepping_buffers > 1
+      && displaced->room_end > base)
+    {
+      count = (displaced->room_end - base) / len;
+      if (count > displaced_stepping_buffers)
+	count = displaced_stepping_buffers;
+      if (count == 0)
+	count = 1;
+    }
+
+  /* The setting, and the symbols around BASE, may have changed since
+     the current layout was made; keep it only if it is still the one
+     we want.  */
+  if (displaced->num_buffers == count
+      && displaced->buffers_gdbarch == gdbarch
+      && displaced->buffers[0].step_copy == base)
+    return;
+
+  free_displaced_step_buffers (displaced);
+  displaced->num_buffers = count;
+  displaced->buffers = XCNEWVEC (struct displaced_step_buffer, count);
+  for (i = 0; i < count; i++)
+    {
+      displaced->buffers[i].step_ptid = null_ptid;
+      displaced->buffers[i].step_copy = base + i * len;
+    }
+  displaced->buffers_gdbarch = gdbarch;
+
+  if (debug_displaced)
+    fprintf_unfiltered (gdb_stdlog,
+			"displaced: using %d buffer(s) at %s\n",
+			displaced->num_buffers, paddress (gdbarch, base));
+}
+
 /* Remove the displaced stepping state of process PID.  */
 
 static void
@@ -1242,6 +1394,7 @@ remove_displaced_stepping_state (int pid)
       if (it->pid == pid)
 	{
 	  *prev_next_p = it->next;
+	  free_displaced_step_buffers (it);
 	  xfree (it);
 	  return;
 	}
@@ -1257,6 +1410,20 @@ infrun_inferior_exit (struct inferior *inf)
   remove_displaced_stepping_state (inf->pid);
 }
 
+/* Forget where the function holding each scratch area ends, since
+   OBJFILE was just loaded or is about to be freed.  */
+
+static void
+infrun_objfiles_changed (struct objfile *objfile)
+{
+  struct displaced_step_inferior_state *state;
+
+  for (state = displaced_step_inferior_states;
+       state != NULL;
+       state = state->next)
+    state->room_gdbarch = NULL;
+}
+
 /* If ON, and the architecture supports it, GDB will use displaced
    stepping to step over breakpoints.  If OFF, or if the architecture
    doesn't support it, GDB will instead use the traditional
@@ -1297,25 +1464,25 @@ use_displaced_stepping (struct gdbarch *gdbarch)
 
 /* Clean out any stray displaced stepping state.  */
 static void
-displaced_step_clear (struct displaced_step_inferior_state *displaced)
+displaced_step_clear (struct displaced_step_buffer *buffer)
 {
   /* Indicate that there is no cleanup pending.  */
-  displaced->step_ptid = null_ptid;
+  buffer->step_ptid = null_ptid;
 
-  if (displaced->step_closure)
+  if (buffer->step_closure)
     {
-      gdbarch_displaced_step_free_closure (displaced->step_gdbarch,
-                                           displaced->step_closure);
-      displaced->step_closure = NULL;
+      gdbarch_displaced_step_free_closure (buffer->step_gdbarch,
+                                           buffer->step_closure);
+      buffer->step_closure = NULL;
     }
 }
 
 static void
 displaced_step_clear_cleanup (void *arg)
 {
-  struct displaced_step_inferior_state *state = arg;
+  struct displaced_step_buffer *buffer = arg;
 
-  displaced_step_clear (state);
+  displaced_step_clear (buffer);
 }
 
 /* Dump LEN bytes at BUF in hex to FILE, followed by a newline.  */
@@ -1356,6 +1523,7 @@ displaced_step_prepare (ptid_t ptid)
   ULONGEST len;
   struct displaced_step_closure *closure;
   struct displaced_step_inferior_state *displaced;
+  struct displaced_step_buffer *buffer = NULL;
   int status;
 
   /* We should never reach this function if the architecture does not
@@ -1368,15 +1536,28 @@ displaced_step_prepare (ptid_t ptid)
      jump/branch).  */
   tp->control.may_range_step = 0;
 
-  /* We have to displaced step one thread at a time, as we only have
-     access to a single scratch space per inferior.  */
+  /* We can displaced step as many threads at a time as there are
+     buffers in the scratch space of the inferior.  */
 
   displaced = add_displaced_stepping_state (ptid_get_pid (ptid));
 
-  if (!ptid_equal (displaced->step_ptid, null_ptid))
+  if (displaced_step_in_progress (displaced)
+      && displaced->buffers_gdbarch == gdbarch)
+    {
+      int i;
+
+      for (i = 0; i < displaced->num_buffers; i++)
+	if (ptid_equal (displaced->buffers[i].step_ptid, null_ptid))
+	  {
+	    buffer = &displaced->buffers[i];
+	    break;
+	  }
+    }
+
+  if (displaced_step_in_progress (displaced) && buffer == NULL)
     {
-      /* Already waiting for a displaced step to finish.  Defer this
-	 request and place in queue.  */
+      /* All the buffers are in use.  Defer this request and place in
+	 queue.  */
       struct displaced_step_request *req, *new_req;
 
       if (debug_displaced)
@@ -1409,21 +1590,28 @@ displaced_step_prepare (ptid_t ptid)
 			    target_pid_to_str (ptid));
     }
 
-  displaced_step_clear (displaced);
-
   old_cleanups = save_inferior_ptid ();
   inferior_ptid = ptid;
 
+  if (buffer == NULL)
+    {
+      displaced_step_layout_buffers (displaced, gdbarch);
+      buffer = &displaced->buffers[0];
+    }
+
+  displaced_step_clear (buffer);
+
   original = regcache_read_pc (regcache);
 
-  copy = gdbarch_displaced_step_location (gdbarch);
+  copy = buffer->step_copy;
   len = gdbarch_max_insn_length (gdbarch);
 
   /* Save the original contents of the copy area.  */
-  displaced->step_saved_copy = xmalloc (len);
+  xfree (buffer->step_saved_copy);
+  buffer->step_saved_copy = xmalloc (len);
   ignore_cleanups = make_cleanup (free_current_contents,
-				  &displaced->step_saved_copy);
-  status = target_read_memory (copy, displaced->step_saved_copy, len);
+				  &buffer->step_saved_copy);
+  status = target_read_memory (copy, buffer->step_saved_copy, len);
   if (status != 0)
     throw_error (MEMORY_ERROR,
 		 _("Error accessing memory address %s (%s) for "
@@ -1434,7 +1622,7 @@ displaced_step_prepare (ptid_t ptid)
       fprintf_unfiltered (gdb_stdlog, "displaced: saved %s: ",
 			  paddress (gdbarch, copy));
       displaced_step_dump_bytes (gdb_stdlog,
-				 displaced->step_saved_copy,
+				 buffer->step_saved_copy,
 				 len);
     };
 
@@ -1446,13 +1634,12 @@ displaced_step_prepare (ptid_t ptid)
 
   /* Save the information we need to fix things up if the step
      succeeds.  */
-  displaced->step_ptid = ptid;
-  displaced->step_gdbarch = gdbarch;
-  displaced->step_closure = closure;
-  displaced->step_original = original;
-  displaced->step_copy = copy;
+  buffer->step_ptid = ptid;
+  buffer->step_gdbarch = gdbarch;
+  buffer->step_closure = closure;
+  buffer->step_original = original;
 
-  make_cleanup (displaced_step_clear_cleanup, displaced);
+  make_cleanup (displaced_step_clear_cleanup, buffer);
 
   /* Resume execution at the copy.  */
   regcache_write_pc (regcache, copy);
@@ -1479,21 +1666,20 @@ write_memory_ptid (ptid_t ptid, CORE_ADDR memaddr,
   do_cleanups (ptid_cleanup);
 }
 
-/* Restore the contents of the copy area for thread PTID.  */
+/* Restore the contents of BUFFER for thread PTID.  */
 
 static void
-displaced_step_restore (struct displaced_step_inferior_state *displaced,
-			ptid_t ptid)
+displaced_step_restore (struct displaced_step_buffer *buffer, ptid_t ptid)
 {
-  ULONGEST len = gdbarch_max_insn_length (displaced->step_gdbarch);
+  ULONGEST len = gdbarch_max_insn_length (buffer->step_gdbarch);
 
-  write_memory_ptid (ptid, displaced->step_copy,
-		     displaced->step_saved_copy, len);
+  write_memory_ptid (ptid, buffer->step_copy,
+		     buffer->step_saved_copy, len);
   if (debug_displaced)
     fprintf_unfiltered (gdb_stdlog, "displaced: restored %s %s\n",
 			target_pid_to_str (ptid),
-			paddress (displaced->step_gdbarch,
-				  displaced->step_copy));
+			paddress (buffer->step_gdbarch,
+				  buffer->step_copy));
 }
 
 static void
@@ -1502,29 +1688,32 @@ displaced_step_fixup (ptid_t event_ptid, enum gdb_signal signal)
   struct cleanup *old_cleanups;
   struct displaced_step_inferior_state *displaced
     = get_displaced_stepping_state (ptid_get_pid (event_ptid));
+  struct displaced_step_buffer *buffer;
 
   /* Was any thread of this process doing a displaced step?  */
   if (displaced == NULL)
     return;
 
-  /* Was this event for the pid we displaced?  */
-  if (ptid_equal (displaced->step_ptid, null_ptid)
-      || ! ptid_equal (displaced->step_ptid, event_ptid))
+  /* Was this event for a thread we displaced?  */
+  if (ptid_equal (event_ptid, null_ptid))
+    return;
+  buffer = displaced_step_buffer_of_thread (displaced, event_ptid);
+  if (buffer == NULL)
     return;
 
-  old_cleanups = make_cleanup (displaced_step_clear_cleanup, displaced);
+  old_cleanups = make_cleanup (displaced_step_clear_cleanup, buffer);
 
-  displaced_step_restore (displaced, displaced->step_ptid);
+  displaced_step_restore (buffer, buffer->step_ptid);
 
   /* Did the instruction complete successfully?  */
   if (signal == GDB_SIGNAL_TRAP)
     {
       /* Fix up the resulting state.  */
-      gdbarch_displaced_step_fixup (displaced->step_gdbarch,
-                                    displaced->step_closure,
-                                    displaced->step_original,
-                                    displaced->step_copy,
-                                    get_thread_regcache (displaced->step_ptid));
+      gdbarch_displaced_step_fixup (buffer->step_gdbarch,
+                                    buffer->step_closure,
+                                    buffer->step_original,
+                                    buffer->step_copy,
+                                    get_thread_regcache (buffer->step_ptid));
     }
   else
     {
@@ -1533,13 +1722,13 @@ displaced_step_fixup (ptid_t event_ptid, enum gdb_signal signal)
       struct regcache *regcache = get_thread_regcache (event_ptid);
       CORE_ADDR pc = regcache_read_pc (regcache);
 
-      pc = displaced->step_original + (pc - displaced->step_copy);
+      pc = buffer->step_original + (pc - buffer->step_copy);
       regcache_write_pc (regcache, pc);
     }
 
   do_cleanups (old_cleanups);
 
-  displaced->step_ptid = null_ptid;
+  buffer->step_ptid = null_ptid;
 
   /* Are there any pending displaced stepping requests?  If so, run
      one now.  Leave the state object around, since we're likely to
@@ -1571,7 +1760,11 @@ displaced_step_fixup (ptid_t event_ptid, enum gdb_signal signal)
 				"displaced: stepping queued %s now\n",
 				target_pid_to_str (ptid));
 
-	  displaced_step_prepare (ptid);
+	  if (!displaced_step_prepare (ptid))
+	    {
+	      /* Queued again, behind the other requests.  */
+	      break;
+	    }
 
 	  gdbarch = get_regcache_arch (regcache);
 
@@ -1586,8 +1779,9 @@ displaced_step_fixup (ptid_t event_ptid, enum gdb_signal signal)
 	      displaced_step_dump_bytes (gdb_stdlog, buf, sizeof (buf));
 	    }
 
+	  buffer = displaced_step_buffer_of_thread (displaced, ptid);
 	  if (gdbarch_displaced_step_hw_singlestep (gdbarch,
-						    displaced->step_closure))
+						    buffer->step_closure))
 	    target_resume (ptid, 1, GDB_SIGNAL_0);
 	  else
 	    target_resume (ptid, 0, GDB_SIGNAL_0);
@@ -1639,8 +1833,11 @@ infrun_thread_ptid_changed (ptid_t old_ptid, ptid_t new_ptid)
        displaced;
        displaced = displaced->next)
     {
-      if (ptid_equal (displaced->step_ptid, old_ptid))
-	displaced->step_ptid = new_ptid;
+      int i;
+
+      for (i = 0; i < displaced->num_buffers; i++)
+	if (ptid_equal (displaced->buffers[i].step_ptid, old_ptid))
+	  displaced->buffers[i].step_ptid = new_ptid;
 
       for (it = displaced->step_request_queue; it; it = it->next)
 	if (ptid_equal (it->ptid, old_ptid))
@@ -1844,6 +2041,7 @@ a command like `return' or `jump' to continue execution."));
       && !current_inferior ()->waiting_for_vfork_done)
     {
       struct displaced_step_inferior_state *displaced;
+      struct displaced_step_buffer *buffer;
 
       if (!displaced_step_prepare (inferior_ptid))
 	{
@@ -1863,8 +2061,9 @@ a command like `return' or `jump' to continue execution."));
       pc = regcache_read_pc (get_thread_regcache (inferior_ptid));
 
       displaced = get_displaced_stepping_state (ptid_get_pid (inferior_ptid));
+      buffer = displaced_step_buffer_of_thread (displaced, inferior_ptid);
       step = gdbarch_displaced_step_hw_singlestep (gdbarch,
-						   displaced->step_closure);
+						   buffer->step_closure);
     }
 
   /* Do we need to do it the hard way, w/temp breakpoints?  */
@@ -2710,7 +2909,7 @@ prepare_for_detach (void)
 
   /* Is any thread of this process displaced stepping?  If not,
      there's nothing else to do.  */
-  if (displaced == NULL || ptid_equal (displaced->step_ptid, null_ptid))
+  if (displaced == NULL || !displaced_step_in_progress (displaced))
     return;
 
   if (debug_infrun)
@@ -2720,7 +2919,7 @@ prepare_for_detach (void)
   old_chain_1 = make_cleanup_restore_integer (&inf->detaching);
   inf->detaching = 1;
 
-  while (!ptid_equal (displaced->step_ptid, null_ptid))
+  while (displaced_step_in_progress (displaced))
     {
       struct cleanup *old_chain_2;
       struct execution_control_state ecss;
@@ -3573,10 +3772,14 @@ Cannot fill $_exitsignal with the correct signal number.\n"));
 	struct gdbarch *gdbarch = get_regcache_arch (regcache);
 	struct displaced_step_inferior_state *displaced
 	  = get_displaced_stepping_state (ptid_get_pid (ecs->ptid));
+	struct displaced_step_buffer *buffer
+	  = (displaced != NULL
+	     ? displaced_step_buffer_of_thread (displaced, ecs->ptid)
+	     : NULL);
 
 	/* If checking displaced stepping is supported, and thread
 	   ecs->ptid is displaced stepping.  */
-	if (displaced && ptid_equal (displaced->step_ptid, ecs->ptid))
+	if (buffer != NULL)
 	  {
 	    struct inferior *parent_inf
 	      = find_inferior_pid (ptid_get_pid (ecs->ptid));
@@ -3592,8 +3795,18 @@ Cannot fill $_exitsignal with the correct signal number.\n"));
 
 	    if (ecs->ws.kind == TARGET_WAITKIND_FORKED)
 	      {
-		/* Restore scratch pad for child process.  */
-		displaced_step_restore (displaced, ecs->ws.value.related_pid);
+		int i;
+
+		/* Restore scratch pad for child process.  The child also
+		   got a copy of the buffers other threads are stepping
+		   in.  */
+		displaced_step_restore (buffer, ecs->ws.value.related_pid);
+		for (i = 0; i < displaced->num_buffers; i++)
+		  if (&displaced->buffers[i] != buffer
+		      && !ptid_equal (displaced->buffers[i].step_ptid,
+				      null_ptid))
+		    displaced_step_restore (&displaced->buffers[i],
+					    ecs->ws.value.related_pid);
 	      }
 
 	    /* Since the vfork/fork syscall instruction was executed in the scratchpad,
@@ -7484,6 +7697,19 @@ use it in all-stop mode (see help set non-stop)."),
 				show_can_use_displaced_stepping,
 				&setlist, &showlist);
 
+  add_setshow_uinteger_cmd ("displaced-stepping-buffers", class_run,
+			    &displaced_stepping_buffers, _("\
+Set the maximum number of displaced stepping buffers per inferior."), _("\
+Show the maximum number of displaced stepping buffers per inferior."), _("\
+With more than one buffer, several threads of an inferior can step over\n\
+breakpoints at the same time using displaced stepping.  The buffers are\n\
+taken from the scratch area gdb uses for displaced stepping, normally the\n\
+code at the program's entry point; gdb only uses as many of them as fit in\n\
+the function holding that area, and at least one."),
+			    NULL,
+			    show_displaced_stepping_buffers,
+			    &setlist, &showlist);
+
   add_setshow_enum_cmd ("exec-direction", class_run, exec_direction_names,
 			&exec_direction, _("Set direction of execution.\n\
 Options are 'forward' or 'reverse'."),
@@ -7521,6 +7747,8 @@ enabled by default on some platforms."),
   observer_attach_thread_stop_requested (infrun_thread_stop_requested);
   observer_attach_thread_exit (infrun_thread_thread_exit);
   observer_attach_inferior_exit (infrun_inferior_exit);
+  observer_attach_new_objfile (infrun_objfiles_changed);
+  observer_attach_free_objfile (infrun_objfiles_changed);
 
   /* Explicitly create without lookup, since that tries to create a
      value with a void typed value, and when we get here, gdbarch
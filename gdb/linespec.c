@@ -196,6 +196,11 @@ struct linespec_state
   /* This is a set of address_entry objects which is used to prevent
      duplicate symbols from being entered into the result.  */
   htab_t addr_set;
+
+  /* If not NULL, only the symbols of these NUM_SEARCH_OBJFILES
+     objfiles are searched; see linespec_matches_objfiles_p.  */
+  struct objfile **search_objfiles;
+  int num_search_objfiles;
 };
 
 /* This is a helper object that is used when collecting symbols into a
@@ -322,7 +327,8 @@ static struct symtabs_and_lines decode_objc (struct linespec_state *self,
 					     linespec_p ls,
 					     const char **argptr);
 
-static VEC (symtab_ptr) *symtabs_from_filename (const char *);
+static VEC (symtab_ptr) *symtabs_from_filename (struct linespec_state *,
+						const char *);
 
 static VEC (symbolp) *find_label_symbols (struct linespec_state *self,
 					  VEC (symbolp) *function_symbols,
@@ -350,7 +356,9 @@ static void add_all_symbol_names_from_pspace (struct collect_info *info,
 					      struct program_space *pspace,
 					      VEC (const_char_ptr) *names);
 
-static VEC (symtab_ptr) *collect_symtabs_from_filename (const char *file);
+static VEC (symtab_ptr) *
+  collect_symtabs_from_filename (struct linespec_state *self,
+				 const char *file);
 
 static void decode_digits_ordinary (struct linespec_state *self,
 				    linespec_p ls,
@@ -988,6 +996,24 @@ iterate_name_matcher (const char *name, void *d)
   return 0; /* Skip this symbol.  */
 }
 
+/* Return nonzero if STATE should look for symbols in OBJFILE.  */
+
+static int
+linespec_search_objfile_p (struct linespec_state *state,
+			   struct objfile *objfile)
+{
+  int i;
+
+  if (state->search_objfiles == NULL)
+    return 1;
+
+  for (i = 0; i < state->num_search_objfiles; i++)
+    if (state->search_objfiles[i] == objfile)
+      return 1;
+
+  return 0;
+}
+
 /* A helper that walks over all matching symtabs in all objfiles and
    calls CALLBACK for each symbol matching NAME.  If SEARCH_PSPACE is
    not NULL, then the search is restricted to just that program
@@ -1026,6 +1052,9 @@ iterate_over_all_matching_symtabs (struct linespec_state *state,
     {
       struct symtab *symtab;
 
+      if (!linespec_search_objfile_p (state, objfile))
+	continue;
+
       if (objfile->sf)
 	objfile->sf->qf->expand_symtabs_matching (objfile, NULL,
 						  iterate_name_matcher,
@@ -1864,7 +1893,7 @@ create_sals_line_offset (struct linespec_state *self,
       fullname = symtab_to_fullname (self->default_symtab);
       VEC_pop (symtab_ptr, ls->file_symtabs);
       VEC_free (symtab_ptr, ls->file_symtabs);
-      ls->file_symtabs = collect_symtabs_from_filename (fullname);
+      ls->file_symtabs = collect_symtabs_from_filename (self, fullname);
       use_default = 1;
     }
 
@@ -2269,7 +2298,7 @@ parse_linespec (linespec_parser *parser, const char **argptr)
       TRY_CATCH (file_exception, RETURN_MASK_ERROR)
 	{
 	  PARSER_RESULT (parser)->file_symtabs
-	    = symtabs_from_filename (user_filename);
+	    = symtabs_from_filename (PARSER_STATE (parser), user_filename);
 	}
 
       if (file_exception.reason >= 0)
@@ -2520,6 +2549,43 @@ decode_line_1 (char **argptr, int flags,
 
 /* See linespec.h.  */
 
+int
+linespec_matches_objfiles_p (char **argptr, int flags,
+			     struct objfile **objfiles, int num_objfiles)
+{
+  struct symtabs_and_lines result;
+  linespec_parser parser;
+  struct cleanup *cleanups;
+  const char *copy, *orig;
+  volatile struct gdb_exception e;
+
+  linespec_parser_new (&parser, flags, current_language, NULL, 0, NULL);
+  cleanups = make_cleanup (linespec_parser_delete, &parser);
+  save_current_program_space ();
+  PARSER_STATE (&parser)->search_objfiles = objfiles;
+  PARSER_STATE (&parser)->num_search_objfiles = num_objfiles;
+
+  orig = copy = *argptr;
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    {
+      result = parse_linespec (&parser, &copy);
+    }
+  if (e.reason < 0)
+    {
+      if (e.error != NOT_FOUND_ERROR)
+	throw_exception (e);
+      result.sals = NULL;
+      result.nelts = 0;
+    }
+  *argptr += copy - orig;
+
+  do_cleanups (cleanups);
+  xfree (result.sals);
+  return result.nelts > 0;
+}
+
+/* See linespec.h.  */
+
 struct symtabs_and_lines
 decode_line_with_current_source (char *string, int flags)
 {
@@ -2968,6 +3034,9 @@ find_method (struct linespec_state *self, VEC (symtab_ptr) *file_symtabs,
 
 struct symtab_collector
 {
+  /* The linespec object in use.  */
+  struct linespec_state *state;
+
   /* The result vector of symtabs.  */
   VEC (symtab_ptr) *symtabs;
 
@@ -2983,6 +3052,9 @@ add_symtabs_to_list (struct symtab *symtab, void *d)
   struct symtab_collector *data = d;
   void **slot;
 
+  if (!linespec_search_objfile_p (data->state, symtab->objfile))
+    return 0;
+
   slot = htab_find_slot (data->symtab_table, symtab, INSERT);
   if (!*slot)
     {
@@ -2996,12 +3068,13 @@ add_symtabs_to_list (struct symtab *symtab, void *d)
 /* Given a file name, return a VEC of all matching symtabs.  */
 
 static VEC (symtab_ptr) *
-collect_symtabs_from_filename (const char *file)
+collect_symtabs_from_filename (struct linespec_state *self, const char *file)
 {
   struct symtab_collector collector;
   struct cleanup *cleanups;
   struct program_space *pspace;
 
+  collector.state = self;
   collector.symtabs = NULL;
   collector.symtab_table = htab_create (1, htab_hash_pointer, htab_eq_pointer,
 					NULL);
@@ -3024,11 +3097,11 @@ collect_symtabs_from_filename (const char *file)
 /* Return all the symtabs associated to the FILENAME.  */
 
 static VEC (symtab_ptr) *
-symtabs_from_filename (const char *filename)
+symtabs_from_filename (struct linespec_state *self, const char *filename)
 {
   VEC (symtab_ptr) *result;
   
-  result = collect_symtabs_from_filename (filename);
+  result = collect_symtabs_from_filename (self, filename);
 
   if (VEC_empty (symtab_ptr, result))
     {
@@ -3563,6 +3636,9 @@ search_minsyms_for_name (struct collect_info *info, const char *name,
 
     ALL_OBJFILES (objfile)
     {
+      if (!linespec_search_objfile_p (info->state, objfile))
+	continue;
+
       local.objfile = objfile;
       iterate_over_minimal_symbols (objfile, name, add_minsym, &local);
     }
@@ -18,6 +18,7 @@
 #define LINESPEC_H 1
 
 struct symtab;
+struct objfile;
 
 #include "vec.h"
 
@@ -141,6 +142,17 @@ extern void decode_line_full (char **argptr, int flags,
 			      const char *select_mode,
 			      const char *filter);
 
+/* Return nonzero if decoding the linespec at *ARGPTR as decode_line_1
+   would, with FLAGS, finds any location in the NUM_OBJFILES objfiles
+   of OBJFILES.  Only the symbols of those objfiles are looked up, so
+   this is much cheaper than decoding the linespec against all the
+   objfiles.  Some linespecs, like "*ADDRESS", do not depend on the
+   symbols of any particular objfile; those always match.  */
+
+extern int linespec_matches_objfiles_p (char **argptr, int flags,
+					struct objfile **objfiles,
+					int num_objfiles);
+
 /* Given a string, return the line specified by it, using the current
    source symtab and line as defaults.
    This is for commands like "list" and "breakpoint".  */
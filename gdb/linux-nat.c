@@ -25,10 +25,9 @@
 #include <string.h>
 #include "gdb_wait.h"
 #include "gdb_assert.h"
-#ifdef HAVE_TKILL_SYSCALL
 #include <unistd.h>
 #include <sys/syscall.h>
-#endif
+#include <sys/uio.h>
 #include <sys/ptrace.h>
 #include "linux-nat.h"
 #include "linux-ptrace.h"
@@ -274,7 +273,7 @@ struct lwp_info;
 static struct lwp_info *add_lwp (ptid_t ptid);
 static void purge_lwp_list (int pid);
 static void delete_lwp (ptid_t ptid);
-static struct lwp_info *find_lwp_pid (ptid_t ptid);
+static void linux_proc_mem_file_close (int pid);
 
 
 /* Trivial list manipulation functions to keep track of a list of
@@ -783,6 +782,78 @@ linux_child_set_syscall_catchpoint (struct target_ops *self,
 
 /* List of known LWPs.  */
 struct lwp_info *lwp_list;
+
+/* Index of LWP_LIST by LWP number, so that finding the LWP of an event
+   doesn't walk the whole list.  */
+static htab_t lwp_lwpid_htab;
+
+/* Hash function for LWP_LWPID_HTAB.  */
+
+static hashval_t
+lwp_info_hash (const void *ap)
+{
+  const struct lwp_info *lp = ap;
+
+  return ptid_get_lwp (lp->ptid);
+}
+
+/* Equality function for LWP_LWPID_HTAB, comparing an LWP with an
+   LWP number.  */
+
+static int
+lwp_lwpid_htab_eq (const void *a, const void *b)
+{
+  const struct lwp_info *entry = a;
+  const long *lwp = b;
+
+  return ptid_get_lwp (entry->ptid) == *lwp;
+}
+
+/* Return the slot of LWP_LWPID_HTAB for LWP number LWP.  */
+
+static void **
+lwp_lwpid_htab_slot (long lwp, enum insert_option insert)
+{
+  if (lwp_lwpid_htab == NULL)
+    lwp_lwpid_htab = htab_create (100, lwp_info_hash, lwp_lwpid_htab_eq,
+				  NULL);
+
+  return htab_find_slot_with_hash (lwp_lwpid_htab, &lwp, lwp, insert);
+}
+
+/* Add LP to the head of LWP_LIST and to its index.  */
+
+static void
+lwp_list_add (struct lwp_info *lp)
+{
+  long lwp = ptid_get_lwp (lp->ptid);
+
+  lp->prev = NULL;
+  lp->next = lwp_list;
+  if (lwp_list != NULL)
+    lwp_list->prev = lp;
+  lwp_list = lp;
+
+  *lwp_lwpid_htab_slot (lwp, INSERT) = lp;
+}
+
+/* Remove LP from LWP_LIST and from its index.  */
+
+static void
+lwp_list_remove (struct lwp_info *lp)
+{
+  void **slot = lwp_lwpid_htab_slot (ptid_get_lwp (lp->ptid), NO_INSERT);
+
+  if (slot != NULL && *slot == lp)
+    htab_clear_slot (lwp_lwpid_htab, slot);
+
+  if (lp->prev != NULL)
+    lp->prev->next = lp->next;
+  else
+    lwp_list = lp->next;
+  if (lp->next != NULL)
+    lp->next->prev = lp->prev;
+}
 
 
 /* Original signal mask.  */
@@ -844,6 +915,7 @@ linux_nat_pass_signals (struct target_ops *self,
 
 /* Prototypes for local functions.  */
 static int stop_wait_callback (struct lwp_info *lp, void *data);
+static void stop_wait_lwps (ptid_t filter);
 static int linux_thread_alive (ptid_t ptid);
 static char *linux_child_pid_to_exec_file (struct target_ops *self, int pid);
 
@@ -854,6 +926,7 @@ static char *linux_child_pid_to_exec_file (struct target_ops *self, int pid);
 static void
 lwp_free (struct lwp_info *lp)
 {
+  linux_proc_mem_file_close (ptid_get_lwp (lp->ptid));
   xfree (lp->arch_private);
   xfree (lp);
 }
@@ -863,9 +936,7 @@ lwp_free (struct lwp_info *lp)
 static void
 purge_lwp_list (int pid)
 {
-  struct lwp_info *lp, *lpprev, *lpnext;
-
-  lpprev = NULL;
+  struct lwp_info *lp, *lpnext;
 
   for (lp = lwp_list; lp; lp = lpnext)
     {
@@ -873,15 +944,9 @@ purge_lwp_list (int pid)
 
       if (ptid_get_pid (lp->ptid) == pid)
 	{
-	  if (lp == lwp_list)
-	    lwp_list = lp->next;
-	  else
-	    lpprev->next = lp->next;
-
+	  lwp_list_remove (lp);
 	  lwp_free (lp);
 	}
-      else
-	lpprev = lp;
     }
 }
 
@@ -916,8 +981,7 @@ add_initial_lwp (ptid_t ptid)
   lp->ptid = ptid;
   lp->core = -1;
 
-  lp->next = lwp_list;
-  lwp_list = lp;
+  lwp_list_add (lp);
 
   return lp;
 }
@@ -948,44 +1012,34 @@ add_lwp (ptid_t ptid)
 static void
 delete_lwp (ptid_t ptid)
 {
-  struct lwp_info *lp, *lpprev;
-
-  lpprev = NULL;
+  struct lwp_info *lp = find_lwp_pid (ptid);
 
-  for (lp = lwp_list; lp; lpprev = lp, lp = lp->next)
-    if (ptid_equal (lp->ptid, ptid))
-      break;
-
-  if (!lp)
+  if (lp == NULL || !ptid_equal (lp->ptid, ptid))
     return;
 
-  if (lpprev)
-    lpprev->next = lp->next;
-  else
-    lwp_list = lp->next;
-
+  lwp_list_remove (lp);
   lwp_free (lp);
 }
 
 /* Return a pointer to the structure describing the LWP corresponding
    to PID.  If no corresponding LWP could be found, return NULL.  */
 
-static struct lwp_info *
+struct lwp_info *
 find_lwp_pid (ptid_t ptid)
 {
-  struct lwp_info *lp;
-  int lwp;
+  long lwp;
+  void **slot;
 
   if (ptid_lwp_p (ptid))
     lwp = ptid_get_lwp (ptid);
   else
     lwp = ptid_get_pid (ptid);
 
-  for (lp = lwp_list; lp; lp = lp->next)
-    if (lwp == ptid_get_lwp (lp->ptid))
-      return lp;
+  slot = lwp_lwpid_htab_slot (lwp, NO_INSERT);
+  if (slot == NULL)
+    return NULL;
 
-  return NULL;
+  return *slot;
 }
 
 /* Call CALLBACK with its second argument set to DATA for every LWP in
@@ -1000,6 +1054,17 @@ iterate_over_lwps (ptid_t filter,
 {
   struct lwp_info *lp, *lpnext;
 
+  /* A filter naming a single LWP can only match that LWP.  */
+  if (ptid_lwp_p (filter))
+    {
+      lp = find_lwp_pid (filter);
+      if (lp != NULL
+	  && ptid_match (lp->ptid, filter)
+	  && (*callback) (lp, data))
+	return lp;
+      return NULL;
+    }
+
   for (lp = lwp_list; lp; lp = lpnext)
     {
       lpnext = lp->next;
@@ -1544,7 +1609,7 @@ linux_nat_detach (struct target_ops *ops, const char *args, int from_tty)
   iterate_over_lwps (pid_to_ptid (pid), stop_callback, NULL);
   /* ... and wait until all of them have reported back that
      they're no longer running.  */
-  iterate_over_lwps (pid_to_ptid (pid), stop_wait_callback, NULL);
+  stop_wait_lwps (pid_to_ptid (pid));
 
   iterate_over_lwps (pid_to_ptid (pid), detach_callback, NULL);
 
@@ -1863,6 +1928,8 @@ linux_handle_syscall_trap (struct lwp_info *lp, int stopping)
 			    ptid_get_lwp (lp->ptid));
 
       lp->syscall_state = TARGET_WAITKIND_IGNORE;
+      if (linux_nat_prepare_to_resume != NULL)
+	linux_nat_prepare_to_resume (lp);
       ptrace (PTRACE_CONT, ptid_get_lwp (lp->ptid), 0, 0);
       return 1;
     }
@@ -2174,6 +2241,9 @@ linux_handle_extended_wait (struct lwp_info *lp, int status,
       ourstatus->value.execd_pathname
 	= xstrdup (linux_child_pid_to_exec_file (NULL, pid));
 
+      /* The process has a new address space.  */
+      linux_proc_mem_file_close (-1);
+
       return 0;
     }
 
@@ -2196,6 +2266,8 @@ linux_handle_extended_wait (struct lwp_info *lp, int status,
 			    "LHEW: Got PTRACE_EVENT_VFORK_DONE "
 			    "from LWP %ld: resuming\n",
 			    ptid_get_lwp (lp->ptid));
+      if (linux_nat_prepare_to_resume != NULL)
+	linux_nat_prepare_to_resume (lp);
       ptrace (PTRACE_CONT, ptid_get_lwp (lp->ptid), 0, 0);
       return 1;
     }
@@ -2204,6 +2276,52 @@ linux_handle_extended_wait (struct lwp_info *lp, int status,
 		  _("unknown ptrace event %d"), event);
 }
 
+/* Handle STATUS, just collected from waitpid for LP.  Return the stop
+   status of LP, 0 if it exited, or -1 if the event was handled
+   internally and LP was resumed, in which case the caller should wait
+   for LP again.  */
+
+static int
+wait_lwp_status (struct lwp_info *lp, int status)
+{
+  /* Check if the thread has exited.  */
+  if (WIFEXITED (status) || WIFSIGNALED (status))
+    {
+      if (debug_linux_nat)
+	fprintf_unfiltered (gdb_stdlog, "WL: %s exited.\n",
+			    target_pid_to_str (lp->ptid));
+      exit_lwp (lp);
+      return 0;
+    }
+
+  gdb_assert (WIFSTOPPED (status));
+
+  /* Handle GNU/Linux's syscall SIGTRAPs.  */
+  if (WIFSTOPPED (status) && WSTOPSIG (status) == SYSCALL_SIGTRAP)
+    {
+      /* No longer need the sysgood bit.  The ptrace event ends up
+	 recorded in lp->waitstatus if we care for it.  We can carry
+	 on handling the event like a regular SIGTRAP from here
+	 on.  */
+      status = W_STOPCODE (SIGTRAP);
+      if (linux_handle_syscall_trap (lp, 1))
+	return -1;
+    }
+
+  /* Handle GNU/Linux's extended waitstatus for trace events.  */
+  if (WIFSTOPPED (status) && WSTOPSIG (status) == SIGTRAP && status >> 16 != 0)
+    {
+      if (debug_linux_nat)
+	fprintf_unfiltered (gdb_stdlog,
+			    "WL: Handling extended status 0x%06x\n",
+			    status);
+      if (linux_handle_extended_wait (lp, status, 1))
+	return -1;
+    }
+
+  return status;
+}
+
 /* Wait for LP to stop.  Returns the wait status, or 0 if the LWP has
    exited.  */
 
@@ -2282,59 +2400,25 @@ wait_lwp (struct lwp_info *lp)
 
   restore_child_signals_mask (&prev_mask);
 
-  if (!thread_dead)
-    {
-      gdb_assert (pid == ptid_get_lwp (lp->ptid));
-
-      if (debug_linux_nat)
-	{
-	  fprintf_unfiltered (gdb_stdlog,
-			      "WL: waitpid %s received %s\n",
-			      target_pid_to_str (lp->ptid),
-			      status_to_str (status));
-	}
-
-      /* Check if the thread has exited.  */
-      if (WIFEXITED (status) || WIFSIGNALED (status))
-	{
-	  thread_dead = 1;
-	  if (debug_linux_nat)
-	    fprintf_unfiltered (gdb_stdlog, "WL: %s exited.\n",
-				target_pid_to_str (lp->ptid));
-	}
-    }
-
   if (thread_dead)
     {
       exit_lwp (lp);
       return 0;
     }
 
-  gdb_assert (WIFSTOPPED (status));
-
-  /* Handle GNU/Linux's syscall SIGTRAPs.  */
-  if (WIFSTOPPED (status) && WSTOPSIG (status) == SYSCALL_SIGTRAP)
-    {
-      /* No longer need the sysgood bit.  The ptrace event ends up
-	 recorded in lp->waitstatus if we care for it.  We can carry
-	 on handling the event like a regular SIGTRAP from here
-	 on.  */
-      status = W_STOPCODE (SIGTRAP);
-      if (linux_handle_syscall_trap (lp, 1))
-	return wait_lwp (lp);
-    }
+  gdb_assert (pid == ptid_get_lwp (lp->ptid));
 
-  /* Handle GNU/Linux's extended waitstatus for trace events.  */
-  if (WIFSTOPPED (status) && WSTOPSIG (status) == SIGTRAP && status >> 16 != 0)
+  if (debug_linux_nat)
     {
-      if (debug_linux_nat)
-	fprintf_unfiltered (gdb_stdlog,
-			    "WL: Handling extended status 0x%06x\n",
-			    status);
-      if (linux_handle_extended_wait (lp, status, 1))
-	return wait_lwp (lp);
+      fprintf_unfiltered (gdb_stdlog,
+			  "WL: waitpid %s received %s\n",
+			  target_pid_to_str (lp->ptid),
+			  status_to_str (status));
     }
 
+  status = wait_lwp_status (lp, status);
+  if (status == -1)
+    return wait_lwp (lp);
   return status;
 }
 
@@ -2537,19 +2621,95 @@ linux_nat_set_status_is_event (struct target_ops *t,
   linux_nat_status_is_event = status_is_event;
 }
 
-/* Wait until LP is stopped.  */
+/* Handle STATUS, the stop LP reported after stop_callback signalled
+   it.  Return 1 if LP had to be resumed and has yet to report its
+   stop.  */
 
 static int
-stop_wait_callback (struct lwp_info *lp, void *data)
+stop_wait_status (struct lwp_info *lp, int status)
+{
+  if (lp->ignore_sigint && WIFSTOPPED (status)
+      && WSTOPSIG (status) == SIGINT)
+    {
+      lp->ignore_sigint = 0;
+
+      if (linux_nat_prepare_to_resume != NULL)
+	linux_nat_prepare_to_resume (lp);
+      errno = 0;
+      ptrace (PTRACE_CONT, ptid_get_lwp (lp->ptid), 0, 0);
+      if (debug_linux_nat)
+	fprintf_unfiltered (gdb_stdlog,
+			    "PTRACE_CONT %s, 0, 0 (%s) "
+			    "(discarding SIGINT)\n",
+			    target_pid_to_str (lp->ptid),
+			    errno ? safe_strerror (errno) : "OK");
+
+      return 1;
+    }
+
+  maybe_clear_ignore_sigint (lp);
+
+  if (WSTOPSIG (status) != SIGSTOP)
+    {
+      /* The thread was stopped with a signal other than SIGSTOP.  */
+
+      save_sigtrap (lp);
+
+      if (debug_linux_nat)
+	fprintf_unfiltered (gdb_stdlog,
+			    "SWC: Pending event %s in %s\n",
+			    status_to_str ((int) status),
+			    target_pid_to_str (lp->ptid));
+
+      /* Save the sigtrap event.  */
+      lp->status = status;
+      gdb_assert (!lp->stopped);
+      gdb_assert (lp->signalled);
+      lp->stopped = 1;
+    }
+  else
+    {
+      /* We caught the SIGSTOP that we intended to catch, so
+	 there's no SIGSTOP pending.  */
+
+      if (debug_linux_nat)
+	fprintf_unfiltered (gdb_stdlog,
+			    "SWC: Delayed SIGSTOP caught for %s.\n",
+			    target_pid_to_str (lp->ptid));
+
+      lp->stopped = 1;
+
+      /* Reset SIGNALLED only after the stop_wait_callback call
+	 above as it does gdb_assert on SIGNALLED.  */
+      lp->signalled = 0;
+    }
+
+  return 0;
+}
+
+/* Return non-zero if LP is still to report the stop stop_callback
+   requested.  */
+
+static int
+stop_wait_pending_p (struct lwp_info *lp)
 {
-  struct inferior *inf = find_inferior_pid (ptid_get_pid (lp->ptid));
+  struct inferior *inf;
 
-  /* If this is a vfork parent, bail out, it is not going to report
-     any SIGSTOP until the vfork is done with.  */
-  if (inf->vfork_child != NULL)
+  if (lp->stopped)
     return 0;
 
-  if (!lp->stopped)
+  /* If this is a vfork parent, it is not going to report any SIGSTOP
+     until the vfork is done with.  */
+  inf = find_inferior_pid (ptid_get_pid (lp->ptid));
+  return inf->vfork_child == NULL;
+}
+
+/* Wait until LP is stopped.  */
+
+static int
+stop_wait_callback (struct lwp_info *lp, void *data)
+{
+  if (stop_wait_pending_p (lp))
     {
       int status;
 
@@ -2557,62 +2717,66 @@ stop_wait_callback (struct lwp_info *lp, void *data)
       if (status == 0)
 	return 0;
 
-      if (lp->ignore_sigint && WIFSTOPPED (status)
-	  && WSTOPSIG (status) == SIGINT)
-	{
-	  lp->ignore_sigint = 0;
+      if (stop_wait_status (lp, status))
+	return stop_wait_callback (lp, NULL);
+    }
 
-	  errno = 0;
-	  ptrace (PTRACE_CONT, ptid_get_lwp (lp->ptid), 0, 0);
-	  if (debug_linux_nat)
-	    fprintf_unfiltered (gdb_stdlog,
-				"PTRACE_CONT %s, 0, 0 (%s) "
-				"(discarding SIGINT)\n",
-				target_pid_to_str (lp->ptid),
-				errno ? safe_strerror (errno) : "OK");
+  return 0;
+}
 
-	  return stop_wait_callback (lp, NULL);
-	}
+/* Wait until all the LWPs matching FILTER have reported back that
+   they're no longer running, like calling stop_wait_callback for each
+   of them.  stop_wait_callback blocks until the LWP it is given stops,
+   one LWP after the other.  Instead, first collect the stops that are
+   already available, sweeping over the LWPs with non-blocking waits
+   for as long as that makes progress, and only then block for the LWPs
+   that are still running.  */
+
+static void
+stop_wait_lwps (ptid_t filter)
+{
+  struct lwp_info *lp, *lpnext;
+  int progress;
 
-      maybe_clear_ignore_sigint (lp);
+  do
+    {
+      progress = 0;
 
-      if (WSTOPSIG (status) != SIGSTOP)
+      for (lp = lwp_list; lp != NULL; lp = lpnext)
 	{
-	  /* The thread was stopped with a signal other than SIGSTOP.  */
+	  int lwpid = ptid_get_lwp (lp->ptid);
+	  int pid, status;
 
-	  save_sigtrap (lp);
+	  lpnext = lp->next;
 
-	  if (debug_linux_nat)
-	    fprintf_unfiltered (gdb_stdlog,
-				"SWC: Pending event %s in %s\n",
-				status_to_str ((int) status),
-				target_pid_to_str (lp->ptid));
+	  if (!ptid_match (lp->ptid, filter) || !stop_wait_pending_p (lp))
+	    continue;
 
-	  /* Save the sigtrap event.  */
-	  lp->status = status;
-	  gdb_assert (!lp->stopped);
-	  gdb_assert (lp->signalled);
-	  lp->stopped = 1;
-	}
-      else
-	{
-	  /* We caught the SIGSTOP that we intended to catch, so
-	     there's no SIGSTOP pending.  */
+	  pid = my_waitpid (lwpid, &status,
+			    (lp->cloned ? __WCLONE : 0) | WNOHANG);
+	  if (pid == -1 && errno == ECHILD)
+	    pid = my_waitpid (lwpid, &status,
+			      (lp->cloned ? 0 : __WCLONE) | WNOHANG);
+
+	  /* Leave an LWP that has vanished to stop_wait_callback.  */
+	  if (pid <= 0)
+	    continue;
 
 	  if (debug_linux_nat)
 	    fprintf_unfiltered (gdb_stdlog,
-				"SWC: Delayed SIGSTOP caught for %s.\n",
-				target_pid_to_str (lp->ptid));
-
-	  lp->stopped = 1;
+				"SWL: waitpid %s received %s\n",
+				target_pid_to_str (lp->ptid),
+				status_to_str (status));
 
-	  /* Reset SIGNALLED only after the stop_wait_callback call
-	     above as it does gdb_assert on SIGNALLED.  */
-	  lp->signalled = 0;
+	  progress = 1;
+	  status = wait_lwp_status (lp, status);
+	  if (status > 0)
+	    stop_wait_status (lp, status);
 	}
     }
+  while (progress);
 
-  return 0;
+  iterate_over_lwps (filter, stop_wait_callback, NULL);
 }
 
 /* Return non-zero if LP has a wait status pending.  */
@@ -3501,7 +3665,7 @@ retry:
 
       /* ... and wait until all of them have reported back that
 	 they're no longer running.  */
-      iterate_over_lwps (minus_one_ptid, stop_wait_callback, NULL);
+      stop_wait_lwps (minus_one_ptid);
 
       /* If we're not waiting for a specific LWP, choose an event LWP
 	 from among those that have had events.  Giving equal priority
@@ -3785,7 +3949,7 @@ linux_nat_kill (struct target_ops *ops)
       iterate_over_lwps (ptid, stop_callback, NULL);
       /* ... and wait until all of them have reported back that
 	 they're no longer running.  */
-      iterate_over_lwps (ptid, stop_wait_callback, NULL);
+      stop_wait_lwps (ptid);
 
       /* Kill all LWP's ...  */
       iterate_over_lwps (ptid, kill_callback, NULL);
@@ -4081,10 +4245,137 @@ linux_nat_make_corefile_notes (struct target_ops *self,
 				    linux_nat_collect_thread_registers);
 }
 
-/* Implement the to_xfer_partial interface for memory reads using the /proc
-   filesystem.  Because we can use a single read() call for /proc, this
-   can be much more efficient than banging away at PTRACE_PEEKTEXT,
-   but it doesn't support writes.  */
+/* The /proc/PID/mem file of the LWP whose memory we last read through
+   the /proc filesystem, kept open to save opening it for every read,
+   or -1.  The file refers to the address space the LWP had when it
+   was opened, so it has to be closed when the LWP execs or goes
+   away.  */
+
+static int proc_mem_file = -1;
+
+/* The LWP PROC_MEM_FILE belongs to.  */
+
+static int proc_mem_file_pid;
+
+/* Close PROC_MEM_FILE if it belongs to PID, or if PID is -1.  */
+
+static void
+linux_proc_mem_file_close (int pid)
+{
+  if (proc_mem_file != -1 && (pid == -1 || pid == proc_mem_file_pid))
+    {
+      close (proc_mem_file);
+      proc_mem_file = -1;
+    }
+}
+
+/* Return an open file descriptor for the /proc/PID/mem file, or -1 if
+   it can't be opened.  */
+
+static int
+linux_proc_mem_file (int pid)
+{
+  char filename[64];
+
+  if (proc_mem_file != -1 && proc_mem_file_pid == pid)
+    return proc_mem_file;
+
+  linux_proc_mem_file_close (-1);
+
+  xsnprintf (filename, sizeof filename, "/proc/%d/mem", pid);
+  proc_mem_file = gdb_open_cloexec (filename, O_RDONLY | O_LARGEFILE, 0);
+  proc_mem_file_pid = pid;
+  return proc_mem_file;
+}
+
+/* Read LEN bytes at OFFSET from the /proc/PID/mem file into READBUF.
+   Return the number of bytes read, or -1 on error.  If the cached
+   file fails, try again with a freshly opened one, in case the
+   process has changed its address space behind our back.  */
+
+static LONGEST
+linux_proc_mem_pread (int pid, gdb_byte *readbuf, ULONGEST offset,
+		      LONGEST len)
+{
+  int attempt;
+
+  for (attempt = 0; attempt < 2; attempt++)
+    {
+      int fd = linux_proc_mem_file (pid);
+      LONGEST ret;
+
+      if (fd == -1)
+	return -1;
+
+      /* If pread64 is available, use it.  It's faster if the kernel
+	 supports it (only one syscall), and it's 64-bit safe even on
+	 32-bit platforms (for instance, SPARC debugging a SPARC64
+	 application).  */
+#ifdef HAVE_PREAD64
+      ret = pread64 (fd, readbuf, len, offset);
+#else
+      if (lseek (fd, offset, SEEK_SET) == -1)
+	ret = -1;
+      else
+	ret = read (fd, readbuf, len);
+#endif
+      if (ret > 0)
+	return ret;
+
+      linux_proc_mem_file_close (pid);
+    }
+
+  return -1;
+}
+
+/* Whether the process_vm_readv and process_vm_writev system calls
+   work.  Cleared the first time the kernel says it doesn't have
+   them.  */
+
+static int have_process_vm = 1;
+
+/* Transfer LEN bytes at OFFSET in the address space of process PID to
+   READBUF, or from WRITEBUF, with process_vm_readv or
+   process_vm_writev, which copy the memory without going through a
+   file.  Return the number of bytes transferred, or -1 on error.  */
+
+static LONGEST
+linux_proc_vm_xfer (int pid, gdb_byte *readbuf, const gdb_byte *writebuf,
+		    ULONGEST offset, LONGEST len)
+{
+#if defined (__NR_process_vm_readv) && defined (__NR_process_vm_writev)
+  struct iovec local, remote;
+  long ret;
+
+  /* The remote address has to fit in a host pointer.  */
+  if (!have_process_vm || (uintptr_t) offset != offset)
+    return -1;
+
+  local.iov_base = readbuf != NULL ? (void *) readbuf : (void *) writebuf;
+  local.iov_len = len;
+  remote.iov_base = (void *) (uintptr_t) offset;
+  remote.iov_len = len;
+
+  if (readbuf != NULL)
+    ret = syscall (__NR_process_vm_readv, pid, &local, 1, &remote, 1, 0);
+  else
+    ret = syscall (__NR_process_vm_writev, pid, &local, 1, &remote, 1, 0);
+
+  if (ret == -1 && errno == ENOSYS)
+    have_process_vm = 0;
+
+  return ret;
+#else
+  return -1;
+#endif
+}
+
+/* Implement the to_xfer_partial interface for memory accesses using
+   process_vm_readv and process_vm_writev, or for reads, the /proc
+   filesystem.  Because these take a single system call, this can be
+   much more efficient than banging away at PTRACE_PEEKTEXT.  Memory
+   they can't access, such as the read-only text of the program when
+   writing breakpoints, is left to ptrace.  */
 
 static enum target_xfer_status
 linux_proc_xfer_partial (struct target_ops *ops, enum target_object object,
@@ -4093,40 +4384,22 @@ linux_proc_xfer_partial (struct target_ops *ops, enum target_object object,
 			 ULONGEST offset, LONGEST len, ULONGEST *xfered_len)
 {
   LONGEST ret;
-  int fd;
-  char filename[64];
+  int pid;
 
-  if (object != TARGET_OBJECT_MEMORY || !readbuf)
-    return 0;
+  if (object != TARGET_OBJECT_MEMORY)
+    return TARGET_XFER_EOF;
 
   /* Don't bother for one word.  */
   if (len < 3 * sizeof (long))
     return TARGET_XFER_EOF;
 
-  /* We could keep this file open and cache it - possibly one per
-     thread.  That requires some juggling, but is even faster.  */
-  xsnprintf (filename, sizeof filename, "/proc/%d/mem",
-	     ptid_get_pid (inferior_ptid));
-  fd = gdb_open_cloexec (filename, O_RDONLY | O_LARGEFILE, 0);
-  if (fd == -1)
-    return TARGET_XFER_EOF;
-
-  /* If pread64 is available, use it.  It's faster if the kernel
-     supports it (only one syscall), and it's 64-bit safe even on
-     32-bit platforms (for instance, SPARC debugging a SPARC64
-     application).  */
-#ifdef HAVE_PREAD64
-  if (pread64 (fd, readbuf, len, offset) != len)
-#else
-  if (lseek (fd, offset, SEEK_SET) == -1 || read (fd, readbuf, len) != len)
-#endif
-    ret = 0;
-  else
-    ret = len;
+  pid = ptid_get_pid (inferior_ptid);
 
-  close (fd);
+  ret = linux_proc_vm_xfer (pid, readbuf, writebuf, offset, len);
+  if (ret <= 0 && readbuf != NULL)
+    ret = linux_proc_mem_pread (pid, readbuf, offset, len);
 
-  if (ret == 0)
+  if (ret <= 0)
     return TARGET_XFER_EOF;
   else
     {
@@ -4135,6 +4408,111 @@ linux_proc_xfer_partial (struct target_ops *ops, enum target_object object,
     }
 }
 
+/* The most ranges linux_nat_read_memory_vector passes to a single
+   process_vm_readv call; the kernel's limit is UIO_MAXIOV.  */
+
+#define MAX_READV_RANGES 1024
+
+/* Implement the to_read_memory_vector target method.  Read the ranges
+   with as few process_vm_readv calls as possible, and those it can't
+   read from the /proc filesystem; whatever is left is read by
+   default_read_memory_vector.  */
+
+static void
+linux_nat_read_memory_vector (struct target_ops *ops,
+			      struct memory_read_request *requests, int count)
+{
+  int addr_bit = gdbarch_addr_bit (target_gdbarch ());
+  ULONGEST mask = ~(ULONGEST) 0;
+  int pid, i;
+
+  if (ptid_equal (inferior_ptid, null_ptid))
+    {
+      default_read_memory_vector (ops, requests, count);
+      return;
+    }
+
+  pid = ptid_get_lwp (inferior_ptid);
+  if (pid == 0)
+    pid = ptid_get_pid (inferior_ptid);
+
+  /* See linux_xfer_partial.  */
+  if (addr_bit < (sizeof (ULONGEST) * HOST_CHAR_BIT))
+    mask = ((ULONGEST) 1 << addr_bit) - 1;
+
+#if defined (__NR_process_vm_readv)
+  if (have_process_vm)
+    {
+      int size = min (count, MAX_READV_RANGES);
+      struct iovec *local = XNEWVEC (struct iovec, size);
+      struct iovec *remote = XNEWVEC (struct iovec, size);
+
+      for (i = 0; have_process_vm && i < count; )
+	{
+	  int first = i, n = 0;
+	  long ret;
+
+	  for (; i < count && n < size; i++, n++)
+	    {
+	      ULONGEST offset = requests[i].memaddr & mask;
+
+	      if ((uintptr_t) offset != offset)
+		break;
+	      local[n].iov_base = requests[i].buf;
+	      local[n].iov_len = requests[i].len;
+	      remote[n].iov_base = (void *) (uintptr_t) offset;
+	      remote[n].iov_len = requests[i].len;
+	    }
+	  if (n == 0)
+	    break;
+
+	  /* The call stops at the first range it can't read entirely,
+	     and returns how much it read.  */
+	  ret = syscall (__NR_process_vm_readv, pid, local, n, remote, n, 0);
+	  if (ret == -1 && errno == ENOSYS)
+	    have_process_vm = 0;
+
+	  for (; first < i && ret > 0; first++)
+	    {
+	      struct memory_read_request *req = &requests[first];
+
+	      req->status = TARGET_XFER_OK;
+	      req->xfered_len = min (ret, req->len);
+	      ret -= req->xfered_len;
+	      if (req->xfered_len < req->len)
+		break;
+	    }
+
+	  /* Go on after the range the call stopped at.  */
+	  if (first < i)
+	    i = first + 1;
+	}
+
+      xfree (local);
+      xfree (remote);
+    }
+#endif
+
+  for (i = 0; i < count; i++)
+    {
+      struct memory_read_request *req = &requests[i];
+      LONGEST ret;
+
+      if (req->status == TARGET_XFER_OK && req->xfered_len == req->len)
+	continue;
+
+      ret = linux_proc_mem_pread (pid, req->buf, req->memaddr & mask,
+				  req->len);
+      if (ret > 0)
+	{
+	  req->status = TARGET_XFER_OK;
+	  req->xfered_len = ret;
+	}
+    }
+
+  default_read_memory_vector (ops, requests, count);
+}
+
 
 /* Enumerate spufs IDs for process PID.  */
 static LONGEST
@@ -4840,6 +5218,7 @@ linux_nat_add_target (struct target_ops *t)
   t->to_wait = linux_nat_wait;
   t->to_pass_signals = linux_nat_pass_signals;
   t->to_xfer_partial = linux_nat_xfer_partial;
+  t->to_read_memory_vector = linux_nat_read_memory_vector;
   t->to_kill = linux_nat_kill;
   t->to_mourn_inferior = linux_nat_mourn_inferior;
   t->to_thread_alive = linux_nat_thread_alive;
@@ -95,7 +95,8 @@ struct lwp_info
   /* Arch-specific additions.  */
   struct arch_lwp_info *arch_private;
 
-  /* Next LWP in list.  */
+  /* Previous and next LWP in list.  */
+  struct lwp_info *prev;
   struct lwp_info *next;
 };
 
@@ -126,6 +127,9 @@ extern int lin_lwp_attach_lwp (ptid_t ptid);
 
 extern void linux_stop_lwp (struct lwp_info *lwp);
 
+/* Return the LWP corresponding to PTID, or NULL if there is none.  */
+extern struct lwp_info *find_lwp_pid (ptid_t ptid);
+
 /* Iterator function for lin-lwp's lwp list.  */
 struct lwp_info *iterate_over_lwps (ptid_t filter,
 				    int (*callback) (struct lwp_info *,
@@ -336,6 +336,47 @@ iterate_over_minimal_symbols (struct objfile *objf, const char *name,
 
 /* See minsyms.h.  */
 
+void
+iterate_over_minimal_symbols_with_prefix
+  (struct objfile *objf, const char *prefix, int len,
+   void (*callback) (struct minimal_symbol *, void *),
+   void *user_data)
+{
+  struct minimal_symbol **by_name = objf->per_bfd->msymbols_by_name;
+  int (*ncmp) (const char *, const char *, size_t);
+  int low, high;
+
+  if (by_name == NULL)
+    return;
+
+  /* Find the first symbol whose name, ignoring case, is not less than
+     PREFIX.  */
+  low = 0;
+  high = objf->per_bfd->minimal_symbol_count;
+  while (low < high)
+    {
+      int mid = low + (high - low) / 2;
+
+      if (strncasecmp (MSYMBOL_NATURAL_NAME (by_name[mid]), prefix, len) < 0)
+	low = mid + 1;
+      else
+	high = mid;
+    }
+
+  ncmp = (case_sensitivity == case_sensitive_on ? strncmp : strncasecmp);
+  for (; low < objf->per_bfd->minimal_symbol_count; ++low)
+    {
+      const char *name = MSYMBOL_NATURAL_NAME (by_name[low]);
+
+      if (strncasecmp (name, prefix, len) != 0)
+	break;
+      if (ncmp (name, prefix, len) == 0)
+	(*callback) (by_name[low], user_data);
+    }
+}
+
+/* See minsyms.h.  */
+
 struct bound_minimal_symbol
 lookup_minimal_symbol_text (const char *name, struct objfile *objf)
 {
@@ -1169,6 +1210,49 @@ build_minimal_symbol_hash_tables (struct objfile *objfile)
     }
 }
 
+/* Compare the natural names of two minimal symbols, for sorting the
+   name index.  See the comment for msymbols_by_name.  Symbols with
+   identical names are kept in table order.  */
+
+static int
+compare_minimal_symbol_names (const void *ap, const void *bp)
+{
+  struct minimal_symbol *const *a = ap;
+  struct minimal_symbol *const *b = bp;
+  const char *name1 = MSYMBOL_NATURAL_NAME (*a);
+  const char *name2 = MSYMBOL_NATURAL_NAME (*b);
+  int cmp;
+
+  cmp = strcasecmp (name1, name2);
+  if (cmp == 0)
+    cmp = strcmp (name1, name2);
+  if (cmp == 0 && *a != *b)
+    cmp = *a < *b ? -1 : 1;
+  return cmp;
+}
+
+/* Build the name index of the minimal symbols of OBJFILE.  Like the
+   hash tables, this must be rebuilt whenever the table changes.  */
+
+static void
+build_minimal_symbol_name_index (struct objfile *objfile)
+{
+  struct objfile_per_bfd_storage *per_bfd = objfile->per_bfd;
+  struct minimal_symbol **by_name;
+  int i;
+
+  by_name = obstack_alloc (&per_bfd->storage_obstack,
+			   (per_bfd->minimal_symbol_count
+			    * sizeof (struct minimal_symbol *)));
+  for (i = 0; i < per_bfd->minimal_symbol_count; i++)
+    by_name[i] = &per_bfd->msymbols[i];
+
+  qsort (by_name, per_bfd->minimal_symbol_count,
+	 sizeof (struct minimal_symbol *), compare_minimal_symbol_names);
+
+  per_bfd->msymbols_by_name = by_name;
+}
+
 /* Add the minimal symbols in the existing bunches to the objfile's official
    minimal symbol table.  In most cases there is no minimal symbol table yet
    for this objfile, and the existing bunches are used to create one.  Once
@@ -1282,6 +1366,7 @@ install_minimal_symbols (struct objfile *objfile)
 	 yet.  (And if the msymbol obstack gets moved, all the internal
 	 pointers to other msymbols need to be adjusted.)  */
       build_minimal_symbol_hash_tables (objfile);
+      build_minimal_symbol_name_index (objfile);
     }
 }
 
@@ -244,6 +244,20 @@ void iterate_over_minimal_symbols (struct objfile *objf,
 						     void *),
 				   void *user_data);
 
+/* Iterate over all the minimal symbols in the objfile OBJF whose
+   natural name starts with the first LEN characters of PREFIX.  The
+   comparison ignores case if case_sensitivity is off.  The symbols
+   are found through a sorted index, so this does not walk the whole
+   minimal symbol table.
+
+   For each matching symbol, CALLBACK is called with the symbol and
+   USER_DATA as arguments.  */
+
+void iterate_over_minimal_symbols_with_prefix
+  (struct objfile *objf, const char *prefix, int len,
+   void (*callback) (struct minimal_symbol *, void *),
+   void *user_data);
+
 /* Compute the upper bound of MINSYM.  The upper bound is the last
    address thought to be part of the symbol.  If the symbol has a
    size, it is used.  Otherwise use the lesser of the next minimal
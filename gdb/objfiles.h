@@ -247,6 +247,14 @@ struct objfile_per_bfd_storage
      demangled names.  */
 
   struct minimal_symbol *msymbol_demangled_hash[MINIMAL_SYMBOL_HASH_SIZE];
+
+  /* The minimal symbols, sorted by natural name.  Names are compared
+     ignoring case first, so that the symbols starting with a given
+     prefix are adjacent whatever the case sensitivity.  This has
+     MINIMAL_SYMBOL_COUNT entries, and is allocated on the
+     storage_obstack.  */
+
+  struct minimal_symbol **msymbols_by_name;
 };
 
 /* Master structure for keeping track of each file from which
@@ -416,6 +424,10 @@ struct objfile
     struct symbol *template_symbols;
   };
 
+typedef struct objfile *objfilep;
+
+DEF_VEC_P (objfilep);
+
 /* Defines for the objfile flag word.  */
 
 /* When an object file has its functions reordered (currently Irix-5.2
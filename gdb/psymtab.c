@@ -53,10 +53,7 @@ static struct partial_symbol *match_partial_symbol (struct objfile *,
 						    symbol_compare_ftype *,
 						    symbol_compare_ftype *);
 
-static struct partial_symbol *lookup_partial_symbol (struct objfile *,
-						     struct partial_symtab *,
-						     const char *, int,
-						     domain_enum);
+static char *psymtab_search_name (const char *name);
 
 static const char *psymtab_to_fullname (struct partial_symtab *ps);
 
@@ -377,8 +374,25 @@ find_pc_sect_symtab_from_partial (struct objfile *objfile,
 				  CORE_ADDR pc, struct obj_section *section,
 				  int warn_if_readin)
 {
-  struct partial_symtab *ps = find_pc_sect_psymtab (objfile, pc, section,
-						    msymbol);
+  struct partial_symtab *ps;
+
+  /* If the partial symbols of OBJFILE have not been read yet, only
+     read them if PC is actually in OBJFILE (or in the objfile whose
+     separate debug info it holds).  Otherwise every PC lookup would
+     defeat "set lazy-symbol-reading".  */
+  if ((objfile->flags & OBJF_PSYMTABS_READ) == 0)
+    {
+      struct obj_section *osect = section;
+
+      if (osect == NULL)
+	osect = find_pc_section (pc);
+      if (osect == NULL
+	  || (osect->objfile != objfile
+	      && osect->objfile != objfile->separate_debug_objfile_backlink))
+	return NULL;
+    }
+
+  ps = find_pc_sect_psymtab (objfile, pc, section, msymbol);
   if (ps)
     {
       if (warn_if_readin && ps->readin)
@@ -495,46 +509,386 @@ fixup_psymbol_section (struct partial_symbol *psym, struct objfile *objfile)
   fixup_section (&psym->ginfo, addr, objfile);
 }
 
+/* An index of all the partial symbols of an objfile, sorted by
+   name.  This lets a lookup find every psymtab defining a given name
+   with a single binary search, instead of searching the symbols of
+   each psymtab in turn.  The index is built lazily, on the first
+   lookup, and is discarded whenever the partial symbols of the
+   objfile change.
+
+   To keep the index small, an entry is just the position of a symbol
+   in the objfile's global_psymbols list, or, past the end of that
+   list, in its static_psymbols list.  The psymtab holding a symbol is
+   found from its position, as each psymtab's symbols are contiguous
+   in the lists.  */
+
+struct psymbol_name_index
+{
+  /* The psymtabs of the objfile, in the order of the psymtab
+     chain.  */
+  int n_psymtabs;
+  struct partial_symtab **psymtabs;
+
+  /* The ordinals of the psymtabs having global symbols, and of those
+     having static symbols, sorted by where their symbols start in the
+     global_psymbols or static_psymbols list.  */
+  int n_global_psymtabs, n_static_psymtabs;
+  int *global_psymtabs, *static_psymtabs;
+
+  /* The length of the global_psymbols list.  */
+  unsigned int n_globals;
+
+  /* The entries, sorted by name.  */
+  int n_entries;
+  unsigned int *entries;
+};
+
+static const struct objfile_data *psymbol_name_index_key;
+
+typedef struct partial_symtab *partial_symtab_p;
+DEF_VEC_P (partial_symtab_p);
+
+/* Return the partial symbol of OBJFILE at position ENTRY in the name
+   index INDEX.  */
+
+static struct partial_symbol *
+psymbol_name_index_symbol (struct objfile *objfile,
+			   const struct psymbol_name_index *index,
+			   unsigned int entry)
+{
+  if (entry < index->n_globals)
+    return objfile->global_psymbols.list[entry];
+  return objfile->static_psymbols.list[entry - index->n_globals];
+}
+
+/* Return the ordinal of the psymtab holding the partial symbol at
+   position ENTRY in the name index INDEX.  */
+
+static int
+psymbol_name_index_psymtab (const struct psymbol_name_index *index,
+			    unsigned int entry)
+{
+  const int *ordinals;
+  int low, high, global;
+
+  global = entry < index->n_globals;
+  if (global)
+    {
+      ordinals = index->global_psymtabs;
+      high = index->n_global_psymtabs;
+    }
+  else
+    {
+      ordinals = index->static_psymtabs;
+      high = index->n_static_psymtabs;
+      entry -= index->n_globals;
+    }
+
+  /* Find the last psymtab whose symbols start at or before ENTRY.  */
+  low = 0;
+  while (high - low > 1)
+    {
+      int mid = low + (high - low) / 2;
+      struct partial_symtab *ps = index->psymtabs[ordinals[mid]];
+
+      if ((global ? ps->globals_offset : ps->statics_offset) <= entry)
+	low = mid;
+      else
+	high = mid;
+    }
+
+  return ordinals[low];
+}
+
+/* Free the name index INDEX.  */
+
+static void
+free_psymbol_name_index (struct psymbol_name_index *index)
+{
+  xfree (index->psymtabs);
+  xfree (index->global_psymtabs);
+  xfree (index->static_psymtabs);
+  xfree (index->entries);
+  xfree (index);
+}
+
+/* The objfile_data cleanup for psymbol_name_index_key.  */
+
+static void
+psymbol_name_index_cleanup (struct objfile *objfile, void *arg)
+{
+  struct psymbol_name_index *index = arg;
+
+  if (index != NULL)
+    free_psymbol_name_index (index);
+}
+
+/* Discard the name index of OBJFILE, if any.  This must be called
+   whenever the partial symbols or psymtabs of OBJFILE change.  */
+
+static void
+discard_psymbol_name_index (struct objfile *objfile)
+{
+  struct psymbol_name_index *index;
+
+  index = objfile_data (objfile, psymbol_name_index_key);
+  if (index != NULL)
+    {
+      free_psymbol_name_index (index);
+      set_objfile_data (objfile, psymbol_name_index_key, NULL);
+    }
+}
+
+/* The objfile and the name index being sorted by
+   get_psymbol_name_index.  qsort does not pass them to the comparison
+   functions.  */
+
+static struct objfile *psymbol_name_index_sort_objfile;
+static struct psymbol_name_index *psymbol_name_index_sort_index;
+
+/* qsort comparison function for name index entries.  Entries with
+   the same name are kept in the order of the psymbol lists.  */
+
+static int
+compare_psymbol_name_index_entries (const void *ap, const void *bp)
+{
+  unsigned int a = *(const unsigned int *) ap;
+  unsigned int b = *(const unsigned int *) bp;
+  struct partial_symbol *psym_a, *psym_b;
+  int cmp;
+
+  psym_a = psymbol_name_index_symbol (psymbol_name_index_sort_objfile,
+				      psymbol_name_index_sort_index, a);
+  psym_b = psymbol_name_index_symbol (psymbol_name_index_sort_objfile,
+				      psymbol_name_index_sort_index, b);
+  cmp = strcmp_iw_ordered (SYMBOL_SEARCH_NAME (psym_a),
+			   SYMBOL_SEARCH_NAME (psym_b));
+  if (cmp != 0)
+    return cmp;
+
+  return (a > b) - (b > a);
+}
+
+/* qsort comparison functions for psymtab ordinals, which sort them by
+   where the symbols of the psymtab start in the global_psymbols or
+   static_psymbols list.  */
+
+static int
+compare_psymtabs_by_globals (const void *ap, const void *bp)
+{
+  struct partial_symtab *a
+    = psymbol_name_index_sort_index->psymtabs[*(const int *) ap];
+  struct partial_symtab *b
+    = psymbol_name_index_sort_index->psymtabs[*(const int *) bp];
+
+  return ((a->globals_offset > b->globals_offset)
+	  - (b->globals_offset > a->globals_offset));
+}
+
+static int
+compare_psymtabs_by_statics (const void *ap, const void *bp)
+{
+  struct partial_symtab *a
+    = psymbol_name_index_sort_index->psymtabs[*(const int *) ap];
+  struct partial_symtab *b
+    = psymbol_name_index_sort_index->psymtabs[*(const int *) bp];
+
+  return ((a->statics_offset > b->statics_offset)
+	  - (b->statics_offset > a->statics_offset));
+}
+
+/* Return the name index of OBJFILE, building it if needed.  */
+
+static struct psymbol_name_index *
+get_psymbol_name_index (struct objfile *objfile)
+{
+  struct psymbol_name_index *index;
+  struct partial_symtab *ps;
+  int n_psymtabs = 0, n_entries = 0, i, j;
+
+  /* This may read in the partial symbols, which would discard any
+     existing index; so do it first.  */
+  require_partial_symbols (objfile, 1);
+
+  index = objfile_data (objfile, psymbol_name_index_key);
+  if (index != NULL)
+    return index;
+
+  ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, ps)
+    {
+      ++n_psymtabs;
+      n_entries += ps->n_global_syms + ps->n_static_syms;
+    }
+
+  index = XCNEW (struct psymbol_name_index);
+  index->n_psymtabs = n_psymtabs;
+  index->psymtabs = XNEWVEC (struct partial_symtab *, n_psymtabs);
+  index->global_psymtabs = XNEWVEC (int, n_psymtabs);
+  index->static_psymtabs = XNEWVEC (int, n_psymtabs);
+  index->n_globals = (objfile->global_psymbols.next
+		      - objfile->global_psymbols.list);
+  index->n_entries = n_entries;
+  index->entries = XNEWVEC (unsigned int, n_entries);
+
+  i = 0;
+  j = 0;
+  ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, ps)
+    {
+      int k;
+
+      index->psymtabs[i] = ps;
+      if (ps->n_global_syms > 0)
+	index->global_psymtabs[index->n_global_psymtabs++] = i;
+      if (ps->n_static_syms > 0)
+	index->static_psymtabs[index->n_static_psymtabs++] = i;
+
+      for (k = 0; k < ps->n_global_syms; ++k)
+	index->entries[j++] = ps->globals_offset + k;
+      for (k = 0; k < ps->n_static_syms; ++k)
+	index->entries[j++] = index->n_globals + ps->statics_offset + k;
+
+      ++i;
+    }
+
+  psymbol_name_index_sort_objfile = objfile;
+  psymbol_name_index_sort_index = index;
+  qsort (index->global_psymtabs, index->n_global_psymtabs, sizeof (int),
+	 compare_psymtabs_by_globals);
+  qsort (index->static_psymtabs, index->n_static_psymtabs, sizeof (int),
+	 compare_psymtabs_by_statics);
+  qsort (index->entries, n_entries, sizeof (unsigned int),
+	 compare_psymbol_name_index_entries);
+
+  set_objfile_data (objfile, psymbol_name_index_key, index);
+  return index;
+}
+
+/* Return, in psymtab chain order, the psymtabs of OBJFILE that define
+   a partial symbol named NAME in DOMAIN.  Global symbols are
+   considered if GLOBAL is non-zero, and static symbols if STATIC_P is
+   non-zero.  The caller must free the result.  */
+
+static VEC (partial_symtab_p) *
+lookup_psymtabs_by_name (struct objfile *objfile, const char *name,
+			 int global, int static_p, domain_enum domain)
+{
+  struct psymbol_name_index *index = get_psymbol_name_index (objfile);
+  VEC (int) *ordinals = NULL;
+  VEC (partial_symtab_p) *result = NULL;
+  struct cleanup *cleanup;
+  char *search_name;
+  int low, high, ix, ordinal, last;
+
+  search_name = psymtab_search_name (name);
+  cleanup = make_cleanup (xfree, search_name);
+  make_cleanup (VEC_cleanup (int), &ordinals);
+
+  /* Find the first entry whose name is not less than SEARCH_NAME.  */
+  low = 0;
+  high = index->n_entries;
+  while (low < high)
+    {
+      int mid = low + (high - low) / 2;
+      struct partial_symbol *psym
+	= psymbol_name_index_symbol (objfile, index, index->entries[mid]);
+
+      if (strcmp_iw_ordered (SYMBOL_SEARCH_NAME (psym), search_name) < 0)
+	low = mid + 1;
+      else
+	high = mid;
+    }
+
+  /* For `case_sensitivity == case_sensitive_off' strcmp_iw_ordered will
+     search more exactly than what matches SYMBOL_MATCHES_SEARCH_NAME.  */
+  while (low > 0
+	 && SYMBOL_MATCHES_SEARCH_NAME (psymbol_name_index_symbol
+					(objfile, index,
+					 index->entries[low - 1]),
+					search_name))
+    --low;
+
+  for (; low < index->n_entries; ++low)
+    {
+      unsigned int entry = index->entries[low];
+      struct partial_symbol *psym = psymbol_name_index_symbol (objfile,
+							       index, entry);
+      int is_global = entry < index->n_globals;
+
+      if (!SYMBOL_MATCHES_SEARCH_NAME (psym, search_name))
+	break;
+
+      if ((is_global ? global : static_p)
+	  && PSYMBOL_DOMAIN (psym) == domain)
+	VEC_safe_push (int, ordinals,
+		       psymbol_name_index_psymtab (index, entry));
+    }
+
+  /* Symbols with different names can match SEARCH_NAME, so the
+     psymtabs found above are not necessarily in order.  */
+  qsort (VEC_address (int, ordinals), VEC_length (int, ordinals),
+	 sizeof (int), compare_positive_ints);
+  last = -1;
+  for (ix = 0; VEC_iterate (int, ordinals, ix, ordinal); ++ix)
+    {
+      if (ordinal != last)
+	VEC_safe_push (partial_symtab_p, result, index->psymtabs[ordinal]);
+      last = ordinal;
+    }
+
+  do_cleanups (cleanup);
+  return result;
+}
+
 static struct symtab *
 lookup_symbol_aux_psymtabs (struct objfile *objfile,
 			    int block_index, const char *name,
 			    const domain_enum domain)
 {
+  VEC (partial_symtab_p) *psymtabs;
   struct partial_symtab *ps;
-  const int psymtab_index = (block_index == GLOBAL_BLOCK ? 1 : 0);
+  struct cleanup *cleanup;
   struct symtab *stab_best = NULL;
+  int ix;
 
-  ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, ps)
-  {
-    if (!ps->readin && lookup_partial_symbol (objfile, ps, name,
-					      psymtab_index, domain))
-      {
-	struct symbol *sym = NULL;
-	struct symtab *stab = psymtab_to_symtab (objfile, ps);
+  psymtabs = lookup_psymtabs_by_name (objfile, name,
+				      block_index == GLOBAL_BLOCK,
+				      block_index != GLOBAL_BLOCK, domain);
+  cleanup = make_cleanup (VEC_cleanup (partial_symtab_p), &psymtabs);
 
-	/* Some caution must be observed with overloaded functions
-	   and methods, since the psymtab will not contain any overload
-	   information (but NAME might contain it).  */
-	if (stab->primary)
-	  {
-	    struct blockvector *bv = BLOCKVECTOR (stab);
-	    struct block *block = BLOCKVECTOR_BLOCK (bv, block_index);
+  for (ix = 0; VEC_iterate (partial_symtab_p, psymtabs, ix, ps); ++ix)
+    {
+      if (!ps->readin)
+	{
+	  struct symbol *sym = NULL;
+	  struct symtab *stab = psymtab_to_symtab (objfile, ps);
 
-	    sym = lookup_block_symbol (block, name, domain);
-	  }
+	  /* Some caution must be observed with overloaded functions
+	     and methods, since the psymtab will not contain any overload
+	     information (but NAME might contain it).  */
+	  if (stab->primary)
+	    {
+	      struct blockvector *bv = BLOCKVECTOR (stab);
+	      struct block *block = BLOCKVECTOR_BLOCK (bv, block_index);
 
-	if (sym && strcmp_iw (SYMBOL_SEARCH_NAME (sym), name) == 0)
-	  {
-	    if (!TYPE_IS_OPAQUE (SYMBOL_TYPE (sym)))
-	      return stab;
+	      sym = lookup_block_symbol (block, name, domain);
+	    }
 
-	    stab_best = stab;
-	  }
+	  if (sym && strcmp_iw (SYMBOL_SEARCH_NAME (sym), name) == 0)
+	    {
+	      if (!TYPE_IS_OPAQUE (SYMBOL_TYPE (sym)))
+		{
+		  do_cleanups (cleanup);
+		  return stab;
+		}
 
-	/* Keep looking through other psymtabs.  */
-      }
-  }
+	      stab_best = stab;
+	    }
 
+	  /* Keep looking through other psymtabs.  */
+	}
+    }
+
+  do_cleanups (cleanup);
   return stab_best;
 }
 
@@ -649,109 +1003,6 @@ psymtab_search_name (const char *name)
   return xstrdup (name);
 }
 
-/* Look, in partial_symtab PST, for symbol whose natural name is NAME.
-   Check the global symbols if GLOBAL, the static symbols if not.  */
-
-static struct partial_symbol *
-lookup_partial_symbol (struct objfile *objfile,
-		       struct partial_symtab *pst, const char *name,
-		       int global, domain_enum domain)
-{
-  struct partial_symbol **start, **psym;
-  struct partial_symbol **top, **real_top, **bottom, **center;
-  int length = (global ? pst->n_global_syms : pst->n_static_syms);
-  int do_linear_search = 1;
-  char *search_name;
-  struct cleanup *cleanup;
-
-  if (length == 0)
-    {
-      return (NULL);
-    }
-
-  search_name = psymtab_search_name (name);
-  cleanup = make_cleanup (xfree, search_name);
-  start = (global ?
-	   objfile->global_psymbols.list + pst->globals_offset :
-	   objfile->static_psymbols.list + pst->statics_offset);
-
-  if (global)			/* This means we can use a binary search.  */
-    {
-      do_linear_search = 0;
-
-      /* Binary search.  This search is guaranteed to end with center
-         pointing at the earliest partial symbol whose name might be
-         correct.  At that point *all* partial symbols with an
-         appropriate name will be checked against the correct
-         domain.  */
-
-      bottom = start;
-      top = start + length - 1;
-      real_top = top;
-      while (top > bottom)
-	{
-	  center = bottom + (top - bottom) / 2;
-	  if (!(center < top))
-	    internal_error (__FILE__, __LINE__,
-			    _("failed internal consistency check"));
-	  if (!do_linear_search
-	      && SYMBOL_LANGUAGE (*center) == language_java)
-	    {
-	      do_linear_search = 1;
-	    }
-	  if (strcmp_iw_ordered (SYMBOL_SEARCH_NAME (*center),
-				 search_name) >= 0)
-	    {
-	      top = center;
-	    }
-	  else
-	    {
-	      bottom = center + 1;
-	    }
-	}
-      if (!(top == bottom))
-	internal_error (__FILE__, __LINE__,
-			_("failed internal consistency check"));
-
-      /* For `case_sensitivity == case_sensitive_off' strcmp_iw_ordered will
-	 search more exactly than what matches SYMBOL_MATCHES_SEARCH_NAME.  */
-      while (top >= start && SYMBOL_MATCHES_SEARCH_NAME (*top, search_name))
-	top--;
-
-      /* Fixup to have a symbol which matches SYMBOL_MATCHES_SEARCH_NAME.  */
-      top++;
-
-      while (top <= real_top && SYMBOL_MATCHES_SEARCH_NAME (*top, search_name))
-	{
-	  if (SYMBOL_DOMAIN (*top) == domain)
-	    {
-	      do_cleanups (cleanup);
-	      return (*top);
-	    }
-	  top++;
-	}
-    }
-
-  /* Can't use a binary search or else we found during the binary search that
-     we should also do a linear search.  */
-
-  if (do_linear_search)
-    {
-      for (psym = start; psym < start + length; psym++)
-	{
-	  if (SYMBOL_DOMAIN (*psym) == domain
-	      && SYMBOL_MATCHES_SEARCH_NAME (*psym, search_name))
-	    {
-	      do_cleanups (cleanup);
-	      return (*psym);
-	    }
-	}
-    }
-
-  do_cleanups (cleanup);
-  return (NULL);
-}
-
 /* Get the symbol table that corresponds to a partial_symtab.
    This is fast after the first time you do it.  */
 
@@ -1078,19 +1329,21 @@ dump_psymtabs_for_objfile (struct objfile *objfile)
 static void
 read_symtabs_for_function (struct objfile *objfile, const char *func_name)
 {
+  VEC (partial_symtab_p) *psymtabs;
   struct partial_symtab *ps;
+  struct cleanup *cleanup;
+  int ix;
 
-  ALL_OBJFILE_PSYMTABS_REQUIRED (objfile, ps)
-  {
-    if (ps->readin)
-      continue;
+  psymtabs = lookup_psymtabs_by_name (objfile, func_name, 1, 1, VAR_DOMAIN);
+  cleanup = make_cleanup (VEC_cleanup (partial_symtab_p), &psymtabs);
 
-    if ((lookup_partial_symbol (objfile, ps, func_name, 1, VAR_DOMAIN)
-	 != NULL)
-	|| (lookup_partial_symbol (objfile, ps, func_name, 0, VAR_DOMAIN)
-	    != NULL))
-      psymtab_to_symtab (objfile, ps);
-  }
+  for (ix = 0; VEC_iterate (partial_symtab_p, psymtabs, ix, ps); ++ix)
+    {
+      if (!ps->readin)
+	psymtab_to_symtab (objfile, ps);
+    }
+
+  do_cleanups (cleanup);
 }
 
 static void
@@ -1449,6 +1702,8 @@ compare_psymbols (const void *s1p, const void *s2p)
 void
 sort_pst_symbols (struct objfile *objfile, struct partial_symtab *pst)
 {
+  discard_psymbol_name_index (objfile);
+
   /* Sort the global list; don't sort the static list.  */
 
   qsort (objfile->global_psymbols.list + pst->globals_offset,
@@ -1680,6 +1935,7 @@ add_psymbol_to_list (const char *name, int namelength, int copy_name,
 
   /* Save pointer to partial symbol in psymtab, growing symtab if needed.  */
   append_psymbol_to_list (list, psym, objfile);
+  discard_psymbol_name_index (objfile);
 }
 
 /* Initialize storage for partial symbols.  */
@@ -1687,6 +1943,8 @@ add_psymbol_to_list (const char *name, int namelength, int copy_name,
 void
 init_psymbol_list (struct objfile *objfile, int total_symbols)
 {
+  discard_psymbol_name_index (objfile);
+
   /* Free any previously allocated psymbol lists.  */
 
   if (objfile->global_psymbols.list)
@@ -1726,6 +1984,8 @@ allocate_psymtab (const char *filename, struct objfile *objfile)
 {
   struct partial_symtab *psymtab;
 
+  discard_psymbol_name_index (objfile);
+
   if (objfile->free_psymtabs)
     {
       psymtab = objfile->free_psymtabs;
@@ -1776,6 +2036,8 @@ discard_psymtab (struct objfile *objfile, struct partial_symtab *pst)
 {
   struct partial_symtab **prev_pst;
 
+  discard_psymbol_name_index (objfile);
+
   /* From dbxread.c:
      Empty psymtabs happen as a result of header files which don't
      have any symbols in them.  There can be a lot of them.  But this
@@ -2088,6 +2350,9 @@ extern initialize_file_ftype _initialize_psymtab;
 void
 _initialize_psymtab (void)
 {
+  psymbol_name_index_key
+    = register_objfile_data_with_cleanup (NULL, psymbol_name_index_cleanup);
+
   add_cmd ("psymbols", class_maintenance, maintenance_print_psymbols, _("\
 Print dump of current partial symbol definitions.\n\
 Entries in the partial symbol table are dumped to file OUTFILE.\n\
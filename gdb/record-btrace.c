@@ -1903,6 +1903,7 @@ init_record_btrace_ops (void)
   ops->to_call_history_range = record_btrace_call_history_range;
   ops->to_record_is_replaying = record_btrace_is_replaying;
   ops->to_xfer_partial = record_btrace_xfer_partial;
+  ops->to_read_memory_vector = default_read_memory_vector;
   ops->to_remove_breakpoint = record_btrace_remove_breakpoint;
   ops->to_insert_breakpoint = record_btrace_insert_breakpoint;
   ops->to_fetch_registers = record_btrace_fetch_registers;
@@ -1914,6 +1915,7 @@ init_record_btrace_ops (void)
   ops->to_wait = record_btrace_wait;
   ops->to_find_new_threads = record_btrace_find_new_threads;
   ops->to_thread_alive = record_btrace_thread_alive;
+  ops->to_threads_alive = default_threads_alive;
   ops->to_goto_record_begin = record_btrace_goto_begin;
   ops->to_goto_record_end = record_btrace_goto_end;
   ops->to_goto_record = record_btrace_goto;
@@ -1904,6 +1904,7 @@ init_record_full_ops (void)
   record_full_ops.to_kill = record_kill;
   record_full_ops.to_store_registers = record_full_store_registers;
   record_full_ops.to_xfer_partial = record_full_xfer_partial;
+  record_full_ops.to_read_memory_vector = default_read_memory_vector;
   record_full_ops.to_insert_breakpoint = record_full_insert_breakpoint;
   record_full_ops.to_remove_breakpoint = record_full_remove_breakpoint;
   record_full_ops.to_stopped_by_watchpoint = record_full_stopped_by_watchpoint;
@@ -2142,6 +2143,7 @@ init_record_full_core_ops (void)
   record_full_core_ops.to_prepare_to_store = record_full_core_prepare_to_store;
   record_full_core_ops.to_store_registers = record_full_core_store_registers;
   record_full_core_ops.to_xfer_partial = record_full_core_xfer_partial;
+  record_full_core_ops.to_read_memory_vector = default_read_memory_vector;
   record_full_core_ops.to_insert_breakpoint
     = record_full_core_insert_breakpoint;
   record_full_core_ops.to_remove_breakpoint
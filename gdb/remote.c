@@ -46,6 +46,7 @@
 #include "gdb_bfd.h"
 #include "filestuff.h"
 #include "rsp-low.h"
+#include "target-dcache.h"
 
 #include <sys/time.h>
 
@@ -117,6 +118,10 @@ static void extended_remote_mourn (struct target_ops *);
 
 static void remote_mourn_1 (struct target_ops *);
 
+#if defined(HAVE_LIBEXPAT)
+static int remote_get_threads_with_qxfer (void);
+#endif
+
 static void remote_send (char **buf, long *sizeof_buf_p);
 
 static int readchar (int timeout);
@@ -147,6 +152,13 @@ static void skip_frame (void);
 
 static long read_frame (char **buf_p, long *sizeof_buf);
 
+static int remote_can_pipeline (void);
+
+static void remote_pipeline (int count,
+			     void (*make_request) (int i, void *data),
+			     int (*handle_reply) (int i, void *data),
+			     void *data);
+
 static int hexnumlen (ULONGEST num);
 
 static void init_remote_ops (void);
@@ -255,6 +267,15 @@ struct vCont_action_support
 
 static int use_range_stepping = 1;
 
+/* Whether to ask the remote stub to compress the packet stream.  */
+
+static int remote_compression = 0;
+
+/* How many bytes of the stack of a stopped thread to ask the remote
+   stub to send in stop replies.  */
+
+static unsigned int remote_stack_prefetch = 0;
+
 #define OPAQUETHREADBYTES 8
 
 /* a 64 bit opaque identifier */
@@ -303,6 +324,12 @@ struct remote_state
      reliable.  */
   int noack_mode;
 
+  /* The streams that compress the packets we send and decompress the
+     packets we receive, if we negotiated packet compression with
+     QCompress.  NULL otherwise.  */
+  struct rsp_zstream *deflate_stream;
+  struct rsp_zstream *inflate_stream;
+
   /* True if we're connected in extended remote mode.  */
   int extended;
 
@@ -343,6 +370,15 @@ struct remote_state
      the target know about program signals list changes.  */
   char *last_program_signals_packet;
 
+  /* The last QStackPrefetch packet sent to the target, or NULL if we
+     have not sent one on this connection.  */
+  char *last_stack_prefetch_packet;
+
+  /* The generation of the remote thread list GDB's thread list was
+     last brought up to date with, as reported by qXfer:threads:read,
+     or 0 if unknown.  */
+  ULONGEST thread_list_generation;
+
   enum gdb_signal last_sent_signal;
 
   int last_sent_step;
@@ -1333,6 +1369,25 @@ enum {
   /* Support for qXfer:libraries-svr4:read with a non-empty annex.  */
   PACKET_augmented_libraries_svr4_read_feature,
 
+  /* Support for reading several ranges of memory at once.  */
+  PACKET_vReadMemory,
+
+  /* Support for compressing the packet stream.  */
+  PACKET_QCompress,
+
+  /* Support for receiving requests before replying to the previous
+     ones.  */
+  PACKET_pipelining_feature,
+
+  /* Support for sending all the registers in stop replies.  */
+  PACKET_expediteAllRegisters_feature,
+
+  PACKET_QStackPrefetch,
+
+  /* Support for reading just the changes to the thread list with
+     qXfer:threads:read.  */
+  PACKET_ThreadListDelta_feature,
+
   PACKET_MAX
 };
 
@@ -1727,6 +1782,50 @@ remote_pass_signals (struct target_ops *self,
     }
 }
 
+/* If 'QStackPrefetch' is supported, tell the remote stub how many
+   bytes of the stack of a stopped thread to send in stop replies, if
+   that changed.  */
+
+static void
+remote_set_stack_prefetch (void)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct gdbarch *gdbarch = target_gdbarch ();
+  struct packet_reg *reg;
+  char *packet;
+  int sp_regnum;
+
+  if (packet_support (PACKET_QStackPrefetch) == PACKET_DISABLE)
+    return;
+
+  /* The stub starts with prefetching disabled.  */
+  if (rs->last_stack_prefetch_packet == NULL && remote_stack_prefetch == 0)
+    return;
+
+  /* The stub finds the stack through its number for the stack pointer
+     register.  */
+  sp_regnum = gdbarch_sp_regnum (gdbarch);
+  if (sp_regnum < 0 || sp_regnum >= gdbarch_num_regs (gdbarch))
+    return;
+  reg = packet_reg_from_regnum (get_remote_arch_state (), sp_regnum);
+  if (reg == NULL || reg->pnum == -1)
+    return;
+
+  packet = xstrprintf ("QStackPrefetch:%s,%x", phex_nz (reg->pnum, 0),
+		       remote_stack_prefetch);
+  if (rs->last_stack_prefetch_packet == NULL
+      || strcmp (rs->last_stack_prefetch_packet, packet) != 0)
+    {
+      putpkt (packet);
+      getpkt (&rs->buf, &rs->buf_size, 0);
+      packet_ok (rs->buf, &remote_protocol_packets[PACKET_QStackPrefetch]);
+      xfree (rs->last_stack_prefetch_packet);
+      rs->last_stack_prefetch_packet = packet;
+    }
+  else
+    xfree (packet);
+}
+
 /* If 'QProgramSignals' is supported, tell the remote stub what
    signals it should pass through to the inferior when detaching.  */
 
@@ -1848,36 +1947,138 @@ set_general_process (void)
 }
 
 
-/*  Return nonzero if the thread PTID is still alive on the remote
-    system.  */
+/* Return nonzero if PTID is the main thread, which is always
+   alive.  */
 
 static int
-remote_thread_alive (struct target_ops *ops, ptid_t ptid)
+remote_main_thread_p (ptid_t ptid)
 {
-  struct remote_state *rs = get_remote_state ();
-  char *p, *endp;
-
   if (ptid_equal (ptid, magic_null_ptid))
-    /* The main thread is always alive.  */
     return 1;
 
+  /* This can happen after a vAttach, if the remote side doesn't
+     support multi-threading.  */
   if (ptid_get_pid (ptid) != 0 && ptid_get_lwp (ptid) == 0)
-    /* The main thread is always alive.  This can happen after a
-       vAttach, if the remote side doesn't support
-       multi-threading.  */
     return 1;
 
+  return 0;
+}
+
+/* Store the 'T' packet asking whether PTID is alive in the packet
+   buffer.  */
+
+static void
+make_thread_alive_request (ptid_t ptid)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *p, *endp;
+
   p = rs->buf;
   endp = rs->buf + get_remote_packet_size ();
 
   *p++ = 'T';
   write_ptid (p, endp, ptid);
+}
 
+/*  Return nonzero if the thread PTID is still alive on the remote
+    system.  */
+
+static int
+remote_thread_alive (struct target_ops *ops, ptid_t ptid)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (remote_main_thread_p (ptid))
+    return 1;
+
+  make_thread_alive_request (ptid);
   putpkt (rs->buf);
   getpkt (&rs->buf, &rs->buf_size, 0);
   return (rs->buf[0] == 'O' && rs->buf[1] == 'K');
 }
 
+/* The threads remote_threads_alive asks about with 'T' packets.  */
+
+struct threads_alive_data
+{
+  ptid_t *ptids;
+  int *alive;
+
+  /* The indexes in PTIDS and ALIVE of the threads to ask about.  */
+  int *todo;
+};
+
+/* remote_pipeline callbacks for remote_threads_alive.  */
+
+static void
+threads_alive_request (int i, void *data)
+{
+  struct threads_alive_data *d = data;
+
+  make_thread_alive_request (d->ptids[d->todo[i]]);
+}
+
+static int
+threads_alive_reply (int i, void *data)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct threads_alive_data *d = data;
+
+  d->alive[d->todo[i]] = (rs->buf[0] == 'O' && rs->buf[1] == 'K');
+  return 1;
+}
+
+/* Implement the to_threads_alive target method.  Bring GDB's thread
+   list up to date with the remote's changes if it can say what they
+   are, otherwise pipeline the 'T' packets, so that checking many
+   threads costs about one round trip.  */
+
+static void
+remote_threads_alive (struct target_ops *ops, ptid_t *ptids, int *alive,
+		      int count)
+{
+  struct threads_alive_data d;
+  struct cleanup *old_chain;
+  int i, n = 0;
+
+#if defined(HAVE_LIBEXPAT)
+  /* If the remote can tell which threads were removed since the
+     thread list we last read, that is all we need to know.  */
+  if (packet_support (PACKET_qXfer_threads) == PACKET_ENABLE
+      && packet_support (PACKET_ThreadListDelta_feature) == PACKET_ENABLE
+      && remote_get_threads_with_qxfer ())
+    {
+      for (i = 0; i < count; i++)
+	alive[i] = (remote_main_thread_p (ptids[i])
+		    || (find_thread_ptid (ptids[i]) != NULL
+			&& !is_exited (ptids[i])));
+      return;
+    }
+#endif
+
+  if (!remote_can_pipeline ())
+    {
+      for (i = 0; i < count; i++)
+	alive[i] = remote_thread_alive (ops, ptids[i]);
+      return;
+    }
+
+  d.ptids = ptids;
+  d.alive = alive;
+  d.todo = XNEWVEC (int, count);
+  old_chain = make_cleanup (xfree, d.todo);
+
+  for (i = 0; i < count; i++)
+    if (remote_main_thread_p (ptids[i]))
+      alive[i] = 1;
+    else
+      d.todo[n++] = i;
+
+  remote_pipeline (n, threads_alive_request, threads_alive_reply, &d);
+
+  do_cleanups (old_chain);
+}
+
 /* About these extended threadlist and threadinfo packets.  They are
    variable length packets but, the fields within them are often fixed
    length.  They are redundent enough to send over UDP as is the
@@ -2579,14 +2780,42 @@ typedef struct thread_item
   ptid_t ptid;
   char *extra;
   int core;
+
+  /* Nonzero if this is a thread the remote reports removed.  */
+  int removed;
 } thread_item_t;
 DEF_VEC_O(thread_item_t);
 
 struct threads_parsing_context
 {
   VEC (thread_item_t) *items;
+
+  /* The generation of the thread list, or 0 if the remote didn't
+     say.  */
+  ULONGEST generation;
+
+  /* If the list only holds the changes since an earlier generation,
+     that generation; otherwise 0.  */
+  ULONGEST from;
 };
 
+static void
+start_threads (struct gdb_xml_parser *parser,
+	       const struct gdb_xml_element *element,
+	       void *user_data, VEC(gdb_xml_value_s) *attributes)
+{
+  struct threads_parsing_context *data = user_data;
+  struct gdb_xml_value *attr;
+
+  attr = xml_find_attribute (attributes, "generation");
+  if (attr != NULL)
+    data->generation = *(ULONGEST *) attr->value;
+
+  attr = xml_find_attribute (attributes, "from");
+  if (attr != NULL)
+    data->from = *(ULONGEST *) attr->value;
+}
+
 static void
 start_thread (struct gdb_xml_parser *parser,
 	      const struct gdb_xml_element *element,
@@ -2608,6 +2837,25 @@ start_thread (struct gdb_xml_parser *parser,
     item.core = -1;
 
   item.extra = 0;
+  item.removed = 0;
+
+  VEC_safe_push (thread_item_t, data->items, &item);
+}
+
+static void
+start_removed (struct gdb_xml_parser *parser,
+	       const struct gdb_xml_element *element,
+	       void *user_data, VEC(gdb_xml_value_s) *attributes)
+{
+  struct threads_parsing_context *data = user_data;
+  struct thread_item item;
+  char *id;
+
+  id = xml_find_attribute (attributes, "id")->value;
+  item.ptid = read_ptid (id, NULL);
+  item.core = -1;
+  item.extra = 0;
+  item.removed = 1;
 
   VEC_safe_push (thread_item_t, data->items, &item);
 }
@@ -2633,16 +2881,30 @@ const struct gdb_xml_element thread_children[] = {
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
+const struct gdb_xml_attribute removed_attributes[] = {
+  { "id", GDB_XML_AF_NONE, NULL, NULL },
+  { NULL, GDB_XML_AF_NONE, NULL, NULL }
+};
+
 const struct gdb_xml_element threads_children[] = {
   { "thread", thread_attributes, thread_children,
     GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
     start_thread, end_thread },
+  { "removed", removed_attributes, NULL,
+    GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
+    start_removed, NULL },
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
+const struct gdb_xml_attribute threads_attributes[] = {
+  { "generation", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
+  { "from", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
+  { NULL, GDB_XML_AF_NONE, NULL, NULL }
+};
+
 const struct gdb_xml_element threads_elements[] = {
-  { "threads", NULL, threads_children,
-    GDB_XML_EF_NONE, NULL, NULL },
+  { "threads", threads_attributes, threads_children,
+    GDB_XML_EF_NONE, start_threads, NULL },
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
@@ -2661,6 +2923,83 @@ clear_threads_parsing_context (void *p)
   VEC_free (thread_item_t, context->items);
 }
 
+/* Read the remote thread list with qXfer:threads:read, and add the
+   threads in it to GDB's thread list.  If the remote supports it,
+   read only the threads added and removed since the list we last
+   read, and also delete those removed.  Return nonzero if GDB's
+   thread list then matches the remote's, zero if only threads were
+   added.  */
+
+static int
+remote_get_threads_with_qxfer (void)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct threads_parsing_context context;
+  struct cleanup *back_to;
+  char annex[17];
+  char *xml;
+  int exact = 0;
+
+  if (packet_support (PACKET_ThreadListDelta_feature) == PACKET_ENABLE)
+    xsnprintf (annex, sizeof (annex), "%s",
+	       phex_nz (rs->thread_list_generation, 8));
+  else
+    annex[0] = '\0';
+
+  xml = target_read_stralloc (&current_target, TARGET_OBJECT_THREADS,
+			      annex[0] != '\0' ? annex : NULL);
+  back_to = make_cleanup (xfree, xml);
+
+  context.items = NULL;
+  context.generation = 0;
+  context.from = 0;
+  make_cleanup (clear_threads_parsing_context, &context);
+
+  if (xml != NULL && *xml != '\0'
+      && gdb_xml_parse_quick (_("threads"), "threads.dtd",
+			      threads_elements, xml, &context) == 0)
+    {
+      int i;
+      struct thread_item *item;
+
+      /* A list of changes only brings GDB's list up to date if it is
+	 relative to the list GDB has.  */
+      exact = (context.from != 0
+	       && context.from == rs->thread_list_generation);
+      rs->thread_list_generation = context.generation;
+
+      for (i = 0;
+	   VEC_iterate (thread_item_t, context.items, i, item);
+	   ++i)
+	{
+	  if (ptid_equal (item->ptid, null_ptid))
+	    continue;
+
+	  if (item->removed)
+	    delete_thread (item->ptid);
+	  else
+	    {
+	      struct private_thread_info *info;
+	      /* In non-stop mode, we assume new found threads are
+		 running until proven otherwise with a stop reply.  In
+		 all-stop, we can only get here if all threads are
+		 stopped.  */
+	      int running = non_stop ? 1 : 0;
+
+	      remote_notice_new_inferior (item->ptid, running);
+
+	      info = demand_private_info (item->ptid);
+	      info->core = item->core;
+	      info->extra = item->extra;
+	      item->extra = NULL;
+	    }
+	}
+    }
+
+  do_cleanups (back_to);
+  return exact;
+}
+
 #endif
 
 /*
@@ -2683,49 +3022,7 @@ remote_threads_info (struct target_ops *ops)
 #if defined(HAVE_LIBEXPAT)
   if (packet_support (PACKET_qXfer_threads) == PACKET_ENABLE)
     {
-      char *xml = target_read_stralloc (&current_target,
-					 TARGET_OBJECT_THREADS, NULL);
-
-      struct cleanup *back_to = make_cleanup (xfree, xml);
-
-      if (xml && *xml)
-	{
-	  struct threads_parsing_context context;
-
-	  context.items = NULL;
-	  make_cleanup (clear_threads_parsing_context, &context);
-
-	  if (gdb_xml_parse_quick (_("threads"), "threads.dtd",
-				   threads_elements, xml, &context) == 0)
-	    {
-	      int i;
-	      struct thread_item *item;
-
-	      for (i = 0;
-		   VEC_iterate (thread_item_t, context.items, i, item);
-		   ++i)
-		{
-		  if (!ptid_equal (item->ptid, null_ptid))
-		    {
-		      struct private_thread_info *info;
-		      /* In non-stop mode, we assume new found threads
-			 are running until proven otherwise with a
-			 stop reply.  In all-stop, we can only get
-			 here if all threads are stopped.  */
-		      int running = non_stop ? 1 : 0;
-
-		      remote_notice_new_inferior (item->ptid, running);
-
-		      info = demand_private_info (item->ptid);
-		      info->core = item->core;
-		      info->extra = item->extra;
-		      item->extra = NULL;
-		    }
-		}
-	    }
-	}
-
-      do_cleanups (back_to);
+      remote_get_threads_with_qxfer ();
       return;
     }
 #endif
@@ -2976,6 +3273,58 @@ extended_remote_restart (void)
   remote_fileio_reset ();
 }
 
+/* Negotiate packet compression with the remote stub.  */
+
+static void
+remote_start_compression (void)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct rsp_zstream *deflate_stream, *inflate_stream;
+
+  deflate_stream = rsp_zstream_new (1);
+  if (deflate_stream == NULL)
+    return;
+  inflate_stream = rsp_zstream_new (0);
+  if (inflate_stream == NULL)
+    {
+      rsp_zstream_free (deflate_stream);
+      return;
+    }
+
+  /* The reply is not compressed yet; every packet after it is, in
+     both directions.  */
+  putpkt ("QCompress");
+  getpkt (&rs->buf, &rs->buf_size, 0);
+  if (packet_ok (rs->buf, &remote_protocol_packets[PACKET_QCompress])
+      == PACKET_OK)
+    {
+      rs->deflate_stream = deflate_stream;
+      rs->inflate_stream = inflate_stream;
+    }
+  else
+    {
+      rsp_zstream_free (deflate_stream);
+      rsp_zstream_free (inflate_stream);
+    }
+}
+
+/* Stop compressing packets, e.g., because the connection is gone.  */
+
+static void
+remote_stop_compression (struct remote_state *rs)
+{
+  if (rs->deflate_stream != NULL)
+    {
+      rsp_zstream_free (rs->deflate_stream);
+      rs->deflate_stream = NULL;
+    }
+  if (rs->inflate_stream != NULL)
+    {
+      rsp_zstream_free (rs->inflate_stream);
+      rs->inflate_stream = NULL;
+    }
+}
+
 /* Clean up connection to a remote debugger.  */
 
 static void
@@ -2992,6 +3341,7 @@ remote_close (struct target_ops *self)
 
   serial_close (rs->remote_desc);
   rs->remote_desc = NULL;
+  remote_stop_compression (rs);
 
   /* We don't have a connection to the remote stub anymore.  Get rid
      of all the inferiors and their threads we were controlling.
@@ -3364,6 +3714,14 @@ remote_start_remote (int from_tty, struct target_ops *target, int extended_p)
 	rs->noack_mode = 1;
     }
 
+  /* Compress the packets from now on if the user asked for it and
+     the stub supports it.  This needs noack mode: a packet that is
+     sent again because its ack was lost would otherwise be
+     decompressed twice.  */
+  if (remote_compression && rs->noack_mode
+      && packet_support (PACKET_QCompress) != PACKET_DISABLE)
+    remote_start_compression ();
+
   if (extended_p)
     {
       /* Tell the remote that we are using the extended protocol.  */
@@ -3929,7 +4287,19 @@ static const struct protocol_feature remote_protocol_features[] = {
   { "Qbtrace:off", PACKET_DISABLE, remote_supported_packet, PACKET_Qbtrace_off },
   { "Qbtrace:bts", PACKET_DISABLE, remote_supported_packet, PACKET_Qbtrace_bts },
   { "qXfer:btrace:read", PACKET_DISABLE, remote_supported_packet,
-    PACKET_qXfer_btrace }
+    PACKET_qXfer_btrace },
+  { "vReadMemory", PACKET_DISABLE, remote_supported_packet,
+    PACKET_vReadMemory },
+  { "QCompress", PACKET_DISABLE, remote_supported_packet,
+    PACKET_QCompress },
+  { "pipelining", PACKET_DISABLE, remote_supported_packet,
+    PACKET_pipelining_feature },
+  { "expediteAllRegisters", PACKET_DISABLE, remote_supported_packet,
+    PACKET_expediteAllRegisters_feature },
+  { "QStackPrefetch", PACKET_DISABLE, remote_supported_packet,
+    PACKET_QStackPrefetch },
+  { "ThreadListDelta", PACKET_DISABLE, remote_supported_packet,
+    PACKET_ThreadListDelta_feature }
 };
 
 static char *remote_support_xml;
@@ -4003,6 +4373,13 @@ remote_query_supported (void)
 
       q = remote_query_supported_append (q, "qRelocInsn+");
 
+      /* Ask for all the registers in stop replies, which saves
+	 fetching them after each stop, unless the user disabled
+	 it.  */
+      if (packet_support (PACKET_expediteAllRegisters_feature)
+	  != PACKET_DISABLE)
+	q = remote_query_supported_append (q, "expediteAllRegisters+");
+
       q = reconcat (q, "qSupported:", q, (char *) NULL);
       putpkt (q);
 
@@ -4162,6 +4539,14 @@ remote_open_1 (char *name, int from_tty,
   xfree (rs->last_program_signals_packet);
   rs->last_program_signals_packet = NULL;
 
+  /* Likewise the stack prefetch size.  */
+  xfree (rs->last_stack_prefetch_packet);
+  rs->last_stack_prefetch_packet = NULL;
+
+  /* The first thread list read on this connection must be a whole
+     one.  */
+  rs->thread_list_generation = 0;
+
   remote_fileio_reset ();
   reopen_exec_file ();
   reread_symbols ();
@@ -4210,6 +4595,7 @@ remote_open_1 (char *name, int from_tty,
   rs->cached_wait_status = 0;
   rs->explicit_packet_size = 0;
   rs->noack_mode = 0;
+  remote_stop_compression (rs);
   rs->extended = extended_p;
   rs->waiting_for_stop_reply = 0;
   rs->ctrlc_pending_p = 0;
@@ -4736,6 +5122,8 @@ remote_resume (struct target_ops *ops,
   if (!non_stop)
     remote_notif_process (rs->notif_state, &notif_client_stop);
 
+  remote_set_stack_prefetch ();
+
   rs->last_sent_signal = siggnal;
   rs->last_sent_step = step;
 
@@ -5087,6 +5475,13 @@ typedef struct stop_reply
      fetch them is avoided).  */
   VEC(cached_reg_t) *regcache;
 
+  /* STACK_LEN bytes of memory at STACK_ADDR, from the top of the stack
+     of the thread, if the stub sent them.  We put them in the stack
+     cache.  */
+  CORE_ADDR stack_addr;
+  gdb_byte *stack_data;
+  int stack_len;
+
   int stopped_by_watchpoint_p;
   CORE_ADDR watch_data_address;
 
@@ -5151,6 +5546,7 @@ stop_reply_dtr (struct notif_event *event)
   struct stop_reply *r = (struct stop_reply *) event;
 
   VEC_free (cached_reg_t, r->regcache);
+  xfree (r->stack_data);
 }
 
 static struct notif_event *
@@ -5390,6 +5786,7 @@ remote_parse_stop_reply (char *buf, struct stop_reply *event)
   event->ws.value.integer = 0;
   event->stopped_by_watchpoint_p = 0;
   event->regcache = NULL;
+  event->stack_data = NULL;
   event->core = -1;
 
   switch (buf[0])
@@ -5470,6 +5867,28 @@ Packet: '%s'\n"),
 		  p = unpack_varlen_hex (++p1, &c);
 		  event->core = c;
 		}
+	      else if (strncmp (p, "stack", p1 - p) == 0)
+		{
+		  p = unpack_varlen_hex (++p1, &addr);
+		  if (*p++ != ',')
+		    error (_("Malformed packet(c) (missing comma): %s\n\
+Packet: '%s'\n"),
+			   p, buf);
+		  p_temp = strchr (p, ';');
+		  if (p_temp == NULL)
+		    p_temp = p + strlen (p);
+
+		  xfree (event->stack_data);
+		  event->stack_addr = addr;
+		  event->stack_len = (p_temp - p) / 2;
+		  event->stack_data = xmalloc (event->stack_len);
+		  if (hex2bin (p, event->stack_data, event->stack_len)
+		      != event->stack_len)
+		    error (_("Remote stack data badly formatted: %s\n\
+Packet: '%s'\n"),
+			   p, buf);
+		  p = p_temp;
+		}
 	      else
 		{
 		  /* Silently skip unknown optional info.  */
@@ -5491,22 +5910,42 @@ Packet: '%s'\n"),
 		       p, buf);
 	      ++p;
 
-	      if (reg == NULL)
-		error (_("Remote sent bad register number %s: %s\n\
+	      p_temp = strchr (p, ';');
+	      if (p_temp == NULL)
+		p_temp = p + strlen (p);
+
+	      if (packet_support (PACKET_expediteAllRegisters_feature)
+		  == PACKET_ENABLE
+		  && (reg == NULL
+		      || (p_temp - p
+			  != 2 * register_size (target_gdbarch (),
+						reg->regnum))))
+		{
+		  /* A stub sending all its registers may have registers
+		     GDB doesn't know of, or knows with another size, e.g.
+		     if GDB could not use its target description.  Skip
+		     those.  */
+		  p = p_temp;
+		}
+	      else
+		{
+		  if (reg == NULL)
+		    error (_("Remote sent bad register number %s: %s\n\
 Packet: '%s'\n"),
-		       hex_string (pnum), p, buf);
+			   hex_string (pnum), p, buf);
 
-	      cached_reg.num = reg->regnum;
+		  cached_reg.num = reg->regnum;
 
-	      fieldsize = hex2bin (p, cached_reg.data,
-				   register_size (target_gdbarch (),
-						  reg->regnum));
-	      p += 2 * fieldsize;
-	      if (fieldsize < register_size (target_gdbarch (),
-					     reg->regnum))
-		warning (_("Remote reply is too short: %s"), buf);
+		  fieldsize = hex2bin (p, cached_reg.data,
+				       register_size (target_gdbarch (),
+						      reg->regnum));
+		  p += 2 * fieldsize;
+		  if (fieldsize < register_size (target_gdbarch (),
+						 reg->regnum))
+		    warning (_("Remote reply is too short: %s"), buf);
 
-	      VEC_safe_push (cached_reg_t, event->regcache, &cached_reg);
+		  VEC_safe_push (cached_reg_t, event->regcache, &cached_reg);
+		}
 	    }
 
 	  if (*p != ';')
@@ -5711,6 +6150,10 @@ process_stop_reply (struct stop_reply *stop_reply,
 
       remote_notice_new_inferior (ptid, 0);
       demand_private_info (ptid)->core = stop_reply->core;
+
+      if (stop_reply->stack_data != NULL)
+	target_dcache_fill (ptid, stop_reply->stack_addr,
+			    stop_reply->stack_data, stop_reply->stack_len);
     }
 
   stop_reply_xfree (stop_reply);
@@ -5949,28 +6392,31 @@ remote_wait (struct target_ops *ops,
   return event_ptid;
 }
 
-/* Fetch a single register using a 'p' packet.  */
+/* Store the 'p' packet that fetches REG in the packet buffer.  */
 
-static int
-fetch_register_using_p (struct regcache *regcache, struct packet_reg *reg)
+static void
+make_p_request (struct packet_reg *reg)
 {
   struct remote_state *rs = get_remote_state ();
-  char *buf, *p;
-  char regp[MAX_REGISTER_SIZE];
-  int i;
-
-  if (packet_support (PACKET_p) == PACKET_DISABLE)
-    return 0;
-
-  if (reg->pnum == -1)
-    return 0;
+  char *p;
 
   p = rs->buf;
   *p++ = 'p';
   p += hexnumstr (p, reg->pnum);
   *p++ = '\0';
-  putpkt (rs->buf);
-  getpkt (&rs->buf, &rs->buf_size, 0);
+}
+
+/* Supply REG to REGCACHE from the reply to a 'p' packet, which is in
+   the packet buffer.  Return zero if the stub did not understand the
+   packet.  */
+
+static int
+supply_p_reply (struct regcache *regcache, struct packet_reg *reg)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *buf, *p;
+  char regp[MAX_REGISTER_SIZE];
+  int i;
 
   buf = rs->buf;
 
@@ -6009,6 +6455,94 @@ fetch_register_using_p (struct regcache *regcache, struct packet_reg *reg)
   return 1;
 }
 
+/* Fetch a single register using a 'p' packet.  */
+
+static int
+fetch_register_using_p (struct regcache *regcache, struct packet_reg *reg)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (packet_support (PACKET_p) == PACKET_DISABLE)
+    return 0;
+
+  if (reg->pnum == -1)
+    return 0;
+
+  make_p_request (reg);
+  putpkt (rs->buf);
+  getpkt (&rs->buf, &rs->buf_size, 0);
+
+  return supply_p_reply (regcache, reg);
+}
+
+/* The registers fetch_registers_using_p fetches.  */
+
+struct fetch_p_data
+{
+  struct regcache *regcache;
+  struct packet_reg **regs;
+};
+
+/* remote_pipeline callbacks for fetch_registers_using_p.  */
+
+static void
+fetch_p_request (int i, void *data)
+{
+  struct fetch_p_data *d = data;
+
+  make_p_request (d->regs[i]);
+}
+
+static int
+fetch_p_reply (int i, void *data)
+{
+  struct fetch_p_data *d = data;
+
+  if (!supply_p_reply (d->regcache, d->regs[i]))
+    {
+      /* This register is not available.  */
+      regcache_raw_supply (d->regcache, d->regs[i]->regnum, NULL);
+    }
+  return 1;
+}
+
+/* Fetch the COUNT registers in REGS using 'p' packets, marking those
+   the stub can not fetch as unavailable.  Pipeline the packets if
+   possible.  */
+
+static void
+fetch_registers_using_p (struct regcache *regcache,
+			 struct packet_reg **regs, int count)
+{
+  int i;
+
+  if (count > 1
+      && packet_support (PACKET_p) != PACKET_DISABLE
+      && remote_can_pipeline ())
+    {
+      struct fetch_p_data d;
+      int n = 0;
+
+      d.regcache = regcache;
+      d.regs = alloca (count * sizeof (struct packet_reg *));
+      for (i = 0; i < count; i++)
+	if (regs[i]->pnum != -1)
+	  d.regs[n++] = regs[i];
+	else
+	  regcache_raw_supply (regcache, regs[i]->regnum, NULL);
+
+      remote_pipeline (n, fetch_p_request, fetch_p_reply, &d);
+      return;
+    }
+
+  for (i = 0; i < count; i++)
+    if (!fetch_register_using_p (regcache, regs[i]))
+      {
+	/* This register is not available.  */
+	regcache_raw_supply (regcache, regs[i]->regnum, NULL);
+      }
+}
+
 /* Fetch the registers included in the target's 'g' packet.  */
 
 static int
@@ -6168,6 +6702,8 @@ remote_fetch_registers (struct target_ops *ops,
 			struct regcache *regcache, int regnum)
 {
   struct remote_arch_state *rsa = get_remote_arch_state ();
+  struct packet_reg **regs;
+  int num_regs, count = 0;
   int i;
 
   set_remote_traceframe ();
@@ -6201,13 +6737,12 @@ remote_fetch_registers (struct target_ops *ops,
 
   fetch_registers_using_g (regcache);
 
-  for (i = 0; i < gdbarch_num_regs (get_regcache_arch (regcache)); i++)
+  num_regs = gdbarch_num_regs (get_regcache_arch (regcache));
+  regs = alloca (num_regs * sizeof (struct packet_reg *));
+  for (i = 0; i < num_regs; i++)
     if (!rsa->regs[i].in_g_packet)
-      if (!fetch_register_using_p (regcache, &rsa->regs[i]))
-	{
-	  /* This register is not available.  */
-	  regcache_raw_supply (regcache, i, NULL);
-	}
+      regs[count++] = &rsa->regs[i];
+  fetch_registers_using_p (regcache, regs, count);
 }
 
 /* Prepare to store registers.  Since we may send them all (using a
@@ -6696,6 +7231,108 @@ remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr, ULONGEST len,
 				 packet_format[0], 1);
 }
 
+/* Store the "m" packet reading LEN bytes at MEMADDR in the packet
+   buffer.  */
+
+static void
+make_m_request (CORE_ADDR memaddr, ULONGEST len)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *p;
+
+  /* Construct "m"<memaddr>","<len>".  */
+  memaddr = remote_address_masked (memaddr);
+  p = rs->buf;
+  *p++ = 'm';
+  p += hexnumstr (p, (ULONGEST) memaddr);
+  *p++ = ',';
+  p += hexnumstr (p, len);
+  *p = '\0';
+}
+
+/* Return nonzero if the reply to an "m" packet, in the packet
+   buffer, is an error.  */
+
+static int
+m_reply_error_p (void)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  return (rs->buf[0] == 'E'
+	  && isxdigit (rs->buf[1]) && isxdigit (rs->buf[2])
+	  && rs->buf[3] == '\0');
+}
+
+/* A memory read split into "m" packets of CHUNK bytes, for
+   remote_read_bytes_pipelined.  */
+
+struct pipelined_read
+{
+  CORE_ADDR memaddr;
+  gdb_byte *myaddr;
+  ULONGEST len;
+  int chunk;
+
+  /* The number of bytes read from MEMADDR on, without a gap.  */
+  ULONGEST xfered;
+};
+
+/* remote_pipeline callbacks for remote_read_bytes_pipelined.  */
+
+static void
+pipelined_read_request (int i, void *data)
+{
+  struct pipelined_read *r = data;
+  ULONGEST offset = (ULONGEST) i * r->chunk;
+
+  make_m_request (r->memaddr + offset, min (r->chunk, r->len - offset));
+}
+
+static int
+pipelined_read_reply (int i, void *data)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct pipelined_read *r = data;
+  ULONGEST offset = (ULONGEST) i * r->chunk;
+  ULONGEST todo = min (r->chunk, r->len - offset);
+  ULONGEST n;
+
+  if (m_reply_error_p ())
+    return 0;
+
+  n = hex2bin (rs->buf, r->myaddr + offset, todo);
+  r->xfered += n;
+
+  /* Stop at the first short read; the caller only gets the bytes up
+     to it.  */
+  return n == todo;
+}
+
+/* Read LEN bytes at MEMADDR into MYADDR with pipelined "m" packets of
+   at most CHUNK bytes each.  Return like remote_read_bytes_1.  */
+
+static enum target_xfer_status
+remote_read_bytes_pipelined (CORE_ADDR memaddr, gdb_byte *myaddr,
+			     ULONGEST len, int chunk, ULONGEST *xfered_len)
+{
+  struct pipelined_read r;
+
+  r.memaddr = memaddr;
+  r.myaddr = myaddr;
+  r.len = len;
+  r.chunk = chunk;
+  r.xfered = 0;
+
+  remote_pipeline ((len + chunk - 1) / chunk,
+		   pipelined_read_request, pipelined_read_reply, &r);
+
+  if (r.xfered == 0)
+    return TARGET_XFER_E_IO;
+
+  *xfered_len = r.xfered;
+  return TARGET_XFER_OK;
+}
+
 /* Read memory data directly from the remote machine.
    This does not use the data cache; the data cache uses this.
    MEMADDR is the address in the remote memory space.
@@ -6723,19 +7360,14 @@ remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr, ULONGEST len,
   /* Number if bytes that will fit.  */
   todo = min (len, max_buf_size / 2);
 
-  /* Construct "m"<memaddr>","<len>".  */
-  memaddr = remote_address_masked (memaddr);
-  p = rs->buf;
-  *p++ = 'm';
-  p += hexnumstr (p, (ULONGEST) memaddr);
-  *p++ = ',';
-  p += hexnumstr (p, (ULONGEST) todo);
-  *p = '\0';
+  if (todo < len && remote_can_pipeline ())
+    return remote_read_bytes_pipelined (memaddr, myaddr, len, todo,
+					xfered_len);
+
+  make_m_request (memaddr, todo);
   putpkt (rs->buf);
   getpkt (&rs->buf, &rs->buf_size, 0);
-  if (rs->buf[0] == 'E'
-      && isxdigit (rs->buf[1]) && isxdigit (rs->buf[2])
-      && rs->buf[3] == '\0')
+  if (m_reply_error_p ())
     return TARGET_XFER_E_IO;
   /* Reply describes memory byte by byte, each byte encoded as two hex
      characters.  */
@@ -6869,6 +7501,94 @@ remote_read_bytes (struct target_ops *ops, CORE_ADDR memaddr,
   return remote_read_bytes_1 (memaddr, myaddr, len, xfered_len);
 }
 
+/* Implement the to_read_memory_vector target method.  Send
+   "vReadMemory" packets, each reading as many of the ranges as fit in
+   the request and reply buffers.  Ranges too big for a single packet,
+   and those the stub did not return, are read one by one.  */
+
+static void
+remote_read_memory_vector (struct target_ops *ops,
+			   struct memory_read_request *requests, int count)
+{
+  struct remote_state *rs = get_remote_state ();
+  int max_buf_size = get_memory_read_packet_size ();
+  int i = 0;
+
+  if (packet_support (PACKET_vReadMemory) == PACKET_DISABLE
+      || get_traceframe_number () != -1)
+    {
+      default_read_memory_vector (ops, requests, count);
+      return;
+    }
+
+  while (i < count)
+    {
+      char *p = rs->buf;
+      char *endbuf = rs->buf + get_remote_packet_size ();
+      ULONGEST reply_size = 0;
+      int first = i;
+
+      /* Construct "vReadMemory:"<addr>","<len>[";"<addr>","<len>]...  */
+      p += xsnprintf (p, endbuf - p, "vReadMemory:");
+      for (; i < count; i++)
+	{
+	  CORE_ADDR memaddr = remote_address_masked (requests[i].memaddr);
+
+	  /* Each range takes two hex characters per byte and a
+	     separator in the reply, and at most two 16-digit numbers
+	     and two separators in the request.  */
+	  if (reply_size + 2 * requests[i].len + 1 > max_buf_size
+	      || endbuf - p < 2 * 16 + 3)
+	    break;
+	  reply_size += 2 * requests[i].len + 1;
+
+	  if (i > first)
+	    *p++ = ';';
+	  p += hexnumstr (p, (ULONGEST) memaddr);
+	  *p++ = ',';
+	  p += hexnumstr (p, requests[i].len);
+	}
+      *p = '\0';
+
+      if (i == first)
+	{
+	  /* This range doesn't fit in a packet by itself.  */
+	  i++;
+	  continue;
+	}
+
+      putpkt (rs->buf);
+      getpkt (&rs->buf, &rs->buf_size, 0);
+      if (packet_ok (rs->buf, &remote_protocol_packets[PACKET_vReadMemory])
+	  != PACKET_OK)
+	break;
+
+      /* The reply holds the contents of each range, hex-encoded and
+	 separated by semicolons.  A range may be short, or empty if it
+	 could not be read at all, and the stub may drop the ranges
+	 past the end of its packet buffer.  */
+      p = rs->buf;
+      for (; first < i && *p != '\0'; first++)
+	{
+	  struct memory_read_request *req = &requests[first];
+	  char *sep = strchr (p, ';');
+	  ULONGEST n;
+
+	  if (sep == NULL)
+	    sep = p + strlen (p);
+	  n = min ((sep - p) / 2, req->len);
+	  if (n > 0)
+	    {
+	      req->xfered_len = hex2bin (p, req->buf, n);
+	      req->status = TARGET_XFER_OK;
+	    }
+	  p = *sep == ';' ? sep + 1 : sep;
+	}
+    }
+
+  default_read_memory_vector (ops, requests, count);
+}
+
 
 
 /* Sends a packet with content determined by the printf format string
@@ -7114,7 +7834,9 @@ putpkt_binary (char *buf, int cnt)
   struct remote_state *rs = get_remote_state ();
   int i;
   unsigned char csum = 0;
-  char *buf2 = alloca (cnt + 6);
+  char *buf2;
+  char *payload = buf;
+  int payload_len = cnt;
 
   int ch;
   int tcount = 0;
@@ -7135,9 +7857,15 @@ putpkt_binary (char *buf, int cnt)
      stale cached response.  */
   rs->cached_wait_status = 0;
 
+  /* If we negotiated packet compression, what goes on the wire, and
+     what the checksum covers, is the compressed payload.  */
+  if (rs->deflate_stream != NULL)
+    buf = rsp_zstream_deflate (rs->deflate_stream, buf, cnt, &cnt);
+
   /* Copy the packet into buffer BUF2, encapsulating it
      and giving it a checksum.  */
 
+  buf2 = alloca (cnt + 6);
   p = buf2;
   *p++ = '$';
 
@@ -7162,9 +7890,20 @@ putpkt_binary (char *buf, int cnt)
 	  char *str;
 
 	  *p = '\0';
-	  str = escape_buffer (buf2, p - buf2);
-	  old_chain = make_cleanup (xfree, str);
-	  fprintf_unfiltered (gdb_stdlog, "Sending packet: %s...", str);
+	  if (rs->deflate_stream != NULL)
+	    {
+	      str = escape_buffer (payload, payload_len);
+	      old_chain = make_cleanup (xfree, str);
+	      fprintf_unfiltered (gdb_stdlog,
+				  "Sending packet: %s (compressed to %d "
+				  "bytes)...", str, cnt);
+	    }
+	  else
+	    {
+	      str = escape_buffer (buf2, p - buf2);
+	      old_chain = make_cleanup (xfree, str);
+	      fprintf_unfiltered (gdb_stdlog, "Sending packet: %s...", str);
+	    }
 	  gdb_flush (gdb_stdlog);
 	  do_cleanups (old_chain);
 	}
@@ -7473,6 +8212,38 @@ read_frame (char **buf_p,
     }
 }
 
+/* Replace the LEN bytes of compressed packet data in *BUF with the
+   packet they decompress to, resizing *BUF using xrealloc and
+   updating *SIZEOF_BUF if necessary.  Return the length of the
+   packet.  */
+
+static long
+remote_inflate_packet (char **buf, long *sizeof_buf, long len)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *packet;
+  int packet_len;
+
+  packet = rsp_zstream_inflate (rs->inflate_stream, *buf, len, &packet_len);
+  if (packet == NULL)
+    {
+      /* There is no way to get back in sync with the remote's
+	 compression stream.  */
+      remote_unpush_target ();
+      throw_error (TARGET_CLOSE_ERROR,
+		   _("Remote sent a corrupt compressed packet.  "
+		     "Target detached."));
+    }
+
+  if (packet_len + 1 > *sizeof_buf)
+    {
+      *sizeof_buf = packet_len + 1;
+      *buf = xrealloc (*buf, *sizeof_buf);
+    }
+  memcpy (*buf, packet, packet_len + 1);
+  return packet_len;
+}
+
 /* Read a packet from the remote machine, with error checking, and
    store it in *BUF.  Resize *BUF using xrealloc if necessary to hold
    the result, and update *SIZEOF_BUF.  If FOREVER, wait forever
@@ -7593,6 +8364,9 @@ getpkt_or_notif_sane_1 (char **buf, long *sizeof_buf, int forever,
 	  return -1;
 	}
 
+      if (rs->inflate_stream != NULL)
+	val = remote_inflate_packet (buf, sizeof_buf, val);
+
       /* If we got an ordinary packet, return that to our caller.  */
       if (c == '$')
 	{
@@ -7660,6 +8434,82 @@ getpkt_or_notif_sane (char **buf, long *sizeof_buf, int forever,
 				 is_notif);
 }
 
+/* The most requests remote_pipeline sends before reading a reply.
+   This bounds how much the stub has to queue.  */
+
+#define REMOTE_PIPELINE_DEPTH 16
+
+/* Return nonzero if we can send requests to the stub without waiting
+   for the replies to the previous ones.  This needs the stub to
+   process its input in order, and the no-acknowledgment mode, since
+   otherwise we would have to match the acks of each packet.  */
+
+static int
+remote_can_pipeline (void)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  return (rs->noack_mode
+	  && packet_support (PACKET_pipelining_feature) == PACKET_ENABLE);
+}
+
+/* Send COUNT requests to the stub, keeping up to
+   REMOTE_PIPELINE_DEPTH of them in flight.  MAKE_REQUEST (I, DATA)
+   stores the I'th request in the packet buffer; HANDLE_REPLY (I,
+   DATA) is called with the reply to it in the packet buffer.  The
+   stub replies in order, so the I'th reply we read is the one to the
+   I'th request.  If HANDLE_REPLY returns zero or throws, no more
+   requests are sent, but the replies to those already sent are still
+   read, and then the error, if any, is rethrown.  */
+
+static void
+remote_pipeline (int count,
+		 void (*make_request) (int i, void *data),
+		 int (*handle_reply) (int i, void *data),
+		 void *data)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct gdb_exception err = exception_none;
+  int sent = 0, received = 0;
+  int more = 1;
+
+  gdb_assert (count == 0 || remote_can_pipeline ());
+
+  while (received < sent || (more && sent < count))
+    {
+      while (more && sent < count
+	     && sent - received < REMOTE_PIPELINE_DEPTH)
+	{
+	  make_request (sent, data);
+	  putpkt (rs->buf);
+	  sent++;
+	}
+
+      getpkt (&rs->buf, &rs->buf_size, 0);
+
+      if (more)
+	{
+	  volatile struct gdb_exception ex;
+
+	  TRY_CATCH (ex, RETURN_MASK_ALL)
+	    {
+	      if (!handle_reply (received, data))
+		more = 0;
+	    }
+	  if (ex.reason < 0)
+	    {
+	      err = ex;
+	      more = 0;
+	    }
+	}
+
+      received++;
+    }
+
+  if (err.reason < 0)
+    throw_exception (err);
+}
+
 
 static void
 remote_kill (struct target_ops *ops)
@@ -7763,6 +8613,11 @@ remote_mourn (struct target_ops *ops)
 static void
 remote_mourn_1 (struct target_ops *target)
 {
+  struct remote_state *rs = get_remote_state ();
+
+  /* Mourning discards the inferior's threads.  */
+  rs->thread_list_generation = 0;
+
   unpush_target (target);
 
   /* remote_close takes care of doing most of the clean up.  */
@@ -7778,6 +8633,10 @@ extended_remote_mourn_1 (struct target_ops *target)
      connected.  */
   rs->waiting_for_stop_reply = 0;
 
+  /* Mourning discards the inferior's threads, so the next thread list
+     read must be a whole one.  */
+  rs->thread_list_generation = 0;
+
   /* If the current general thread belonged to the process we just
      detached from or has exited, the remote side current general
      thread becomes undefined.  Considering a case like this:
@@ -8804,7 +9663,6 @@ remote_xfer_partial (struct target_ops *ops, enum target_object object,
         &remote_protocol_packets[PACKET_qXfer_osdata]);
 
     case TARGET_OBJECT_THREADS:
-      gdb_assert (annex == NULL);
       return remote_read_qxfer (ops, "threads", annex, readbuf, offset, len,
 				xfered_len,
 				&remote_protocol_packets[PACKET_qXfer_threads]);
@@ -11407,12 +12265,14 @@ Specify the serial device it is connected to\n\
   remote_ops.to_pass_signals = remote_pass_signals;
   remote_ops.to_program_signals = remote_program_signals;
   remote_ops.to_thread_alive = remote_thread_alive;
+  remote_ops.to_threads_alive = remote_threads_alive;
   remote_ops.to_find_new_threads = remote_threads_info;
   remote_ops.to_pid_to_str = remote_pid_to_str;
   remote_ops.to_extra_thread_info = remote_threads_extra_info;
   remote_ops.to_get_ada_task_ptid = remote_get_ada_task_ptid;
   remote_ops.to_stop = remote_stop;
   remote_ops.to_xfer_partial = remote_xfer_partial;
+  remote_ops.to_read_memory_vector = remote_read_memory_vector;
   remote_ops.to_rcmd = remote_rcmd;
   remote_ops.to_log_command = serial_log_command;
   remote_ops.to_get_thread_local_address = remote_get_thread_local_address;
@@ -11825,6 +12685,27 @@ If set, interrupt sequence is sent to remote target."),
 			   NULL, NULL,
 			   &remote_set_cmdlist, &remote_show_cmdlist);
 
+  add_setshow_boolean_cmd ("compression", class_support,
+			   &remote_compression, _("\
+Set whether to compress the remote protocol packet stream."), _("\
+Show whether to compress the remote protocol packet stream."), _("\
+If on, and the remote stub supports it, the packets exchanged with it are\n\
+compressed, which helps on slow connections.  This only takes effect\n\
+when connecting, and needs noack mode.  The default is off."),
+			   NULL, NULL,
+			   &remote_set_cmdlist, &remote_show_cmdlist);
+
+  add_setshow_zuinteger_cmd ("stack-prefetch", class_support,
+			     &remote_stack_prefetch, _("\
+Set how many bytes of stack the remote stub sends when a thread stops."), _("\
+Show how many bytes of stack the remote stub sends when a thread stops."), _("\
+If nonzero, and the remote stub supports it, each stop reply carries up\n\
+to this many bytes of the stopped thread's stack, from its stack pointer\n\
+up.  They fill the stack cache, so that backtraces need fewer memory\n\
+reads.  The default is zero."),
+			     NULL, NULL,
+			     &remote_set_cmdlist, &remote_show_cmdlist);
+
   /* Install commands for configuring memory read/write packets.  */
 
   add_cmd ("remotewritesize", no_class, set_memory_write_packet_size, _("\
@@ -12079,6 +12960,24 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_qXfer_btrace],
        "qXfer:btrace", "read-btrace", 0);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_vReadMemory],
+			 "vReadMemory", "read-memory-vector", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_QCompress],
+			 "QCompress", "compress", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_pipelining_feature],
+			 "pipelining", "pipelining", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_expediteAllRegisters_feature],
+			 "expediteAllRegisters", "expedite-all-registers", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_QStackPrefetch],
+			 "QStackPrefetch", "stack-prefetch", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_ThreadListDelta_feature],
+			 "ThreadListDelta", "thread-list-delta", 0);
+
   /* Assert that we've registered commands for all packet configs.  */
   {
     int i;
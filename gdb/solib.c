@@ -965,7 +965,7 @@ solib_add (char *pattern, int from_tty,
 	}
 
     if (loaded_any_symbols)
-      breakpoint_re_set ();
+      breakpoint_re_set_new_objfiles ();
 
     if (from_tty && pattern && ! any_matches)
       printf_unfiltered
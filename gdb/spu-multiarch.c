@@ -399,6 +399,7 @@ init_spu_ops (void)
   spu_ops.to_fetch_registers = spu_fetch_registers;
   spu_ops.to_store_registers = spu_store_registers;
   spu_ops.to_xfer_partial = spu_xfer_partial;
+  spu_ops.to_read_memory_vector = default_read_memory_vector;
   spu_ops.to_search_memory = spu_search_memory;
   spu_ops.to_region_ok_for_hw_watchpoint = spu_region_ok_for_hw_watchpoint;
   spu_ops.to_thread_architecture = spu_thread_architecture;
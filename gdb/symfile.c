@@ -168,6 +168,15 @@ static const char *print_symbol_loading = print_symbol_loading_full;
    report all the functions that are actually present.  */
 
 int auto_solib_add = 1;
+
+/* If non-zero, defer reading the partial symbols of each newly added
+   objfile other than the main program until a lookup actually needs
+   them.  Minimal symbols are
+   still read right away.  This makes attaching to programs with many
+   shared libraries much faster, at the cost of a pause the first time
+   a command needs the debug info of a not-yet-read objfile.  */
+
+static int lazy_symbol_reading = 0;
 
 
 /* Return non-zero if symbol-loading messages should be printed.
@@ -1116,7 +1125,7 @@ new_symfile_objfile (struct objfile *objfile, int add_flags)
     }
   else if ((add_flags & SYMFILE_DEFER_BP_RESET) == 0)
     {
-      breakpoint_re_set ();
+      breakpoint_re_set_new_objfiles ();
     }
 
   /* We're done reading the symbol file; finish off complaints.  */
@@ -1160,6 +1169,12 @@ symbol_file_add_with_addrs (bfd *abfd, const char *name, int add_flags,
       flags |= OBJF_READNOW;
       add_flags &= ~SYMFILE_NO_READ;
     }
+  else if (lazy_symbol_reading && !mainline && (flags & OBJF_READNOW) == 0)
+    {
+      /* The main program is left alone: set_initial_language looks up
+	 "main" in it right away anyway.  */
+      add_flags |= SYMFILE_NO_READ;
+    }
 
   /* Give user a chance to burp if we'd be
      interactively wiping out any existing symbols.  */
@@ -1216,6 +1231,16 @@ symbol_file_add_with_addrs (bfd *abfd, const char *name, int add_flags,
       printf_unfiltered (_("(no debugging symbols found)..."));
       wrap_here ("");
     }
+  else if (should_print
+	   && (objfile->flags & OBJF_PSYMTABS_READ) == 0
+	   && objfile->sf != NULL
+	   && objfile->sf->sym_read_psymbols != NULL)
+    {
+      /* Lazy symbol reading left the debug info for later.  */
+      wrap_here ("");
+      printf_unfiltered (_("(debugging information deferred)..."));
+      wrap_here ("");
+    }
 
   if (should_print)
     {
@@ -2486,10 +2511,6 @@ remove_symbol_file_command (char *args, int from_tty)
   do_cleanups (my_cleanups);
 }
 
-typedef struct objfile *objfilep;
-
-DEF_VEC_P (objfilep);
-
 /* Re-read symbols if a symbol-file has changed.  */
 
 void
@@ -4025,6 +4046,19 @@ each global debug-file-directory component prepended."),
 				     show_debug_file_directory,
 				     &setlist, &showlist);
 
+  add_setshow_boolean_cmd ("lazy-symbol-reading", class_files,
+			   &lazy_symbol_reading, _("\
+Set whether to defer reading symbols until they are needed."), _("\
+Show whether to defer reading symbols until they are needed."), _("\
+When on, GDB reads only the minimal symbols of a newly loaded shared library\n\
+or other symbol file, and postpones reading its debugging information until\n\
+a command needs it.  The main program is always read in full.  Only the\n\
+symbol files actually used pay the cost of reading their debug info, which\n\
+speeds up starting or attaching to programs that use many shared libraries."),
+			   NULL,
+			   NULL,
+			   &setlist, &showlist);
+
   add_setshow_enum_cmd ("symbol-loading", no_class,
 			print_symbol_loading_enums, &print_symbol_loading,
 			_("\
@@ -4276,6 +4276,31 @@ struct add_name_data
   const char *word;
 };
 
+/* A callback used with iterate_over_minimal_symbols_with_prefix.
+   This adds a minimal symbol's name to the current completion list.  */
+
+static void
+add_msymbol_name (struct minimal_symbol *msymbol, void *user_data)
+{
+  struct add_name_data *datum = (struct add_name_data *) user_data;
+
+  MCOMPLETION_LIST_ADD_SYMBOL (msymbol, datum->sym_text, datum->sym_text_len,
+			       datum->text, datum->word);
+}
+
+/* A callback used with iterate_over_minimal_symbols_with_prefix.
+   This adds the names under which an Objective-C method can be
+   completed to the current completion list.  */
+
+static void
+add_objc_msymbol_names (struct minimal_symbol *msymbol, void *user_data)
+{
+  struct add_name_data *datum = (struct add_name_data *) user_data;
+
+  completion_list_objc_symbol (msymbol, datum->sym_text, datum->sym_text_len,
+			       datum->text, datum->word);
+}
+
 /* A callback used with macro_for_each and macro_for_each_in_scope.
    This adds a macro's name to the current completion list.  */
 
@@ -4313,7 +4338,6 @@ default_make_symbol_completion_list_break_on (const char *text,
 
   struct symbol *sym;
   struct symtab *s;
-  struct minimal_symbol *msymbol;
   struct objfile *objfile;
   struct block *b;
   const struct block *surrounding_static_block, *surrounding_global_block;
@@ -4415,14 +4439,21 @@ default_make_symbol_completion_list_break_on (const char *text,
 
   if (code == TYPE_CODE_UNDEF)
     {
-      ALL_MSYMBOLS (objfile, msymbol)
+      ALL_OBJFILES (objfile)
 	{
 	  QUIT;
-	  MCOMPLETION_LIST_ADD_SYMBOL (msymbol, sym_text, sym_text_len, text,
-				       word);
-
-	  completion_list_objc_symbol (msymbol, sym_text, sym_text_len, text,
-				       word);
+	  iterate_over_minimal_symbols_with_prefix (objfile, sym_text,
+						    sym_text_len,
+						    add_msymbol_name, &datum);
+
+	  /* Objective-C methods can also be completed on their
+	     selector; all their names start with '-' or '+'.  */
+	  iterate_over_minimal_symbols_with_prefix (objfile, "-", 1,
+						    add_objc_msymbol_names,
+						    &datum);
+	  iterate_over_minimal_symbols_with_prefix (objfile, "+", 1,
+						    add_objc_msymbol_names,
+						    &datum);
 	}
     }
 
@@ -19,6 +19,7 @@
 #include "target-dcache.h"
 #include "gdbcmd.h"
 #include "progspace.h"
+#include "inferior.h"
 
 /* The target dcache is kept per-address-space.  This key lets us
    associate the cache with the address space.  */
@@ -88,6 +89,23 @@ target_dcache_get_or_init (void)
   return dcache;
 }
 
+/* See target-dcache.h.  */
+
+void
+target_dcache_fill (ptid_t ptid, CORE_ADDR memaddr,
+		    const gdb_byte *myaddr, ULONGEST len)
+{
+  struct inferior *inf = find_inferior_pid (ptid_get_pid (ptid));
+
+  /* The cache is that of the current address space.  */
+  if (!stack_cache_enabled_p ()
+      || inf == NULL
+      || inf->aspace != current_program_space->aspace)
+    return;
+
+  dcache_fill (target_dcache_get_or_init (), ptid, memaddr, myaddr, len);
+}
+
 /* The option sets this.  */
 static int stack_cache_enabled_1 = 1;
 /* And set_stack_cache updates this.
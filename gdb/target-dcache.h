@@ -26,6 +26,12 @@ extern DCACHE *target_dcache_get (void);
 
 extern DCACHE *target_dcache_get_or_init (void);
 
+/* Put the LEN bytes at MYADDR, read from the stack of thread PTID at
+   MEMADDR, in the target dcache if the stack cache is on.  */
+
+extern void target_dcache_fill (ptid_t ptid, CORE_ADDR memaddr,
+				const gdb_byte *myaddr, ULONGEST len);
+
 extern int target_dcache_init_p (void);
 
 extern int stack_cache_enabled_p (void);
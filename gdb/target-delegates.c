@@ -573,6 +573,13 @@ tdefault_thread_alive (struct target_ops *self, ptid_t arg1)
   return 0;
 }
 
+static void
+delegate_threads_alive (struct target_ops *self, ptid_t *arg1, int *arg2, int arg3)
+{
+  self = self->beneath;
+  self->to_threads_alive (self, arg1, arg2, arg3);
+}
+
 static void
 delegate_find_new_threads (struct target_ops *self)
 {
@@ -780,6 +787,13 @@ tdefault_xfer_partial (struct target_ops *self, enum target_object  arg1, const
   return TARGET_XFER_E_IO;
 }
 
+static void
+delegate_read_memory_vector (struct target_ops *self, struct memory_read_request *arg1, int arg2)
+{
+  self = self->beneath;
+  self->to_read_memory_vector (self, arg1, arg2);
+}
+
 static VEC(mem_region_s) *
 delegate_memory_map (struct target_ops *self)
 {
@@ -1722,6 +1736,8 @@ install_delegators (struct target_ops *ops)
     ops->to_program_signals = delegate_program_signals;
   if (ops->to_thread_alive == NULL)
     ops->to_thread_alive = delegate_thread_alive;
+  if (ops->to_threads_alive == NULL)
+    ops->to_threads_alive = delegate_threads_alive;
   if (ops->to_find_new_threads == NULL)
     ops->to_find_new_threads = delegate_find_new_threads;
   if (ops->to_pid_to_str == NULL)
@@ -1758,6 +1774,8 @@ install_delegators (struct target_ops *ops)
     ops->to_goto_bookmark = delegate_goto_bookmark;
   if (ops->to_xfer_partial == NULL)
     ops->to_xfer_partial = delegate_xfer_partial;
+  if (ops->to_read_memory_vector == NULL)
+    ops->to_read_memory_vector = delegate_read_memory_vector;
   if (ops->to_memory_map == NULL)
     ops->to_memory_map = delegate_memory_map;
   if (ops->to_flash_erase == NULL)
@@ -1947,6 +1965,7 @@ install_dummy_methods (struct target_ops *ops)
   ops->to_pass_signals = tdefault_pass_signals;
   ops->to_program_signals = tdefault_program_signals;
   ops->to_thread_alive = tdefault_thread_alive;
+  ops->to_threads_alive = default_threads_alive;
   ops->to_find_new_threads = tdefault_find_new_threads;
   ops->to_pid_to_str = default_pid_to_str;
   ops->to_extra_thread_info = tdefault_extra_thread_info;
@@ -1965,6 +1984,7 @@ install_dummy_methods (struct target_ops *ops)
   ops->to_get_bookmark = tdefault_get_bookmark;
   ops->to_goto_bookmark = tdefault_goto_bookmark;
   ops->to_xfer_partial = tdefault_xfer_partial;
+  ops->to_read_memory_vector = default_read_memory_vector;
   ops->to_memory_map = tdefault_memory_map;
   ops->to_flash_erase = tdefault_flash_erase;
   ops->to_flash_done = tdefault_flash_done;
@@ -1316,6 +1316,67 @@ target_read_raw_memory (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len)
     return TARGET_XFER_E_IO;
 }
 
+/* See target.h.  */
+
+int
+target_read_raw_memory_vector (struct memory_read_request *requests,
+			       int count)
+{
+  int i, result = 0;
+
+  for (i = 0; i < count; i++)
+    {
+      requests[i].status = TARGET_XFER_E_IO;
+      requests[i].xfered_len = 0;
+    }
+
+  if (count > 1)
+    {
+      current_target.to_read_memory_vector (&current_target, requests,
+					    count);
+      if (targetdebug)
+	fprintf_unfiltered (gdb_stdlog,
+			    "target_read_raw_memory_vector (%d ranges)\n",
+			    count);
+    }
+  else
+    default_read_memory_vector (&current_target, requests, count);
+
+  for (i = 0; i < count; i++)
+    if (requests[i].status != TARGET_XFER_OK)
+      result = TARGET_XFER_E_IO;
+
+  return result;
+}
+
+/* See target.h.  */
+
+void
+default_read_memory_vector (struct target_ops *self,
+			    struct memory_read_request *requests, int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+    {
+      struct memory_read_request *req = &requests[i];
+
+      if (req->status == TARGET_XFER_OK && req->xfered_len == req->len)
+	continue;
+
+      if (target_read_raw_memory (req->memaddr, req->buf, req->len) == 0)
+	{
+	  req->status = TARGET_XFER_OK;
+	  req->xfered_len = req->len;
+	}
+      else
+	{
+	  req->status = TARGET_XFER_E_IO;
+	  req->xfered_len = 0;
+	}
+    }
+}
+
 /* Like target_read_memory, but specify explicitly that this is a read from
    the target's stack.  This may trigger different cache behavior.  */
 
@@ -3112,6 +3173,29 @@ target_thread_alive (ptid_t ptid)
   return retval;
 }
 
+/* See target.h.  */
+
+void
+target_threads_alive (ptid_t *ptids, int *alive, int count)
+{
+  current_target.to_threads_alive (&current_target, ptids, alive, count);
+  if (targetdebug)
+    fprintf_unfiltered (gdb_stdlog, "target_threads_alive (%d threads)\n",
+			count);
+}
+
+/* See target.h.  */
+
+void
+default_threads_alive (struct target_ops *self, ptid_t *ptids, int *alive,
+		       int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+    alive[i] = target_thread_alive (ptids[i]);
+}
+
 void
 target_find_new_threads (void)
 {
@@ -285,6 +285,38 @@ DEF_VEC_O(memory_read_result_s);
 
 extern void free_memory_read_result_vector (void *);
 
+/* One range of a vectored memory read; see
+   target_read_raw_memory_vector.  */
+
+struct memory_read_request
+  {
+    /* The range to read, and where to store its contents.  */
+    CORE_ADDR memaddr;
+    ULONGEST len;
+    gdb_byte *buf;
+
+    /* The result of reading the range, and the number of bytes
+       read.  */
+    enum target_xfer_status status;
+    ULONGEST xfered_len;
+  };
+
+/* Read the COUNT ranges of raw memory described by REQUESTS, giving
+   the target a chance to read them all at once.  Set the STATUS of
+   each request to TARGET_XFER_OK if the whole range was read, and to
+   TARGET_XFER_E_IO otherwise.  Returns 0 if every range was read, and
+   TARGET_XFER_E_IO otherwise.  */
+
+extern int target_read_raw_memory_vector (struct memory_read_request *requests,
+					  int count);
+
+/* The default to_read_memory_vector: read each of the ranges not yet
+   read in full with target_read_raw_memory.  */
+
+extern void default_read_memory_vector (struct target_ops *self,
+					struct memory_read_request *requests,
+					int count);
+
 extern VEC(memory_read_result_s)* read_memory_robust (struct target_ops *ops,
 						      ULONGEST offset,
 						      LONGEST len);
@@ -549,6 +581,13 @@ struct target_ops
 
     int (*to_thread_alive) (struct target_ops *, ptid_t ptid)
       TARGET_DEFAULT_RETURN (0);
+    /* Set ALIVE[I] to whether the thread PTIDS[I] is still alive, for
+       each of the COUNT threads.  A target stacked above one that
+       implements this, and that implements to_thread_alive itself,
+       should set this to default_threads_alive.  */
+    void (*to_threads_alive) (struct target_ops *, ptid_t *ptids,
+			      int *alive, int count)
+      TARGET_DEFAULT_FUNC (default_threads_alive);
     void (*to_find_new_threads) (struct target_ops *)
       TARGET_DEFAULT_IGNORE ();
     char *(*to_pid_to_str) (struct target_ops *, ptid_t)
@@ -649,6 +688,21 @@ struct target_ops
 						ULONGEST *xfered_len)
       TARGET_DEFAULT_RETURN (TARGET_XFER_E_IO);
 
+    /* Read the COUNT ranges of TARGET_OBJECT_MEMORY described by
+       REQUESTS, as COUNT calls to to_xfer_partial would, but in as
+       few round trips as the target can manage.  Set the STATUS and
+       XFERED_LEN of each request; the caller initializes them to
+       TARGET_XFER_E_IO and 0.  A target that reads only some of the
+       ranges itself should pass the rest to default_read_memory_vector,
+       which reads the ranges not yet read in full one by one.  A
+       target stacked above one that implements this, and that
+       implements to_xfer_partial for memory itself, should set this
+       to default_read_memory_vector.  */
+    void (*to_read_memory_vector) (struct target_ops *ops,
+				   struct memory_read_request *requests,
+				   int count)
+      TARGET_DEFAULT_FUNC (default_read_memory_vector);
+
     /* Returns the memory map for the target.  A return value of NULL
        means that no memory map is available.  If a memory address
        does not fall within any returned regions, it's assumed to be
@@ -1545,6 +1599,17 @@ extern void target_program_signals (int nsig, unsigned char *program_signals);
 
 extern int target_thread_alive (ptid_t ptid);
 
+/* Set ALIVE[I] to whether the thread PTIDS[I] is still alive, for
+   each of the COUNT threads.  */
+
+extern void target_threads_alive (ptid_t *ptids, int *alive, int count);
+
+/* The default to_threads_alive: check each thread with
+   target_thread_alive.  */
+
+extern void default_threads_alive (struct target_ops *self, ptid_t *ptids,
+				   int *alive, int count);
+
 /* Query for new threads and add them to the thread list.  */
 
 extern void target_find_new_threads (void);
@@ -0,0 +1,54 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2014 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <dlfcn.h>
+#include <stdlib.h>
+
+void
+marker (void)
+{
+}
+
+static int
+call_lib_func (const char *name)
+{
+  void *handle;
+  int (*func) (void);
+
+  handle = dlopen (name, RTLD_LAZY);
+  if (handle == NULL)
+    exit (1);
+
+  func = (int (*) (void)) dlsym (handle, "lib_func");
+  if (func == NULL)
+    exit (1);
+
+  return func ();
+}
+
+int
+main (void)
+{
+  int total = 0;
+
+  total += call_lib_func (SHLIB_NAME);
+  marker ();
+  total += call_lib_func (SHLIB_NAME2);
+  marker ();
+
+  return total == 3 ? 0 : 1;
+}
@@ -45,6 +45,7 @@
 #include "gdb_regex.h"
 #include "cli/cli-utils.h"
 #include "continuations.h"
+#include "hashtab.h"
 
 /* Definition of struct thread_info exported to gdbthread.h.  */
 
@@ -57,6 +58,14 @@ void _initialize_thread (void);
 struct thread_info *thread_list = NULL;
 static int highest_thread_num;
 
+/* Index of THREAD_LIST by ptid, so that finding the thread of an event
+   doesn't walk the whole list.  When several threads have the same
+   ptid, as happens while an exited thread is still referenced, the
+   index holds the one most recently added, and
+   NUM_SHADOWED_THREADS counts the others.  */
+static htab_t thread_ptid_htab;
+static int num_shadowed_threads;
+
 static void thread_command (char *tidstr, int from_tty);
 static void thread_apply_all_command (char *, int);
 static int thread_alive (struct thread_info *);
@@ -136,6 +145,94 @@ clear_thread_inferior_resources (struct thread_info *tp)
   do_all_continuations_thread (tp, 1);
 }
 
+/* Return the hash of PTID.  */
+
+static hashval_t
+hash_ptid (ptid_t ptid)
+{
+  hashval_t hash = ptid_get_pid (ptid);
+
+  hash = hash * 31 + ptid_get_lwp (ptid);
+  return hash * 31 + ptid_get_tid (ptid);
+}
+
+/* Hash function for THREAD_PTID_HTAB.  */
+
+static hashval_t
+thread_ptid_htab_hash (const void *p)
+{
+  const struct thread_info *tp = p;
+
+  return hash_ptid (tp->ptid);
+}
+
+/* Equality function for THREAD_PTID_HTAB, comparing a thread with a
+   ptid.  */
+
+static int
+thread_ptid_htab_eq (const void *a, const void *b)
+{
+  const struct thread_info *tp = a;
+  const ptid_t *ptid = b;
+
+  return ptid_equal (tp->ptid, *ptid);
+}
+
+/* Return the slot of THREAD_PTID_HTAB for PTID.  */
+
+static void **
+thread_ptid_htab_slot (ptid_t ptid, enum insert_option insert)
+{
+  if (thread_ptid_htab == NULL)
+    thread_ptid_htab = htab_create (100, thread_ptid_htab_hash,
+				    thread_ptid_htab_eq, NULL);
+
+  return htab_find_slot_with_hash (thread_ptid_htab, &ptid,
+				   hash_ptid (ptid), insert);
+}
+
+/* Make TP the thread found by its ptid.  */
+
+static void
+thread_ptid_htab_add (struct thread_info *tp)
+{
+  void **slot = thread_ptid_htab_slot (tp->ptid, INSERT);
+
+  if (*slot != NULL && *slot != tp)
+    num_shadowed_threads++;
+  *slot = tp;
+}
+
+/* Forget about the ptid of TP, which is being removed from the thread
+   list or given a new ptid.  */
+
+static void
+thread_ptid_htab_remove (struct thread_info *tp)
+{
+  void **slot = thread_ptid_htab_slot (tp->ptid, NO_INSERT);
+  struct thread_info *other;
+
+  gdb_assert (slot != NULL);
+  if (*slot != tp)
+    {
+      num_shadowed_threads--;
+      return;
+    }
+
+  if (num_shadowed_threads > 0)
+    {
+      for (other = thread_list; other; other = other->next)
+	if (other != tp && ptid_equal (other->ptid, tp->ptid))
+	  {
+	    *slot = other;
+	    num_shadowed_threads--;
+	    return;
+	  }
+    }
+
+  htab_clear_slot (thread_ptid_htab, slot);
+}
+
 static void
 free_thread (struct thread_info *tp)
 {
@@ -168,6 +265,8 @@ init_thread_list (void)
     }
 
   thread_list = NULL;
+  htab_empty (thread_ptid_htab);
+  num_shadowed_threads = 0;
 }
 
 /* Allocate a new thread with target id PTID and add it to the thread
@@ -183,7 +282,10 @@ new_thread (ptid_t ptid)
   tp->ptid = ptid;
   tp->num = ++highest_thread_num;
   tp->next = thread_list;
+  if (thread_list != NULL)
+    thread_list->prev = tp;
   thread_list = tp;
+  thread_ptid_htab_add (tp);
 
   /* Nothing to follow yet.  */
   tp->pending_follow.kind = TARGET_WAITKIND_SPURIOUS;
@@ -223,7 +325,9 @@ add_thread_silent (ptid_t ptid)
 	  delete_thread (ptid);
 
 	  /* Now reset its ptid, and reswitch inferior_ptid to it.  */
+	  thread_ptid_htab_remove (tp);
 	  tp->ptid = ptid;
+	  thread_ptid_htab_add (tp);
 	  tp->state = THREAD_STOPPED;
 	  switch_to_thread (ptid);
 
@@ -268,14 +372,9 @@ add_thread (ptid_t ptid)
 static void
 delete_thread_1 (ptid_t ptid, int silent)
 {
-  struct thread_info *tp, *tpprev;
-
-  tpprev = NULL;
-
-  for (tp = thread_list; tp; tpprev = tp, tp = tp->next)
-    if (ptid_equal (tp->ptid, ptid))
-      break;
+  struct thread_info *tp;
 
+  tp = find_thread_ptid (ptid);
   if (!tp)
     return;
 
@@ -308,10 +407,13 @@ delete_thread_1 (ptid_t ptid, int silent)
   tp->state = THREAD_EXITED;
   clear_thread_inferior_resources (tp);
 
-  if (tpprev)
-    tpprev->next = tp->next;
+  thread_ptid_htab_remove (tp);
+  if (tp->prev)
+    tp->prev->next = tp->next;
   else
     thread_list = tp->next;
+  if (tp->next)
+    tp->next->prev = tp->prev;
 
   free_thread (tp);
 }
@@ -348,13 +450,12 @@ find_thread_id (int num)
 struct thread_info *
 find_thread_ptid (ptid_t ptid)
 {
-  struct thread_info *tp;
+  void **slot = thread_ptid_htab_slot (ptid, NO_INSERT);
 
-  for (tp = thread_list; tp; tp = tp->next)
-    if (ptid_equal (tp->ptid, ptid))
-      return tp;
+  if (slot == NULL)
+    return NULL;
 
-  return NULL;
+  return *slot;
 }
 
 /*
@@ -414,11 +515,10 @@ valid_thread_id (int num)
 int
 pid_to_thread_id (ptid_t ptid)
 {
-  struct thread_info *tp;
+  struct thread_info *tp = find_thread_ptid (ptid);
 
-  for (tp = thread_list; tp; tp = tp->next)
-    if (ptid_equal (tp->ptid, ptid))
-      return tp->num;
+  if (tp != NULL)
+    return tp->num;
 
   return 0;
 }
@@ -437,11 +537,8 @@ thread_id_to_pid (int num)
 int
 in_thread_list (ptid_t ptid)
 {
-  struct thread_info *tp;
-
-  for (tp = thread_list; tp; tp = tp->next)
-    if (ptid_equal (tp->ptid, ptid))
-      return 1;
+  if (find_thread_ptid (ptid) != NULL)
+    return 1;
 
   return 0;			/* Never heard of 'im.  */
 }
@@ -552,13 +649,42 @@ static void
 prune_threads (void)
 {
   struct thread_info *tp, *next;
+  struct cleanup *old_chain;
+  ptid_t *ptids;
+  int *alive;
+  int count = 0, i = 0;
+
+  for (tp = thread_list; tp; tp = tp->next)
+    if (tp->state != THREAD_EXITED)
+      count++;
+
+  /* Ask the target about all the threads at once, which can be much
+     cheaper than one at a time.  */
+  ptids = XNEWVEC (ptid_t, count);
+  old_chain = make_cleanup (xfree, ptids);
+  alive = XNEWVEC (int, count);
+  make_cleanup (xfree, alive);
+
+  for (tp = thread_list; tp; tp = tp->next)
+    if (tp->state != THREAD_EXITED)
+      ptids[i++] = tp->ptid;
+
+  target_threads_alive (ptids, alive, count);
+
+  /* The target may have added or deleted threads itself while
+     checking, so go by PTIDS rather than by THREAD_LIST.  */
+  for (i = 0; i < count; i++)
+    if (!alive[i])
+      delete_thread (ptids[i]);
 
   for (tp = thread_list; tp; tp = next)
     {
       next = tp->next;
-      if (!thread_alive (tp))
+      if (tp->state == THREAD_EXITED)
 	delete_thread (tp->ptid);
     }
+
+  do_cleanups (old_chain);
 }
 
 void
@@ -574,7 +700,9 @@ thread_change_ptid (ptid_t old_ptid, ptid_t new_ptid)
   inf->pid = ptid_get_pid (new_ptid);
 
   tp = find_thread_ptid (old_ptid);
+  thread_ptid_htab_remove (tp);
   tp->ptid = new_ptid;
+  thread_ptid_htab_add (tp);
 
   observer_notify_thread_ptid_changed (old_ptid, new_ptid);
 }
@@ -961,6 +961,10 @@ read_value_memory (struct value *val, int embedded_offset,
 		   gdb_byte *buffer, size_t length)
 {
   ULONGEST xfered = 0;
+  enum target_object object;
+
+  /* Stack reads go through the stack cache.  */
+  object = stack ? TARGET_OBJECT_STACK_MEMORY : TARGET_OBJECT_MEMORY;
 
   while (xfered < length)
     {
@@ -968,7 +972,7 @@ read_value_memory (struct value *val, int embedded_offset,
       ULONGEST xfered_len;
 
       status = target_xfer_partial (current_target.beneath,
-				    TARGET_OBJECT_MEMORY, NULL,
+				    object, NULL,
 				    buffer + xfered, NULL,
 				    memaddr + xfered, length - xfered,
 				    &xfered_len);
@@ -352,6 +352,21 @@ enum dwarf_macro_record_type
     DW_MACRO_GNU_lo_user = 0xe0,
     DW_MACRO_GNU_hi_user = 0xff
   };
+
+/* Index attribute encodings for the DWARF 5 .debug_names section.  */
+enum dwarf_name_index_attribute
+  {
+    DW_IDX_compile_unit = 1,
+    DW_IDX_type_unit = 2,
+    DW_IDX_die_offset = 3,
+    DW_IDX_parent = 4,
+    DW_IDX_type_hash = 5,
+    DW_IDX_lo_user = 0x2000,
+    DW_IDX_hi_user = 0x3fff,
+    /* GNU extensions.  */
+    DW_IDX_GNU_internal = 0x2000,
+    DW_IDX_GNU_external = 0x2001
+  };
 
 /* @@@ For use with GNU frame unwind information.  */
 